@@ -11,6 +11,7 @@ export interface SatoruModule {
     mediaType: number,
   ) => void;
   get_collect_profile: (inst: any) => string;
+  get_document_stats: (inst: any) => string;
   set_collect_profile_enabled: (inst: any, enabled: boolean) => void;
   get_pending_resources: (inst: any) => Uint8Array | null;
   get_font_diagnostics: (inst: any) => string;
@@ -47,6 +48,10 @@ export interface SatoruModule {
     height: number,
   ) => void;
   layout_document: (inst: any, width: number) => void;
+  patch_document: (
+    inst: any,
+    patches: DocumentPatch[],
+  ) => number;
   render_from_state: (
     inst: any,
     width: number,
@@ -62,6 +67,31 @@ export interface SatoruModule {
     format: number,
     options: any,
   ) => Uint8Array | null;
+  render_formats: (
+    inst: any,
+    html: string,
+    width: number,
+    height: number,
+    formats: number[],
+    options: any[],
+  ) => (Uint8Array | null)[];
+  render_batch: (
+    inst: any,
+    htmls: string[],
+    width: number,
+    height: number,
+    formats: number | number[],
+    options: any | any[],
+  ) => (Uint8Array | null)[];
+  render_stream: (
+    inst: any,
+    htmls: string | string[],
+    width: number,
+    height: number,
+    format: number,
+    options: any,
+    onChunk: (chunk: Uint8Array) => void,
+  ) => number;
   merge_pdfs: (inst: any, pdfs: Uint8Array[]) => Uint8Array | null;
   onLog?: (level: LogLevel, message: string) => void;
   logLevel: LogLevel;
@@ -82,6 +112,30 @@ export interface WorkerPoolStats {
   avgJobTimeMs: number;
 }
 
+export interface DocumentStats {
+  /** Elements in the retained document, text nodes included */
+  elements: number;
+  /** Distinct computed style objects; elements with equal styles share one */
+  styles: number;
+  /** Boxes the last layout measured instead of reusing their previous size */
+  measured: number;
+}
+
+export interface DocumentPatch {
+  /** CSS selector of the elements to change */
+  selector: string;
+  /** Attribute to set; the element's text is replaced when omitted */
+  attribute?: string;
+  value: string;
+}
+
+export interface PatchResult {
+  /** Number of elements changed */
+  patched: number;
+  /** Resources the patched elements newly refer to; they are loaded before patchDocument returns */
+  resources: RequiredResource[];
+}
+
 export interface RequiredResource {
   type: "font" | "css" | "image";
   url: string;
@@ -233,6 +287,12 @@ export interface RenderOptions {
   pdfHeader?: string;
   /** PDF footer HTML template. Supports {{pageNumber}} and {{totalPages}} */
   pdfFooter?: string;
+  /**
+   * PDF page height in pixels, margins included. When set, each HTML is laid out once and
+   * split into pages of this height, breaking between blocks and lines and honouring
+   * break-before / break-after / break-inside. By default each HTML becomes one page.
+   */
+  pdfPageHeight?: number;
 }
 const emojiUrl =
   "https://cdn.jsdelivr.net/npm/@fontsource/noto-color-emoji/files/noto-color-emoji-emoji-400-normal.woff2";
@@ -407,6 +467,20 @@ export async function resolveGoogleFonts(
   }
 }
 
+/** State handed from SatoruBase's resource loading to the wasm draw call. */
+interface PreparedRender {
+  mod: SatoruModule;
+  inst: any;
+  /** Input HTML with the resolved <link> tags stripped */
+  htmls: string[];
+  format: number;
+  wasmOptions: any;
+  addProfile: (name: string, elapsed: number) => void;
+  now: () => number;
+  /** Reports the profile and diagnostics to the caller's callbacks */
+  finish: () => void;
+}
+
 export abstract class SatoruBase {
   private factory: any;
   private modPromise?: Promise<SatoruModule>;
@@ -505,6 +579,65 @@ export abstract class SatoruBase {
     mod.layout_document(inst, width);
   }
 
+  async getDocumentStats(inst: any): Promise<DocumentStats> {
+    const mod = await this.getModule();
+    return JSON.parse(mod.get_document_stats(inst)) as DocumentStats;
+  }
+
+  /**
+   * Applies patches to a document from initDocument and lays it out again; only the patched
+   * elements are restyled and re-measured. Images, stylesheets and fonts the patched elements
+   * now refer to (a new src, a url() in a style attribute) are resolved with resolveResource or
+   * the default resolver and loaded, and the document is laid out again with them.
+   * Fonts loaded this way are used by documents initialised afterwards.
+   */
+  async patchDocument(
+    inst: any,
+    patches: DocumentPatch[],
+    options: Pick<RenderOptions, "resolveResource" | "baseUrl" | "userAgent"> = {},
+  ): Promise<PatchResult> {
+    const mod = await this.getModule();
+    const patched = mod.patch_document(inst, patches);
+    const binary = mod.get_pending_resources(inst);
+    const resources = binary ? this.parsePendingResources(binary) : [];
+    if (resources.length === 0) return { patched, resources };
+
+    const defaultResolver = (r: RequiredResource) =>
+      this.resolveDefaultResource(r, options.baseUrl, options.userAgent);
+    const resolve = options.resolveResource
+      ? (r: RequiredResource) => options.resolveResource!(r, defaultResolver)
+      : defaultResolver;
+    const typeMap = { font: 1, image: 2, css: 3 };
+
+    await Promise.all(
+      resources.map(async (r) => {
+        if (r.url.startsWith("data:")) return;
+        try {
+          const data = await resolve(r);
+          if (!data) return;
+          if (typeof data === "object" && "css" in data && "fonts" in data) {
+            mod.add_resource(inst, r.url, typeMap.css, data.css);
+            for (const font of data.fonts) {
+              mod.add_resource(inst, font.url, typeMap.font, font.data);
+            }
+            return;
+          }
+          const view = data as ArrayBufferView;
+          const bytes =
+            view instanceof Uint8Array
+              ? view
+              : new Uint8Array(view.buffer, view.byteOffset, view.byteLength);
+          mod.add_resource(inst, r.url, typeMap[r.type], bytes);
+        } catch (e) {
+          console.warn(`Failed to resolve resource: ${r.url}`, e);
+        }
+      }),
+    );
+    // 0 keeps the width of the last layout
+    mod.layout_document(inst, 0);
+    return { patched, resources };
+  }
+
   async renderFromState(
     inst: any,
     options: {
@@ -633,6 +766,157 @@ export abstract class SatoruBase {
   async render(options: RenderOptions & { format?: "svg" }): Promise<string>;
   async render(options: RenderOptions): Promise<string | Uint8Array>;
   async render(options: RenderOptions): Promise<string | Uint8Array> {
+    const isSvg = (options.format ?? "svg") === "svg";
+    return this.renderPrepared(options, (prepared) => {
+      const { mod, inst, htmls, format, wasmOptions, addProfile, now } = prepared;
+      const renderStart = now();
+      const result =
+        htmls.length === 1
+          ? mod.render_from_state(inst, options.width, options.height ?? 0, format, wasmOptions)
+          : mod.render(inst, htmls, options.width, options.height ?? 0, format, wasmOptions);
+      addProfile("wasmRender", now() - renderStart);
+
+      if (!result) {
+        prepared.finish();
+        if (isSvg) return "";
+        return new Uint8Array();
+      }
+
+      if (isSvg) {
+        const decodeStart = now();
+        const svg = new TextDecoder().decode(result);
+        addProfile("decodeResult", now() - decodeStart);
+        prepared.finish();
+        return svg;
+      }
+
+      const copyStart = now();
+      const bytes = new Uint8Array(result);
+      addProfile("copyResult", now() - copyStart);
+      prepared.finish();
+      return bytes;
+    });
+  }
+
+  /**
+   * Renders independent documents with one instance, each item becoming one output in the
+   * format given by options.format. The resources of every item are collected and loaded
+   * before drawing, so fonts and images shared between items are fetched once.
+   */
+  async renderBatch(
+    options: Omit<RenderOptions, "value" | "url"> & {
+      value: string[];
+      format: "png" | "webp" | "pdf";
+    },
+  ): Promise<(Uint8Array | null)[]>;
+  async renderBatch(
+    options: Omit<RenderOptions, "value" | "url"> & {
+      value: string[];
+      format?: "svg";
+    },
+  ): Promise<(string | null)[]>;
+  async renderBatch(
+    options: Omit<RenderOptions, "value" | "url"> & { value: string[] },
+  ): Promise<(string | Uint8Array | null)[]> {
+    const isSvg = (options.format ?? "svg") === "svg";
+    return this.renderPrepared(options, (prepared) => {
+      const { mod, inst, htmls, format, wasmOptions, addProfile, now } = prepared;
+      const renderStart = now();
+      const results = mod.render_batch(
+        inst,
+        htmls,
+        options.width,
+        options.height ?? 0,
+        format,
+        wasmOptions,
+      );
+      addProfile("wasmRender", now() - renderStart);
+
+      // The wasm outputs are views into buffers reused by the next call, so copy them out.
+      const decoder = new TextDecoder();
+      const outputs = results.map((result) => {
+        if (!result) return null;
+        return isSvg ? decoder.decode(result) : new Uint8Array(result);
+      });
+      prepared.finish();
+      return outputs;
+    });
+  }
+
+  /**
+   * Renders like render() but passes the output to onChunk as it is encoded instead of
+   * returning it whole: PDF pages as they finish, SVG and images in chunks. Each chunk is a
+   * copy the caller may keep. Resolves to the number of bytes written.
+   */
+  async renderStream(
+    options: RenderOptions & { onChunk: (chunk: Uint8Array) => void },
+  ): Promise<number> {
+    return this.renderPrepared(options, (prepared) => {
+      const { mod, inst, htmls, format, wasmOptions, addProfile, now } = prepared;
+      const renderStart = now();
+      const written = mod.render_stream(
+        inst,
+        htmls,
+        options.width,
+        options.height ?? 0,
+        format,
+        wasmOptions,
+        // The chunk is a view into wasm memory that the next chunk overwrites.
+        (chunk) => options.onChunk(new Uint8Array(chunk)),
+      );
+      addProfile("wasmRender", now() - renderStart);
+      prepared.finish();
+      if (written < 0) {
+        throw new Error("Streaming render failed");
+      }
+      return written;
+    });
+  }
+
+  /**
+   * Decodes the pending-resource list written by get_pending_resources:
+   * a u32 count, then per entry a type byte, a redraw byte and u32-length-prefixed
+   * url, name and characters strings.
+   */
+  private parsePendingResources(binary: Uint8Array): RequiredResource[] {
+    const utf8Decoder = new TextDecoder();
+    const view = new DataView(binary.buffer, binary.byteOffset, binary.byteLength);
+    let offset = 0;
+    const readString = () => {
+      const len = view.getUint32(offset, true);
+      offset += 4;
+      const str = utf8Decoder.decode(new Uint8Array(binary.buffer, binary.byteOffset + offset, len));
+      offset += len;
+      return str;
+    };
+
+    const count = view.getUint32(offset, true);
+    offset += 4;
+    const resources: RequiredResource[] = [];
+    for (let j = 0; j < count; j++) {
+      const typeInt = view.getUint8(offset++);
+      const redraw_on_ready = view.getUint8(offset++) !== 0;
+      const url = readString();
+      const name = readString();
+      const characters = readString();
+
+      let type: "font" | "image" | "css" = "font";
+      if (typeInt === 2) type = "image";
+      else if (typeInt === 3) type = "css";
+
+      resources.push({ type, url, name, characters, redraw_on_ready });
+    }
+    return resources;
+  }
+
+  /**
+   * Loads the resources of options.value into a fresh instance and hands it to draw.
+   * draw must call prepared.finish() to report profile and diagnostics.
+   */
+  private async renderPrepared<T>(
+    options: RenderOptions,
+    draw: (prepared: PreparedRender) => T,
+  ): Promise<T> {
     let { format = "svg", value, url, baseUrl } = options;
     const profileEnabled = options.profile === true || options.diagnostics === true;
     const profile: Record<string, number> = {};
@@ -921,33 +1205,7 @@ export abstract class SatoruBase {
           if (!binary) break;
 
           const parseStart = now();
-          const view = new DataView(binary.buffer, binary.byteOffset, binary.byteLength);
-          let offset = 0;
-          const count = view.getUint32(offset, true);
-          offset += 4;
-          const resources: RequiredResource[] = [];
-          for (let j = 0; j < count; j++) {
-            const typeInt = view.getUint8(offset++);
-            const redraw_on_ready = view.getUint8(offset++) !== 0;
-
-            const urlLen = view.getUint32(offset, true); offset += 4;
-            const url = utf8Decoder.decode(new Uint8Array(binary.buffer, binary.byteOffset + offset, urlLen));
-            offset += urlLen;
-
-            const nameLen = view.getUint32(offset, true); offset += 4;
-            const name = utf8Decoder.decode(new Uint8Array(binary.buffer, binary.byteOffset + offset, nameLen));
-            offset += nameLen;
-
-            const charsLen = view.getUint32(offset, true); offset += 4;
-            const characters = utf8Decoder.decode(new Uint8Array(binary.buffer, binary.byteOffset + offset, charsLen));
-            offset += charsLen;
-
-            let type: "font" | "image" | "css" = "font";
-            if (typeInt === 2) type = "image";
-            else if (typeInt === 3) type = "css";
-
-            resources.push({ type, url, name, characters, redraw_on_ready });
-          }
+          const resources = this.parsePendingResources(binary);
 
           const pending = resources.filter((r) => {
             const key = `${r.type}:${r.url}:${r.characters ?? ""}`;
@@ -1104,7 +1362,6 @@ export abstract class SatoruBase {
         pdf: 3,
       };
 
-      const renderStart = now();
       if (options.signal?.aborted) {
         throw new Error("Render aborted");
       }
@@ -1113,111 +1370,51 @@ export abstract class SatoruBase {
         diagnosticsReport?.errors.push({ code: DIAGNOSTIC_CODES.LIMIT_TIMEOUT, message: msg });
         throw new Error(msg);
       }
-      const result = (processedHtmls.length === 1)
-        ? mod.render_from_state(
-            instancePtr,
-            width,
-            height,
-            formatMap[format as keyof typeof formatMap] ?? 0,
-            {
-              svgTextToPaths: options.textToPaths ?? true,
-              outputWidth: options.outputWidth ?? 0,
-              outputHeight: options.outputHeight ?? 0,
-              fitType: options.fit === "cover" ? 1 : options.fit === "fill" ? 2 : 0,
-              cropX: options.crop?.x ?? 0,
-              cropY: options.crop?.y ?? 0,
-              cropWidth: options.crop?.width ?? 0,
-              cropHeight: options.crop?.height ?? 0,
-              fitPositionX: options.fitPosition?.x ?? 0.5,
-              fitPositionY: options.fitPosition?.y ?? 0.5,
-              backgroundColor: this.parseColor(options.backgroundColor),
-              mediaType: options.mediaType === "print" ? 1 : 0,
-              pdfTitle: options.pdfTitle ?? "",
-              pdfAuthor: options.pdfAuthor ?? "",
-              pdfSubject: options.pdfSubject ?? "",
-              pdfKeywords: options.pdfKeywords ?? "",
-              pdfCreator: options.pdfCreator ?? "",
-              pdfProducer: options.pdfProducer ?? "",
-              pdfMarginTop: options.pdfMargin?.top ?? 0,
-              pdfMarginRight: options.pdfMargin?.right ?? 0,
-              pdfMarginBottom: options.pdfMargin?.bottom ?? 0,
-              pdfMarginLeft: options.pdfMargin?.left ?? 0,
-              pdfHeader: options.pdfHeader ?? "",
-              pdfFooter: options.pdfFooter ?? "",
-            },
-          )
-        : mod.render(
-            instancePtr,
-            processedHtmls,
-            width,
-            height,
-            formatMap[format as keyof typeof formatMap] ?? 0,
-            {
-              svgTextToPaths: options.textToPaths ?? true,
-              outputWidth: options.outputWidth ?? 0,
-              outputHeight: options.outputHeight ?? 0,
-              fitType: options.fit === "cover" ? 1 : options.fit === "fill" ? 2 : 0,
-              cropX: options.crop?.x ?? 0,
-              cropY: options.crop?.y ?? 0,
-              cropWidth: options.crop?.width ?? 0,
-              cropHeight: options.crop?.height ?? 0,
-              fitPositionX: options.fitPosition?.x ?? 0.5,
-              fitPositionY: options.fitPosition?.y ?? 0.5,
-              backgroundColor: this.parseColor(options.backgroundColor),
-              mediaType: options.mediaType === "print" ? 1 : 0,
-              pdfTitle: options.pdfTitle ?? "",
-              pdfAuthor: options.pdfAuthor ?? "",
-              pdfSubject: options.pdfSubject ?? "",
-              pdfKeywords: options.pdfKeywords ?? "",
-              pdfCreator: options.pdfCreator ?? "",
-              pdfProducer: options.pdfProducer ?? "",
-              pdfMarginTop: options.pdfMargin?.top ?? 0,
-              pdfMarginRight: options.pdfMargin?.right ?? 0,
-              pdfMarginBottom: options.pdfMargin?.bottom ?? 0,
-              pdfMarginLeft: options.pdfMargin?.left ?? 0,
-              pdfHeader: options.pdfHeader ?? "",
-              pdfFooter: options.pdfFooter ?? "",
-            },
-          );
-      addProfile("wasmRender", now() - renderStart);
 
-      if (!result) {
-        options.onProfile?.(profile);
-        if (diagnosticsReport) {
-          try {
-            diagnosticsReport.fonts = JSON.parse(mod.get_font_diagnostics(instancePtr));
-          } catch {}
-          options.onDiagnostics?.(diagnosticsReport);
-        }
-        if (format === "svg") return "";
-        return new Uint8Array();
-      }
-
-      if (format === "svg") {
-        const decodeStart = now();
-        const svg = utf8Decoder.decode(result);
-        addProfile("decodeResult", now() - decodeStart);
-        options.onProfile?.(profile);
-        if (diagnosticsReport) {
-          try {
-            diagnosticsReport.fonts = JSON.parse(mod.get_font_diagnostics(instancePtr));
-          } catch {}
-          options.onDiagnostics?.(diagnosticsReport);
-        }
-        return svg;
-      }
-
-      const copyStart = now();
-      const bytes = new Uint8Array(result);
-      addProfile("copyResult", now() - copyStart);
-      options.onProfile?.(profile);
-      if (diagnosticsReport) {
-        try {
-          diagnosticsReport.fonts = JSON.parse(mod.get_font_diagnostics(instancePtr));
-        } catch {}
-        options.onDiagnostics?.(diagnosticsReport);
-      }
-      return bytes;
+      return draw({
+        mod,
+        inst: instancePtr,
+        htmls: processedHtmls,
+        format: formatMap[format as keyof typeof formatMap] ?? 0,
+        wasmOptions: {
+          svgTextToPaths: options.textToPaths ?? true,
+          outputWidth: options.outputWidth ?? 0,
+          outputHeight: options.outputHeight ?? 0,
+          fitType: options.fit === "cover" ? 1 : options.fit === "fill" ? 2 : 0,
+          cropX: options.crop?.x ?? 0,
+          cropY: options.crop?.y ?? 0,
+          cropWidth: options.crop?.width ?? 0,
+          cropHeight: options.crop?.height ?? 0,
+          fitPositionX: options.fitPosition?.x ?? 0.5,
+          fitPositionY: options.fitPosition?.y ?? 0.5,
+          backgroundColor: this.parseColor(options.backgroundColor),
+          mediaType: options.mediaType === "print" ? 1 : 0,
+          pdfTitle: options.pdfTitle ?? "",
+          pdfAuthor: options.pdfAuthor ?? "",
+          pdfSubject: options.pdfSubject ?? "",
+          pdfKeywords: options.pdfKeywords ?? "",
+          pdfCreator: options.pdfCreator ?? "",
+          pdfProducer: options.pdfProducer ?? "",
+          pdfMarginTop: options.pdfMargin?.top ?? 0,
+          pdfMarginRight: options.pdfMargin?.right ?? 0,
+          pdfMarginBottom: options.pdfMargin?.bottom ?? 0,
+          pdfMarginLeft: options.pdfMargin?.left ?? 0,
+          pdfHeader: options.pdfHeader ?? "",
+          pdfFooter: options.pdfFooter ?? "",
+          pdfPageHeight: options.pdfPageHeight ?? 0,
+        },
+        addProfile,
+        now,
+        finish: () => {
+          options.onProfile?.(profile);
+          if (diagnosticsReport) {
+            try {
+              diagnosticsReport.fonts = JSON.parse(mod.get_font_diagnostics(instancePtr));
+            } catch {}
+            options.onDiagnostics?.(diagnosticsReport);
+          }
+        },
+      });
     } finally {
       mod.destroy_instance(instancePtr);
       mod.logLevel = prevLogLevel;
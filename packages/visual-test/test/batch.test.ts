@@ -0,0 +1,57 @@
+import { describe, it, expect, beforeAll } from "vitest";
+import { Satoru } from "satoru-render/single";
+import { PNG } from "pngjs";
+
+const solidPng = (r: number, g: number, b: number) => {
+  const png = new PNG({ width: 4, height: 4 });
+  for (let i = 0; i < png.data.length; i += 4) {
+    png.data[i] = r;
+    png.data[i + 1] = g;
+    png.data[i + 2] = b;
+    png.data[i + 3] = 255;
+  }
+  return new Uint8Array(PNG.sync.write(png));
+};
+
+describe("Batch render", () => {
+  let satoru: Satoru;
+
+  beforeAll(async () => {
+    satoru = await Satoru.create();
+  });
+
+  it("loads the resources of every item before drawing", async () => {
+    const images: Record<string, Uint8Array> = {
+      "red.png": solidPng(255, 0, 0),
+      "blue.png": solidPng(0, 0, 255),
+    };
+    const requested: string[] = [];
+
+    const outputs = await satoru.renderBatch({
+      value: [
+        `<body style="margin:0"><img src="red.png" width="20" height="20"></body>`,
+        `<body style="margin:0"><img src="blue.png" width="20" height="20"></body>`,
+      ],
+      width: 20,
+      height: 20,
+      format: "png",
+      resolveResource: async (resource) => {
+        requested.push(resource.url);
+        return images[resource.url] ?? null;
+      },
+    });
+
+    expect(requested).toContain("red.png");
+    expect(requested).toContain("blue.png");
+    expect(outputs).toHaveLength(2);
+
+    const centre = (bytes: Uint8Array | null) => {
+      expect(bytes).not.toBeNull();
+      const png = PNG.sync.read(Buffer.from(bytes!));
+      const i = (10 * png.width + 10) * 4;
+      return [png.data[i], png.data[i + 1], png.data[i + 2]];
+    };
+    expect(centre(outputs[0])).toEqual([255, 0, 0]);
+    expect(centre(outputs[1])).toEqual([0, 0, 255]);
+  });
+});
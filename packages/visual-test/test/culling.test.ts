@@ -0,0 +1,37 @@
+import { describe, it, expect, beforeAll } from "vitest";
+import { Satoru } from "satoru-render/single";
+import { PNG } from "pngjs";
+
+describe("Draw clip culling", () => {
+  let satoru: Satoru;
+
+  beforeAll(async () => {
+    satoru = await Satoru.create();
+  });
+
+  const pixel = (bytes: Uint8Array, x: number, y: number) => {
+    const png = PNG.sync.read(Buffer.from(bytes));
+    const i = (y * png.width + x) * 4;
+    return [png.data[i], png.data[i + 1], png.data[i + 2]];
+  };
+
+  it("draws a border-image outset reaching into the clip from a box below it", async () => {
+    // The border box spans y 70..100, below the 50px clip; its outset image starts at y 30.
+    const html = `
+      <body style="margin:0;font-size:4px">
+        <div style="margin-top:70px;height:10px;border:10px solid transparent;
+                    border-image:linear-gradient(red, red) 1;border-image-outset:40px"></div>
+      </body>`;
+
+    const png = await satoru.render({
+      value: html,
+      width: 100,
+      height: 50,
+      format: "png",
+      backgroundColor: "white",
+    });
+
+    expect(pixel(png, 50, 35)).toEqual([255, 0, 0]);
+    expect(pixel(png, 50, 20)).toEqual([255, 255, 255]);
+  });
+});
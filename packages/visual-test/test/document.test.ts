@@ -0,0 +1,135 @@
+import { describe, it, expect, beforeAll } from "vitest";
+import { Satoru } from "satoru-render/single";
+import { PNG } from "pngjs";
+
+describe("Retained document", () => {
+  let satoru: Satoru;
+
+  beforeAll(async () => {
+    satoru = await Satoru.create();
+  });
+
+  const layoutStats = async (html: string, width = 600) => {
+    const inst = await satoru.initDocument({ html, width });
+    try {
+      await satoru.layoutDocument(inst, width);
+      return await satoru.getDocumentStats(inst);
+    } finally {
+      await satoru.destroyInstance(inst);
+    }
+  };
+
+  it("keeps table cells and images sharing their style after layout", async () => {
+    const page = (rows: number) => {
+      const tr = `<tr><td>a</td><td>b</td><td><img src="icon.png" width="16" height="16"></td></tr>`;
+      return `<table>${tr.repeat(rows)}</table>`;
+    };
+
+    const small = await layoutStats(page(10));
+    const large = await layoutStats(page(40));
+
+    expect(large.elements).toBeGreaterThan(small.elements);
+    // Layout must not give every cell or image a private copy of its style.
+    expect(large.styles).toBe(small.styles);
+  });
+
+  it("re-measures only the patched nodes and loads a patched src", async () => {
+    const rows = Array.from({ length: 100 }, (_, i) => `<p>row ${i}</p>`).join("");
+    const html = `<body><h1 id="title">Old title</h1><img id="pic" src="a.png">${rows}</body>`;
+    const png = (size: number) => {
+      const image = new PNG({ width: size, height: size });
+      image.data.fill(255);
+      return new Uint8Array(PNG.sync.write(image));
+    };
+    const requested: string[] = [];
+
+    const inst = await satoru.initDocument({ html, width: 600 });
+    try {
+      await satoru.layoutDocument(inst, 600);
+      const full = await satoru.getDocumentStats(inst);
+
+      const result = await satoru.patchDocument(
+        inst,
+        [
+          { selector: "#title", value: "New title" },
+          { selector: "#pic", attribute: "src", value: "b.png" },
+        ],
+        {
+          resolveResource: async (r) => {
+            requested.push(r.url);
+            return r.url === "b.png" ? png(40) : null;
+          },
+        },
+      );
+      const patched = await satoru.getDocumentStats(inst);
+
+      expect(result.patched).toBe(2);
+      expect(result.resources.map((r) => r.url)).toContain("b.png");
+      expect(requested).toContain("b.png");
+      // The 100 untouched paragraphs keep their memoised layout, also once b.png has loaded.
+      expect(full.measured).toBeGreaterThan(100);
+      expect(patched.measured).toBeGreaterThan(0);
+      expect(patched.measured).toBeLessThan(20);
+    } finally {
+      await satoru.destroyInstance(inst);
+    }
+  });
+
+  const pixelAt = (bytes: string | Uint8Array, x: number, y: number) => {
+    const png = PNG.sync.read(Buffer.from(bytes as Uint8Array));
+    const i = (y * png.width + x) * 4;
+    return [png.data[i], png.data[i + 1], png.data[i + 2]];
+  };
+
+  it("keeps ::before content when the text is patched", async () => {
+    const html = `
+      <style>
+        body { margin: 0 }
+        #title::before { content: ""; display: block; width: 20px; height: 20px; background: red }
+      </style>
+      <body><div id="title">Old title</div></body>`;
+
+    const inst = await satoru.initDocument({ html, width: 100 });
+    try {
+      await satoru.layoutDocument(inst, 100);
+      const result = await satoru.patchDocument(inst, [{ selector: "#title", value: "New" }]);
+      expect(result.patched).toBe(1);
+
+      const png = await satoru.renderFromState(inst, {
+        width: 100,
+        height: 50,
+        format: "png",
+        backgroundColor: "white",
+      });
+      expect(pixelAt(png, 10, 10)).toEqual([255, 0, 0]);
+    } finally {
+      await satoru.destroyInstance(inst);
+    }
+  });
+
+  it("restyles the following sibling when a sibling selector stops matching", async () => {
+    const html = `
+      <style>
+        body { margin: 0 }
+        p { margin: 0; height: 20px; background: blue }
+        .a + p { background: red }
+      </style>
+      <body><div id="first" class="a" style="height:20px"></div><p></p></body>`;
+
+    const inst = await satoru.initDocument({ html, width: 100 });
+    try {
+      await satoru.layoutDocument(inst, 100);
+      const draw = () =>
+        satoru.renderFromState(inst, { width: 100, height: 40, format: "png", backgroundColor: "white" });
+      expect(pixelAt(await draw(), 10, 30)).toEqual([255, 0, 0]);
+
+      await satoru.patchDocument(inst, [{ selector: "#first", attribute: "class", value: "" }]);
+      expect(pixelAt(await draw(), 10, 30)).toEqual([0, 0, 255]);
+
+      await satoru.patchDocument(inst, [{ selector: "#first", attribute: "class", value: "a" }]);
+      expect(pixelAt(await draw(), 10, 30)).toEqual([255, 0, 0]);
+    } finally {
+      await satoru.destroyInstance(inst);
+    }
+  });
+});
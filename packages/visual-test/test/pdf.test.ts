@@ -45,4 +45,25 @@ describe("Multi-page PDF Rendering", () => {
     });
     expect(pdfData2.length).toBeGreaterThan(0);
   });
+
+  it("breaks pages between the rows of a table", async () => {
+    const row = (style = "") => `<tr style="height:30px;${style}"><td>a</td><td>b</td></tr>`;
+    const html = `
+      <body style="margin:0">
+        <div style="height:20px"></div>
+        <table style="border-spacing:0">
+          <tbody>${row()}${row()}${row("break-before:page")}${row()}</tbody>
+        </table>
+      </body>`;
+
+    const pdf = await satoru.render({
+      value: html,
+      width: 400,
+      format: "pdf",
+      pdfPageHeight: 400,
+    });
+
+    // All four rows fit on one page; the forced break before the third row starts a second one.
+    expect(new TextDecoder().decode(pdf)).toContain("/Count 2");
+  });
 });
@@ -0,0 +1,45 @@
+import { describe, it, expect, beforeAll } from "vitest";
+import { Satoru } from "satoru-render/single";
+
+describe("Streaming render", () => {
+  let satoru: Satoru;
+
+  beforeAll(async () => {
+    satoru = await Satoru.create();
+  });
+
+  it("passes the whole SVG to onChunk and reports its size", async () => {
+    const rows = Array.from({ length: 2000 }, (_, i) => `<p>row ${i}</p>`).join("");
+    const chunks: Uint8Array[] = [];
+
+    const written = await satoru.renderStream({
+      value: `<body>${rows}</body>`,
+      width: 400,
+      format: "svg",
+      onChunk: (chunk) => chunks.push(chunk),
+    });
+
+    expect(chunks.length).toBeGreaterThan(1);
+    const total = chunks.reduce((n, c) => n + c.length, 0);
+    expect(written).toBe(total);
+
+    const svg = Buffer.concat(chunks).toString("utf8");
+    expect(svg).toContain("<svg");
+    expect(svg.trimEnd().endsWith("</svg>")).toBe(true);
+  });
+
+  it("emits the defs once when the document holds inline SVG", async () => {
+    const icon = `<svg width="20" height="20"><rect width="20" height="20" fill="red"/></svg>`;
+    const chunks: Uint8Array[] = [];
+
+    await satoru.renderStream({
+      value: `<body>${icon}<p style="box-shadow:0 0 4px black">text</p>${icon}</body>`,
+      width: 200,
+      format: "svg",
+      onChunk: (chunk) => chunks.push(chunk),
+    });
+
+    const svg = Buffer.concat(chunks).toString("utf8");
+    expect(svg.split("<!--SATORU_DEFS-->").length - 1).toBe(1);
+  });
+});
@@ -3,11 +3,14 @@
 #include <emscripten.h>
 #include <stdio.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdarg>
 #include <cstring>
 #include <iomanip>
 #include <sstream>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "api/js_logger.h"
@@ -86,6 +89,15 @@ std::string codepoints_to_utf8(std::vector<char32_t>& cps) {
     }
     return res;
 }
+
+// PNG and WebP outputs whose options produce the same pixels can share one drawn bitmap.
+bool same_raster_output(const RenderOptions& a, const RenderOptions& b) {
+    return a.fitType == b.fitType && a.outputWidth == b.outputWidth &&
+           a.outputHeight == b.outputHeight && a.cropX == b.cropX && a.cropY == b.cropY &&
+           a.cropWidth == b.cropWidth && a.cropHeight == b.cropHeight &&
+           a.backgroundColor == b.backgroundColor && a.fitPositionX == b.fitPositionX &&
+           a.fitPositionY == b.fitPositionY && a.mediaType == b.mediaType;
+}
 }  // namespace
 
 // --- SatoruInstance Implementation ---
@@ -98,36 +110,94 @@ SatoruInstance::SatoruInstance() : resourceManager(context) {
     context.init();
     cached_full_master_css = std::string(litehtml::master_css) + "\n" + satoru_master_css +
                              "\nbr { display: -litehtml-br !important; }\n";
+    master_stylesheet = std::make_shared<litehtml::shared_stylesheet>(cached_full_master_css);
 }
 
 SatoruInstance::~SatoruInstance() {}
 
 const std::string& SatoruInstance::get_full_master_css() const { return cached_full_master_css; }
 
-void SatoruInstance::init_document(const char* html, int width, int height) {
+void SatoruInstance::init_document(const char* html, int width, int height, int mediaType) {
     int initial_height = (height > 0) ? height : 3000;
+    litehtml::media_type mt =
+        (mediaType == 1) ? litehtml::media_type_print : litehtml::media_type_screen;
+    doc.reset();  // The old document must not outlive the container it points to.
     render_container = std::make_unique<container_skia>(width, initial_height, nullptr, context,
-                                                        &resourceManager, false);
+                                                        &resourceManager, false, mt);
 
-    std::string master_css = get_full_master_css() + "\nbr { display: -litehtml-br !important; }\n";
-    std::string user_css = context.getExtraCss();
-    doc = litehtml::document::createFromString(html, render_container.get(), master_css.c_str(),
-                                               user_css.c_str());
+    doc = litehtml::document::createFromString(html, render_container.get(),
+                                               get_master_stylesheet(),
+                                               context.getUserStylesheet());
     if (render_container) {
         render_container->set_document(doc.get());
     }
+    // The document no longer matches what collect_resources last built.
+    last_parsed_html.clear();
+    last_media_type = -1;
+    last_width = -1;
+}
+
+// Images that loaded since the last layout change intrinsic sizes the layout memo still holds
+void SatoruInstance::invalidate_loaded_images() {
+    if (context.loadedImages.empty()) {
+        doc->invalidate_layout();
+    } else {
+        for (const auto& name : context.loadedImages) doc->invalidate_image(name);
+    }
+    context.loadedImages.clear();
 }
 
 void SatoruInstance::layout_document(int width) {
-    if (doc && width != last_width) {
+    if (width <= 0) width = last_width;
+    if (!doc || width <= 0) return;
+    if (width != last_width || context.needsRelayout) {
+        if (context.needsRelayout) invalidate_loaded_images();
         doc->render(width);
         last_width = width;
+        context.needsRelayout = false;
         if (render_container) {
             render_container->set_height(doc->height());
         }
     }
 }
 
+int SatoruInstance::patch_document(const std::vector<DocumentPatch>& patches) {
+    if (!doc || !doc->root()) return 0;
+
+    int patched = 0;
+    for (const auto& patch : patches) {
+        for (const auto& el : doc->root()->select_all(patch.selector)) {
+            if (patch.attribute.empty()) {
+                doc->set_element_text(el, patch.value.c_str());
+            } else {
+                doc->set_element_attr(el, patch.attribute.c_str(), patch.value.c_str());
+            }
+            patched++;
+        }
+    }
+    if (patched == 0) return 0;
+
+    // The document no longer matches the html collect_resources parsed it from.
+    last_parsed_html.clear();
+    if (last_width > 0) {
+        doc->render(last_width);
+        if (render_container) render_container->set_height(doc->height());
+    }
+    return patched;
+}
+
+bool SatoruInstance::is_document_current(const std::string& html, int width, int height,
+                                         int mediaType) const {
+    if (!doc || !render_container || context.needsRelayout) return false;
+    litehtml::media_type mt =
+        (mediaType == 1) ? litehtml::media_type_print : litehtml::media_type_screen;
+    return html == last_parsed_html && width == last_width && height == last_height &&
+           mt == (litehtml::media_type)last_media_type &&
+           context.getCssVersion() == last_css_version &&
+           context.getFontVersion() == last_font_version &&
+           context.getImageVersion() == last_image_version;
+}
+
 static void scan_image_sizes(litehtml::element::ptr el, SatoruContext& context) {
     if (!el) return;
     const char* tag = el->get_tagName();
@@ -230,8 +300,8 @@ void SatoruInstance::collect_resources(const std::string& html, int width, int h
             auto create_start = std::chrono::high_resolution_clock::time_point{};
             if (collect_profile_enabled) create_start = std::chrono::high_resolution_clock::now();
             doc = litehtml::document::createFromString(html.c_str(), render_container.get(),
-                                                       get_full_master_css().c_str(),
-                                                       context.getExtraCss().c_str());
+                                                       get_master_stylesheet(),
+                                                       context.getUserStylesheet());
             if (collect_profile_enabled) {
                 auto create_end = std::chrono::high_resolution_clock::now();
                 profile_create_document_ms += elapsed_ms(create_start, create_end);
@@ -264,6 +334,7 @@ void SatoruInstance::collect_resources(const std::string& html, int width, int h
                 auto render_start = std::chrono::high_resolution_clock::time_point{};
                 if (collect_profile_enabled)
                     render_start = std::chrono::high_resolution_clock::now();
+                if (context.needsRelayout) invalidate_loaded_images();
                 doc->render(width);
                 if (collect_profile_enabled) {
                     auto render_end = std::chrono::high_resolution_clock::now();
@@ -287,6 +358,7 @@ void SatoruInstance::collect_resources(const std::string& html, int width, int h
                 }
                 image_sizes_scanned = true;
             }
+            last_image_version = context.getImageVersion();
         }
     } catch (const std::exception& e) {
         if (auto* logger = context.getLogger())
@@ -445,6 +517,7 @@ std::string SatoruInstance::get_collect_profile_json() const {
        << ",\"cppSplitText\":" << context.layoutProfile.container_split_text_ms
        << ",\"cppBidiLevel\":" << context.layoutProfile.container_bidi_ms
        << ",\"cppTextMeasure\":" << context.layoutProfile.text_measure_ms
+       << ",\"cppTextMeasureRun\":" << context.layoutProfile.text_measure_run_ms
        << ",\"cppTextAnalyze\":" << context.layoutProfile.text_analyze_ms
        << ",\"cppTextShape\":" << context.layoutProfile.text_shape_ms
        << ",\"cppTextShapePrepared\":" << context.layoutProfile.text_shape_prepared_ms
@@ -456,12 +529,46 @@ std::string SatoruInstance::get_collect_profile_json() const {
        << ",\"cppSplitTextCount\":" << context.layoutProfile.container_split_text_count
        << ",\"cppBidiLevelCount\":" << context.layoutProfile.container_bidi_count
        << ",\"cppTextMeasureCount\":" << context.layoutProfile.text_measure_count
+       << ",\"cppTextMeasureRunCount\":" << context.layoutProfile.text_measure_run_count
        << ",\"cppTextMeasureCacheableCount\":" << context.layoutProfile.text_measure_cacheable_count
        << ",\"cppTextMeasureCacheHitCount\":" << context.layoutProfile.text_measure_cache_hit_count
        << ",\"cppTextAnalyzeCount\":" << context.layoutProfile.text_analyze_count
        << ",\"cppTextShapeCount\":" << context.layoutProfile.text_shape_count
-       << ",\"cppTextShapePreparedCount\":" << context.layoutProfile.text_shape_prepared_count
-       << "}";
+       << ",\"cppTextShapePreparedCount\":" << context.layoutProfile.text_shape_prepared_count;
+    ss << ",\"cppBatchItems\":[";
+    for (size_t i = 0; i < profile_batch_items.size(); ++i) {
+        if (i > 0) ss << ",";
+        ss << "{\"layout\":" << profile_batch_items[i].layout_ms
+           << ",\"draw\":" << profile_batch_items[i].draw_ms << "}";
+    }
+    ss << "]";
+    for (const auto& cache : context.cacheManager.getStats()) {
+        ss << ",\"cpp" << cache.name << "CacheHits\":" << cache.counters.hits << ",\"cpp"
+           << cache.name << "CacheMisses\":" << cache.counters.misses << ",\"cpp" << cache.name
+           << "CacheEvictions\":" << cache.counters.evictions << ",\"cpp" << cache.name
+           << "CacheSize\":" << cache.size;
+    }
+    ss << "}";
+    return ss.str();
+}
+
+static void count_styles(const litehtml::element::ptr& el, int& elements,
+                         std::unordered_set<const litehtml::css_properties*>& styles) {
+    elements++;
+    styles.insert(&el->css());
+    for (const auto& child : el->children()) {
+        count_styles(child, elements, styles);
+    }
+}
+
+std::string SatoruInstance::get_document_stats_json() const {
+    int elements = 0;
+    std::unordered_set<const litehtml::css_properties*> styles;
+    if (doc && doc->root()) count_styles(doc->root(), elements, styles);
+
+    std::ostringstream ss;
+    ss << "{\"elements\":" << elements << ",\"styles\":" << styles.size()
+       << ",\"measured\":" << (doc ? doc->measure_count() : 0) << "}";
     return ss.str();
 }
 
@@ -557,8 +664,8 @@ void api_destroy_instance(SatoruInstance* inst) { delete inst; }
 
 std::string api_html_to_svg(SatoruInstance* inst, const char* html, int width, int height,
                             const RenderOptions& options) {
-    return renderHtmlToSvg(html, width, height, inst->context, inst->get_full_master_css().c_str(),
-                           inst->context.getExtraCss().c_str(), options);
+    return renderHtmlToSvg(html, width, height, inst->context, inst->get_master_stylesheet(),
+                           inst->context.getUserStylesheet(), options);
 }
 
 const uint8_t* api_html_to_png(SatoruInstance* inst, const char* html, int width, int height,
@@ -567,8 +674,8 @@ const uint8_t* api_html_to_png(SatoruInstance* inst, const char* html, int width
         inst,
         [&]() {
             return renderHtmlToPng(html, width, height, inst->context,
-                                   inst->get_full_master_css().c_str(),
-                                   inst->context.getExtraCss().c_str(), options);
+                                   inst->get_master_stylesheet(),
+                                   inst->context.getUserStylesheet(), options);
         },
         &SatoruContext::set_last_png, out_size);
 }
@@ -579,8 +686,8 @@ const uint8_t* api_html_to_webp(SatoruInstance* inst, const char* html, int widt
         inst,
         [&]() {
             return renderHtmlToWebp(html, width, height, inst->context,
-                                    inst->get_full_master_css().c_str(),
-                                    inst->context.getExtraCss().c_str(), options);
+                                    inst->get_master_stylesheet(),
+                                    inst->context.getUserStylesheet(), options);
         },
         &SatoruContext::set_last_webp, out_size);
 }
@@ -592,8 +699,8 @@ const uint8_t* api_html_to_pdf(SatoruInstance* inst, const char* html, int width
         [&]() {
             std::vector<std::string> htmls = {html};
             return renderHtmlsToPdf(htmls, width, height, inst->context,
-                                    inst->get_full_master_css().c_str(),
-                                    inst->context.getExtraCss().c_str(), options);
+                                    inst->get_master_stylesheet(),
+                                    inst->context.getUserStylesheet(), options);
         },
         &SatoruContext::set_last_pdf, out_size);
 }
@@ -605,8 +712,8 @@ const uint8_t* api_htmls_to_pdf(SatoruInstance* inst, const std::vector<std::str
         inst,
         [&]() {
             return renderHtmlsToPdf(htmls, width, height, inst->context,
-                                    inst->get_full_master_css().c_str(),
-                                    inst->context.getExtraCss().c_str(), options);
+                                    inst->get_master_stylesheet(),
+                                    inst->context.getUserStylesheet(), options);
         },
         &SatoruContext::set_last_pdf, out_size);
 }
@@ -623,6 +730,13 @@ const uint8_t* api_render(SatoruInstance* inst, const std::vector<std::string>&
         return nullptr;
     }
 
+    // collect_resources usually just laid out this exact page; draw that document instead of
+    // parsing it again. PDF keeps the html path for its margins, header and footer.
+    if (format != RenderFormat::PDF && htmls.size() == 1 &&
+        inst->is_document_current(htmls[0], width, height, options.mediaType)) {
+        return api_render_from_state(inst, width, height, format, options, out_size);
+    }
+
     switch (format) {
         case RenderFormat::SVG: {
             std::string svg = api_html_to_svg(inst, htmls[0].c_str(), width, height, options);
@@ -644,6 +758,161 @@ const uint8_t* api_render(SatoruInstance* inst, const std::vector<std::string>&
     return nullptr;
 }
 
+const std::vector<sk_sp<SkData>>& api_render_formats(SatoruInstance* inst,
+                                                     const std::string& html, int width,
+                                                     int height,
+                                                     const std::vector<RenderFormat>& formats,
+                                                     const std::vector<RenderOptions>& options) {
+    inst->last_render_outputs.clear();
+    if (formats.empty()) return inst->last_render_outputs;
+
+    auto options_for = [&](size_t i) -> const RenderOptions& {
+        static const RenderOptions default_options;
+        return i < options.size() ? options[i] : default_options;
+    };
+
+    // Parse and lay out once; every format below draws this document.
+    if (!inst->is_document_current(html, width, height, options_for(0).mediaType)) {
+        inst->init_document(html.c_str(), width, height, options_for(0).mediaType);
+        inst->layout_document(width);
+    }
+    if (!inst->doc) {
+        inst->last_render_outputs.resize(formats.size());
+        return inst->last_render_outputs;
+    }
+
+    std::vector<std::pair<const RenderOptions*, SkBitmap>> bitmaps;
+    auto bitmap_for = [&](const RenderOptions& opts) -> const SkBitmap* {
+        for (const auto& entry : bitmaps) {
+            if (same_raster_output(*entry.first, opts)) return &entry.second;
+        }
+        SkBitmap bitmap;
+        if (!renderDocumentToBitmap(inst, width, height, opts, bitmap)) return nullptr;
+        bitmaps.emplace_back(&opts, std::move(bitmap));
+        return &bitmaps.back().second;
+    };
+
+    for (size_t i = 0; i < formats.size(); ++i) {
+        const RenderOptions& opts = options_for(i);
+        sk_sp<SkData> data;
+        switch (formats[i]) {
+            case RenderFormat::SVG: {
+                std::string svg = renderDocumentToSvg(inst, width, height, opts);
+                if (!svg.empty()) data = SkData::MakeWithCopy(svg.c_str(), svg.length());
+                break;
+            }
+            case RenderFormat::PNG:
+                if (const SkBitmap* bitmap = bitmap_for(opts)) data = encodePng(*bitmap);
+                break;
+            case RenderFormat::WebP:
+                if (const SkBitmap* bitmap = bitmap_for(opts)) data = encodeWebp(*bitmap);
+                break;
+            case RenderFormat::PDF:
+                data = renderDocumentToPdf(inst, width, height, opts);
+                break;
+            default:
+                break;
+        }
+        inst->last_render_outputs.push_back(std::move(data));
+    }
+    return inst->last_render_outputs;
+}
+
+const std::vector<sk_sp<SkData>>& api_render_batch(SatoruInstance* inst,
+                                                   const std::vector<std::string>& htmls,
+                                                   int width, int height,
+                                                   const std::vector<RenderFormat>& formats,
+                                                   const std::vector<RenderOptions>& options) {
+    inst->last_render_outputs.clear();
+    inst->profile_batch_items.clear();
+    if (htmls.empty() || formats.empty()) return inst->last_render_outputs;
+
+    static const RenderOptions default_options;
+    auto options_for = [&](size_t i) -> const RenderOptions& {
+        if (options.empty()) return default_options;
+        return options[std::min(i, options.size() - 1)];
+    };
+    auto elapsed_ms = [](const auto& start) {
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    };
+
+    inst->last_render_outputs.reserve(htmls.size());
+    for (size_t i = 0; i < htmls.size(); ++i) {
+        RenderFormat format = formats[std::min(i, formats.size() - 1)];
+        const RenderOptions& opts = options_for(i);
+        SatoruInstance::BatchItemProfile profile;
+
+        auto layout_start = std::chrono::high_resolution_clock::now();
+        if (!inst->is_document_current(htmls[i], width, height, opts.mediaType)) {
+            inst->init_document(htmls[i].c_str(), width, height, opts.mediaType);
+            inst->layout_document(width);
+        }
+        profile.layout_ms = elapsed_ms(layout_start);
+
+        auto draw_start = std::chrono::high_resolution_clock::now();
+        sk_sp<SkData> data;
+        if (inst->doc) {
+            switch (format) {
+                case RenderFormat::SVG: {
+                    std::string svg = renderDocumentToSvg(inst, width, height, opts);
+                    if (!svg.empty()) data = SkData::MakeWithCopy(svg.c_str(), svg.length());
+                    break;
+                }
+                case RenderFormat::PNG:
+                    data = renderDocumentToPng(inst, width, height, opts);
+                    break;
+                case RenderFormat::WebP:
+                    data = renderDocumentToWebp(inst, width, height, opts);
+                    break;
+                case RenderFormat::PDF:
+                    data = renderDocumentToPdf(inst, width, height, opts);
+                    break;
+                default:
+                    break;
+            }
+        }
+        profile.draw_ms = elapsed_ms(draw_start);
+
+        if (inst->collect_profile_enabled) inst->profile_batch_items.push_back(profile);
+        inst->last_render_outputs.push_back(std::move(data));
+    }
+    return inst->last_render_outputs;
+}
+
+bool api_render_to_stream(SatoruInstance* inst, const std::vector<std::string>& htmls, int width,
+                          int height, RenderFormat format, const RenderOptions& options,
+                          SkWStream* out) {
+    if (!inst || !out || htmls.empty()) return false;
+
+    if (format == RenderFormat::PDF) {
+        return renderHtmlsToPdf(htmls, width, height, inst->context,
+                                inst->get_master_stylesheet(), inst->context.getUserStylesheet(),
+                                options, out);
+    }
+
+    if (!inst->is_document_current(htmls[0], width, height, options.mediaType)) {
+        inst->init_document(htmls[0].c_str(), width, height, options.mediaType);
+        inst->layout_document(width);
+    }
+    if (!inst->doc) return false;
+
+    switch (format) {
+        case RenderFormat::SVG:
+            return renderDocumentToSvg(inst, width, height, options, out);
+        case RenderFormat::PNG:
+            return renderDocumentToPng(inst, width, height, options, out);
+        case RenderFormat::WebP: {
+            SkBitmap bitmap;
+            return renderDocumentToBitmap(inst, width, height, options, bitmap) &&
+                   encodeWebp(bitmap, out);
+        }
+        default:
+            break;
+    }
+    return false;
+}
+
 int api_get_last_png_size(SatoruInstance* inst) { return (int)inst->context.get_last_png_size(); }
 int api_get_last_webp_size(SatoruInstance* inst) { return (int)inst->context.get_last_webp_size(); }
 int api_get_last_pdf_size(SatoruInstance* inst) { return (int)inst->context.get_last_pdf_size(); }
@@ -658,6 +927,10 @@ std::string api_get_collect_profile(SatoruInstance* inst) {
     return inst ? inst->get_collect_profile_json() : "{}";
 }
 
+std::string api_get_document_stats(SatoruInstance* inst) {
+    return inst ? inst->get_document_stats_json() : "{}";
+}
+
 void api_set_collect_profile_enabled(SatoruInstance* inst, bool enabled) {
     if (inst) inst->set_collect_profile_enabled(enabled);
 }
@@ -750,6 +1023,10 @@ void api_layout_document(SatoruInstance* inst, int width) {
     inst->layout_document(width);
 }
 
+int api_patch_document(SatoruInstance* inst, const std::vector<DocumentPatch>& patches) {
+    return inst ? inst->patch_document(patches) : 0;
+}
+
 const uint8_t* api_render_from_state(SatoruInstance* inst, int width, int height,
                                      RenderFormat format, const RenderOptions& options,
                                      int& out_size) {
@@ -13,6 +13,7 @@
 #include "core/container_skia.h"
 #include "core/resource_manager.h"
 #include "core/satoru_context.h"
+#include "include/core/SkStream.h"
 
 class SatoruInstance {
    public:
@@ -34,7 +35,9 @@ class SatoruInstance {
     bool needs_relayout = false;
     std::string last_font_face_scan_html;
     std::string cached_full_master_css;
+    litehtml::shared_stylesheet::ptr master_stylesheet;
     std::vector<uint8_t> pending_resources_buffer;
+    std::vector<sk_sp<SkData>> last_render_outputs;
     double profile_scan_font_faces_ms = 0.0;
     double profile_create_document_ms = 0.0;
     double profile_render_layout_ms = 0.0;
@@ -56,17 +59,29 @@ class SatoruInstance {
     int profile_layout_count = 0;
     int profile_layout_size_count = 0;
     int profile_layout_relayout_count = 0;
+    // Per-item timings of the last api_render_batch call (filled when profiling is enabled).
+    struct BatchItemProfile {
+        double layout_ms = 0.0;
+        double draw_ms = 0.0;
+    };
+    std::vector<BatchItemProfile> profile_batch_items;
     bool collect_profile_enabled = false;
 
     SatoruInstance();
     ~SatoruInstance();
 
     // Core Logic
-    void init_document(const char *html, int width, int height);
+    void init_document(const char *html, int width, int height, int mediaType = 0);
     void layout_document(int width);
+    void invalidate_loaded_images();
     void collect_resources(const std::string &html, int width, int height, int mediaType = 0);
+    int patch_document(const std::vector<DocumentPatch> &patches);
+    bool is_document_current(const std::string &html, int width, int height,
+                             int mediaType = 0) const;
     const std::string &get_full_master_css() const;
+    litehtml::shared_stylesheet &get_master_stylesheet() { return *master_stylesheet; }
     std::string get_collect_profile_json() const;
+    std::string get_document_stats_json() const;
     void set_collect_profile_enabled(bool enabled) { collect_profile_enabled = enabled; }
 
     // Resource Management
@@ -85,7 +100,14 @@ void api_destroy_instance(SatoruInstance *inst);
 
 // State Management API
 void api_init_document(SatoruInstance *inst, const char *html, int width, int height);
+// Lays the retained document out at width (0 keeps the last width). Does nothing when the
+// width is unchanged, unless images have loaded since the last layout.
 void api_layout_document(SatoruInstance *inst, int width);
+// Applies patches to the retained document and lays it out again; only the patched elements
+// are restyled. Returns the number of elements changed. Resources the patched elements refer
+// to are queued as pending requests (see api_get_pending_resources); once they are added,
+// api_layout_document(inst, 0) picks them up. Draw with api_render_from_state.
+int api_patch_document(SatoruInstance *inst, const std::vector<DocumentPatch> &patches);
 const uint8_t *api_render_from_state(SatoruInstance *inst, int width, int height,
                                      RenderFormat format, const RenderOptions &options,
                                      int &out_size);
@@ -103,6 +125,30 @@ const uint8_t *api_htmls_to_pdf(SatoruInstance *inst, const std::vector<std::str
 const uint8_t *api_render(SatoruInstance *inst, const std::vector<std::string> &htmls, int width,
                           int height, RenderFormat format, const RenderOptions &options,
                           int &out_size);
+// Renders one document into several formats, one output per entry of `formats` (null on failure).
+// options[i] applies to formats[i]; the outputs stay valid until the next call.
+const std::vector<sk_sp<SkData>> &api_render_formats(SatoruInstance *inst,
+                                                     const std::string &html, int width,
+                                                     int height,
+                                                     const std::vector<RenderFormat> &formats,
+                                                     const std::vector<RenderOptions> &options);
+// Renders independent documents with one instance: htmls[i] is drawn as formats[i] with
+// options[i] (the last entry is reused when the lists are shorter than htmls). Master and user
+// stylesheets, loaded fonts, shaping caches and decoded images are shared by every item; only
+// parsing and layout are per item. Resources are expected to be loaded already (missing ones
+// are queued as pending requests, as with any render); SatoruBase.renderBatch on the JS side
+// collects and loads them for every item first. One output per html, null on failure;
+// the outputs stay valid until the next call.
+const std::vector<sk_sp<SkData>> &api_render_batch(SatoruInstance *inst,
+                                                   const std::vector<std::string> &htmls,
+                                                   int width, int height,
+                                                   const std::vector<RenderFormat> &formats,
+                                                   const std::vector<RenderOptions> &options);
+// Renders straight into `out` instead of keeping the result in the context, so the caller can
+// forward bytes while encoding continues. PDF pages are written as they finish, SVG in chunks.
+bool api_render_to_stream(SatoruInstance *inst, const std::vector<std::string> &htmls, int width,
+                          int height, RenderFormat format, const RenderOptions &options,
+                          SkWStream *out);
 const uint8_t *api_merge_pdfs(SatoruInstance *inst, const std::vector<sk_sp<SkData>> &pdfs,
                               int &out_size);
 int api_get_last_png_size(SatoruInstance *inst);
@@ -112,6 +158,10 @@ int api_get_last_svg_size(SatoruInstance *inst);
 void api_collect_resources(SatoruInstance *inst, const std::string &html, int width, int height,
                            int mediaType = 0);
 std::string api_get_collect_profile(SatoruInstance *inst);
+// Shape of the retained document as JSON: element count, the number of distinct computed
+// style objects among them (elements with equal styles share one), and how many boxes the
+// last layout measured rather than took from the memo.
+std::string api_get_document_stats(SatoruInstance *inst);
 void api_set_collect_profile_enabled(SatoruInstance *inst, bool enabled);
 void api_add_resource(SatoruInstance *inst, const std::string &url, int type,
                       const std::vector<uint8_t> &data);
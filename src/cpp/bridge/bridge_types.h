@@ -1,6 +1,7 @@
 #ifndef BRIDGE_TYPES_H
 #define BRIDGE_TYPES_H
 
+#include <memory>
 #include <set>
 #include <string>
 #include <tuple>
@@ -9,6 +10,7 @@
 
 #include "include/core/SkFont.h"
 #include "include/core/SkFontStyle.h"
+#include "include/core/SkImageFilter.h"
 #include "libs/litehtml/include/litehtml.h"
 
 enum class LogLevel { None = 0, Error = 1, Warning = 2, Info = 3, Debug = 4 };
@@ -45,6 +47,18 @@ struct RenderOptions {
     // PDF Templates
     std::string pdfHeader;
     std::string pdfFooter;
+
+    // PDF page height (pixels, margins included). When set, each document is laid out once
+    // and split into pages of this height; otherwise each document becomes one page.
+    int pdfPageHeight = 0;
+};
+
+// One edit of a retained template document: every element matching selector gets its text
+// content replaced by value, or attribute set to value when attribute is not empty.
+struct DocumentPatch {
+    std::string selector;
+    std::string attribute;
+    std::string value;
 };
 
 struct font_request {
@@ -68,6 +82,8 @@ struct font_info {
     bool fake_bold;
     bool fake_italic;
     bool is_rtl;
+    // Interned id of the resolved typefaces and synthetic styles; text caches key on it.
+    uint32_t font_set_id;
     std::vector<font_request> requests;
     std::set<char32_t> used_codepoints;
     std::unordered_map<char32_t, SkFont> selected_font_cache;
@@ -171,13 +187,31 @@ struct text_draw_info {
     }
 };
 
-struct filter_info {
+// A filter / backdrop-filter value compiled once and shared by every element that uses it.
+struct compiled_filter {
+    litehtml::css_token_vector tokens;
+    sk_sp<SkImageFilter> chain;  // null when none of the functions produce a filter
+};
+
+// A mask value split into its comma-separated layers once.
+struct compiled_mask {
+    litehtml::css_token_vector tokens;
+    std::vector<litehtml::css_token_vector> layers;
+};
+
+// A clip-path value; the shape itself depends on the box and is cached by size.
+struct compiled_clip_path {
     litehtml::css_token_vector tokens;
+    std::string key;
+};
+
+struct filter_info {
+    std::shared_ptr<const compiled_filter> filter;
     float opacity;
 };
 
 struct backdrop_filter_info {
-    litehtml::css_token_vector tokens;
+    std::shared_ptr<const compiled_filter> filter;
     litehtml::position box_pos;
     litehtml::border_radiuses box_radius;
     float opacity;
@@ -189,12 +223,12 @@ struct clip_info {
 };
 
 struct clip_path_info {
-    litehtml::css_token_vector tokens;
+    std::shared_ptr<const compiled_clip_path> clip_path;
     litehtml::position pos;
 };
 
 struct mask_info {
-    litehtml::css_token_vector tokens;
+    std::shared_ptr<const compiled_mask> mask;
     litehtml::position pos;
 };
 
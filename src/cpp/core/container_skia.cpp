@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <cstring>
 #include <iostream>
 #include <sstream>
@@ -281,6 +282,17 @@ litehtml::uint_ptr container_skia::create_font(const litehtml::font_description&
         }
     }
 
+    // Identify the font by what text is actually shaped with, so shaping/measure results can be
+    // reused by any later font_info that resolves to the same typefaces.
+    std::vector<uint32_t> font_set;
+    font_set.reserve(fi->fonts.size() + 2);
+    font_set.push_back(m_context.fontManager.getEmojiFontGeneration());
+    font_set.push_back((fi->fake_bold ? 1u : 0u) | (fi->fake_italic ? 2u : 0u));
+    for (auto* font : fi->fonts) {
+        font_set.push_back(font->getTypeface() ? font->getTypeface()->uniqueID() : 0);
+    }
+    fi->font_set_id = m_context.cacheManager.fontSetId(font_set);
+
     SkFontMetrics skfm;
     fi->fonts[0]->getMetrics(&skfm);
     float ascent = -skfm.fAscent;
@@ -359,20 +371,7 @@ litehtml::pixel_t container_skia::text_width(const char* text, litehtml::uint_pt
         }
     }
     font_info* fi = (font_info*)hFont;
-    if (fi) {
-        fi->is_rtl = (dir == litehtml::direction_rtl);
-        if (m_resourceManager && !fi->requests.empty()) {
-            if (fi->requests.size() == 1) {
-                collect_text_codepoints(m_context, text, m_measuredFontCodepoints[fi->requests[0]]);
-            } else {
-                auto codepoints = decode_text_codepoints(m_context, text);
-                for (const auto& req : fi->requests) {
-                    auto& measured = m_measuredFontCodepoints[req];
-                    measured.insert(codepoints.begin(), codepoints.end());
-                }
-            }
-        }
-    }
+    prepare_measure(fi, text, dir);
     auto result = satoru::TextLayout::measureText(&m_context, text, fi, mode, -1.0,
                                                   m_resourceManager ? &m_usedCodepoints : nullptr);
     if (m_context.layoutProfile.enabled) {
@@ -383,6 +382,49 @@ litehtml::pixel_t container_skia::text_width(const char* text, litehtml::uint_pt
     return (litehtml::pixel_t)result.width;
 }
 
+void container_skia::text_widths(const std::vector<const char*>& texts, litehtml::uint_ptr hFont,
+                                 litehtml::direction dir, litehtml::writing_mode mode,
+                                 std::vector<litehtml::pixel_t>& widths) {
+    if (texts.size() < 2) {
+        // A lone word is measured through the per-word cache.
+        litehtml::document_container::text_widths(texts, hFont, dir, mode, widths);
+        return;
+    }
+    auto profile_start = std::chrono::high_resolution_clock::time_point{};
+    if (m_context.layoutProfile.enabled) {
+        profile_start = std::chrono::high_resolution_clock::now();
+    }
+    font_info* fi = (font_info*)hFont;
+    for (const char* text : texts) {
+        prepare_measure(fi, text, dir);
+    }
+    std::vector<double> run_widths;
+    satoru::TextLayout::measureTextRun(&m_context, texts, fi, mode, run_widths,
+                                       m_resourceManager ? &m_usedCodepoints : nullptr);
+    widths.assign(run_widths.begin(), run_widths.end());
+    if (m_context.layoutProfile.enabled) {
+        auto profile_end = std::chrono::high_resolution_clock::now();
+        m_context.layoutProfile.container_text_width_ms +=
+            std::chrono::duration<double, std::milli>(profile_end - profile_start).count();
+    }
+}
+
+void container_skia::prepare_measure(font_info* fi, const char* text, litehtml::direction dir) {
+    if (!fi) return;
+    fi->is_rtl = (dir == litehtml::direction_rtl);
+    if (m_resourceManager && !fi->requests.empty()) {
+        if (fi->requests.size() == 1) {
+            collect_text_codepoints(m_context, text, m_measuredFontCodepoints[fi->requests[0]]);
+        } else {
+            auto codepoints = decode_text_codepoints(m_context, text);
+            for (const auto& req : fi->requests) {
+                auto& measured = m_measuredFontCodepoints[req];
+                measured.insert(codepoints.begin(), codepoints.end());
+            }
+        }
+    }
+}
+
 void container_skia::draw_text(litehtml::uint_ptr hdc, const char* text, litehtml::uint_ptr hFont,
                                litehtml::web_color color, const litehtml::position& pos,
                                litehtml::text_overflow overflow, litehtml::direction dir,
@@ -559,6 +601,17 @@ void container_skia::draw_box_shadow(litehtml::uint_ptr hdc, const litehtml::sha
     }
 }
 
+sk_sp<SkImage> container_skia::get_image(const std::string& url, const SkRect& dst) {
+    // Vector backends (PDF, picture recording) have no pixel grid, so they get the full image.
+    if (!m_canvas || m_canvas->imageInfo().colorType() == kUnknown_SkColorType) {
+        return m_context.getImage(url);
+    }
+    float scale = m_canvas->getTotalMatrix().getMaxScale();
+    if (scale <= 0) return m_context.getImage(url);
+    return m_context.getImage(url, (int)std::ceil(dst.width() * scale),
+                              (int)std::ceil(dst.height() * scale));
+}
+
 void container_skia::draw_image(litehtml::uint_ptr hdc, const litehtml::background_layer& layer,
                                 const std::string& url, const std::string& base_url,
                                 litehtml::object_fit fit,
@@ -608,8 +661,11 @@ void container_skia::draw_image(litehtml::uint_ptr hdc, const litehtml::backgrou
                              (float)layer.clip_box.width, (float)layer.clip_box.height),
             p);
     } else {
-        auto it = m_context.imageCache.find(url);
-        if (it != m_context.imageCache.end() && it->second.skImage) {
+        SkRect dst =
+            SkRect::MakeXYWH((float)layer.origin_box.x, (float)layer.origin_box.y,
+                             (float)layer.origin_box.width, (float)layer.origin_box.height);
+        sk_sp<SkImage> image = get_image(url, dst);
+        if (image) {
             SkPaint p;
             p.setAntiAlias(true);
 
@@ -617,12 +673,8 @@ void container_skia::draw_image(litehtml::uint_ptr hdc, const litehtml::backgrou
             // Clip to layer.clip_box which respects background-clip
             m_canvas->clipRRect(get_background_rrect(layer), true);
 
-            SkRect dst =
-                SkRect::MakeXYWH((float)layer.origin_box.x, (float)layer.origin_box.y,
-                                 (float)layer.origin_box.width, (float)layer.origin_box.height);
-
             if (layer.repeat == litehtml::background_repeat_no_repeat) {
-                m_canvas->drawImageRect(it->second.skImage, dst,
+                m_canvas->drawImageRect(image, dst,
                                         SkSamplingOptions(SkFilterMode::kLinear), &p);
             } else {
                 SkTileMode tileX = SkTileMode::kRepeat;
@@ -647,14 +699,14 @@ void container_skia::draw_image(litehtml::uint_ptr hdc, const litehtml::backgrou
                         break;
                 }
 
-                float scaleX = (float)layer.origin_box.width / it->second.skImage->width();
-                float scaleY = (float)layer.origin_box.height / it->second.skImage->height();
+                float scaleX = (float)layer.origin_box.width / image->width();
+                float scaleY = (float)layer.origin_box.height / image->height();
 
                 SkMatrix matrix;
                 matrix.setScaleTranslate(scaleX, scaleY, (float)layer.origin_box.x,
                                          (float)layer.origin_box.y);
 
-                p.setShader(it->second.skImage->makeShader(
+                p.setShader(image->makeShader(
                     tileX, tileY, SkSamplingOptions(SkFilterMode::kLinear), &matrix));
 
                 m_canvas->drawRect(
@@ -944,9 +996,9 @@ void container_skia::draw_border_image(litehtml::uint_ptr hdc,
 
     sk_sp<SkImage> img;
     if (border_image.source.type == litehtml::image::type_url) {
-        auto it = m_context.imageCache.find(border_image.source.url);
-        if (it == m_context.imageCache.end() || !it->second.skImage) return;
-        img = it->second.skImage;
+        // Slices are cut in image pixels, so border images keep their natural size.
+        img = m_context.getImage(border_image.source.url);
+        if (!img) return;
     } else if (border_image.source.type == litehtml::image::type_gradient) {
         // For border-image, the gradient's intrinsic size is the border image area.
         int w = draw_pos.width;
@@ -1402,10 +1454,10 @@ void container_skia::draw_list_marker(litehtml::uint_ptr hdc, const litehtml::li
 
     if (!marker.image.empty()) {
         std::string url = marker.image;
+        SkRect dst = SkRect::MakeXYWH((float)marker.pos.x, (float)marker.pos.y,
+                                      (float)marker.pos.width, (float)marker.pos.height);
         auto it = m_context.imageCache.find(url);
-        if (it != m_context.imageCache.end() && it->second.skImage) {
-            SkRect dst = SkRect::MakeXYWH((float)marker.pos.x, (float)marker.pos.y,
-                                          (float)marker.pos.width, (float)marker.pos.height);
+        if (it != m_context.imageCache.end() && (it->second.skImage || it->second.encoded)) {
             SkPaint p;
             p.setAntiAlias(true);
             if (m_tagging) {
@@ -1421,9 +1473,8 @@ void container_skia::draw_list_marker(litehtml::uint_ptr hdc, const litehtml::li
                 int index = (int)m_usedImageDraws.size();
                 p.setColor(make_magic_color(satoru::MagicTagExtended::ImageDraw, index));
                 m_canvas->drawRect(dst, p);
-            } else {
-                m_canvas->drawImageRect(it->second.skImage, dst,
-                                        SkSamplingOptions(SkFilterMode::kLinear), &p);
+            } else if (sk_sp<SkImage> image = get_image(url, dst)) {
+                m_canvas->drawImageRect(image, dst, SkSamplingOptions(SkFilterMode::kLinear), &p);
             }
         }
         return;
@@ -1603,14 +1654,29 @@ SkBlendMode container_skia::to_skia_blend_mode(litehtml::blend_mode bm) {
     }
 }
 
+std::shared_ptr<const compiled_mask> container_skia::get_compiled_mask(
+    const litehtml::css_token_vector& tokens) {
+    auto& cache = m_context.cacheManager.maskCache;
+    std::string key = litehtml::get_repr(tokens);
+    if (auto* cached = cache.get(key)) return *cached;
+
+    auto compiled = std::make_shared<compiled_mask>();
+    compiled->tokens = tokens;
+    compiled->layers = litehtml::parse_comma_separated_list(tokens);
+    cache.put(std::move(key), compiled);
+    return compiled;
+}
+
 void container_skia::push_mask(litehtml::uint_ptr hdc, const litehtml::css_token_vector& mask,
                                const litehtml::position& pos) {
     if (!m_canvas || mask.empty()) return;
     flush();
 
+    auto compiled = get_compiled_mask(mask);
+
     if (m_tagging) {
         mask_info info;
-        info.tokens = mask;
+        info.mask = compiled;
         info.pos = pos;
         m_usedMasks.push_back(info);
         int index = (int)m_usedMasks.size();
@@ -1632,7 +1698,7 @@ void container_skia::push_mask(litehtml::uint_ptr hdc, const litehtml::css_token
         return;
     }
 
-    m_mask_stack.push_back({mask, pos});
+    m_mask_stack.push_back({compiled, pos});
     m_canvas->saveLayer(
         SkRect::MakeXYWH((float)pos.x, (float)pos.y, (float)pos.width, (float)pos.height), nullptr);
     m_mask_stack_depth++;
@@ -1662,7 +1728,6 @@ void container_skia::pop_mask(litehtml::uint_ptr hdc) {
         auto mask_data = m_mask_stack.back();
         m_mask_stack.pop_back();
 
-        const auto& mask_tokens = mask_data.first;
         const auto& pos = mask_data.second;
 
         // Start mask composite layer
@@ -1670,24 +1735,21 @@ void container_skia::pop_mask(litehtml::uint_ptr hdc) {
         mask_composite_paint.setBlendMode(SkBlendMode::kDstIn);
         m_canvas->saveLayer(nullptr, &mask_composite_paint);
 
-        auto layers = litehtml::parse_comma_separated_list(mask_tokens);
-
-        for (const auto& layer_tokens : layers) {
+        for (const auto& layer_tokens : mask_data.first->layers) {
             for (const auto& tok : layer_tokens) {
                 if (tok.type == litehtml::CV_FUNCTION) {
                     std::string name = litehtml::lowcase(tok.name);
                     if (name == "url") {
                         if (!tok.value.empty()) {
                             std::string url = tok.value.front().str;
-                            auto it = m_context.imageCache.find(url);
-                            if (it != m_context.imageCache.end() && it->second.skImage) {
+                            SkRect dst = SkRect::MakeXYWH((float)pos.x, (float)pos.y,
+                                                          (float)pos.width, (float)pos.height);
+                            sk_sp<SkImage> image = get_image(url, dst);
+                            if (image) {
                                 SkPaint p;
                                 p.setAntiAlias(true);
                                 m_canvas->drawImageRect(
-                                    it->second.skImage,
-                                    SkRect::MakeXYWH((float)pos.x, (float)pos.y, (float)pos.width,
-                                                     (float)pos.height),
-                                    SkSamplingOptions(SkFilterMode::kLinear), &p);
+                                    image, dst, SkSamplingOptions(SkFilterMode::kLinear), &p);
                             }
                         }
                     } else if (name == "linear-gradient" || name == "repeating-linear-gradient" ||
@@ -1726,16 +1788,16 @@ litehtml::element::ptr container_skia::create_element(
     const std::shared_ptr<litehtml::document>& doc) {
     std::string tag = tag_name;
     if (tag == "table") {
-        return std::make_shared<litehtml::el_table>(doc);
+        return litehtml::make_node<litehtml::el_table>(doc->arena(), doc);
     }
     if (tag == "tr") {
-        return std::make_shared<litehtml::el_tr>(doc);
+        return litehtml::make_node<litehtml::el_tr>(doc->arena(), doc);
     }
     if (tag == "td" || tag == "th") {
-        return std::make_shared<litehtml::el_td>(doc);
+        return litehtml::make_node<litehtml::el_td>(doc->arena(), doc);
     }
     if (tag == "svg") {
-        return std::make_shared<litehtml::el_svg>(doc);
+        return litehtml::make_node<litehtml::el_svg>(doc->arena(), doc);
     }
     return nullptr;
 }
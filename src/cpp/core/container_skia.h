@@ -58,8 +58,8 @@ class container_skia : public litehtml::document_container {
     std::vector<litehtml::position> m_inlineSvgPositions;
     std::vector<clip_info> m_usedClips;
     std::vector<clip_path_info> m_usedClipPaths;
-    std::vector<std::pair<litehtml::css_token_vector, litehtml::position>> m_mask_stack;
-    std::vector<SkPath> m_usedGlyphs;
+    std::vector<std::pair<std::shared_ptr<const compiled_mask>, litehtml::position>> m_mask_stack;
+    satoru::GlyphRegistry m_usedGlyphs;
     std::vector<glyph_draw_info> m_usedGlyphDraws;
 
     // Pending text-clip gradients for PNG background-clip: text support
@@ -90,6 +90,13 @@ class container_skia : public litehtml::document_container {
         return opacity;
     }
 
+    // Looks the image up in the context, decoded for the device-pixel size of dst.
+    sk_sp<SkImage> get_image(const std::string &url, const SkRect &dst);
+
+    // Prepares fi for measuring text in direction dir and notes the codepoints of text for the
+    // font requests fi was created from.
+    void prepare_measure(font_info *fi, const char *text, litehtml::direction dir);
+
    public:
     container_skia(int w, int h, SkCanvas *canvas, SatoruContext &context, ResourceManager *rm,
                    bool tagging = false,
@@ -184,16 +191,10 @@ class container_skia : public litehtml::document_container {
     }
     const std::vector<clip_path_info> &get_used_clip_paths() const { return m_usedClipPaths; }
     const std::vector<mask_info> &get_used_masks() const { return m_usedMasks; }
-    const std::vector<SkPath> &get_used_glyphs() const { return m_usedGlyphs; }
+    const std::vector<SkPath> &get_used_glyphs() const { return m_usedGlyphs.paths(); }
     const std::vector<glyph_draw_info> &get_used_glyph_draws() const { return m_usedGlyphDraws; }
 
-    int add_glyph(const SkPath &path) {
-        for (size_t i = 0; i < m_usedGlyphs.size(); ++i) {
-            if (m_usedGlyphs[i] == path) return (int)i + 1;
-        }
-        m_usedGlyphs.push_back(path);
-        return (int)m_usedGlyphs.size();
-    }
+    int add_glyph(const SkPath &path) { return m_usedGlyphs.add(path); }
 
     int add_glyph_draw(const glyph_draw_info &info) {
         m_usedGlyphDraws.push_back(info);
@@ -220,6 +221,9 @@ class container_skia : public litehtml::document_container {
     virtual litehtml::pixel_t text_width(const char *text, litehtml::uint_ptr hFont,
                                          litehtml::direction dir,
                                          litehtml::writing_mode mode) override;
+    virtual void text_widths(const std::vector<const char *> &texts, litehtml::uint_ptr hFont,
+                             litehtml::direction dir, litehtml::writing_mode mode,
+                             std::vector<litehtml::pixel_t> &widths) override;
     virtual void draw_text(litehtml::uint_ptr hdc, const char *text, litehtml::uint_ptr hFont,
                            litehtml::web_color color, const litehtml::position &pos,
                            litehtml::text_overflow overflow, litehtml::direction dir,
@@ -312,6 +316,19 @@ class container_skia : public litehtml::document_container {
     static SkPath parse_clip_path(const litehtml::css_token_vector &tokens,
                                   const litehtml::position &pos);
 
+    /// Compiled filter (backdrop = false) or backdrop-filter chain for a value, built once per
+    /// distinct value and shared through the context cache.
+    std::shared_ptr<const compiled_filter> get_compiled_filter(
+        const litehtml::css_token_vector &tokens, bool backdrop);
+    std::shared_ptr<const compiled_mask> get_compiled_mask(const litehtml::css_token_vector &tokens);
+    std::shared_ptr<const compiled_clip_path> get_compiled_clip_path(
+        const litehtml::css_token_vector &tokens);
+
+    /// Shape of a clip-path for the box pos. Shapes are cached per value and box size and
+    /// translated to the box position.
+    static SkPath clip_path_shape(SatoruContext &context, const compiled_clip_path &clip_path,
+                                  const litehtml::position &pos);
+
     /// Convert litehtml::blend_mode to SkBlendMode.
     static SkBlendMode to_skia_blend_mode(litehtml::blend_mode bm);
 };
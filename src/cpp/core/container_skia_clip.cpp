@@ -1,4 +1,5 @@
 #include <cmath>
+#include <string>
 
 #include "bridge/magic_tags.h"
 #include "container_skia.h"
@@ -287,15 +288,51 @@ SkPath container_skia::parse_clip_path(const litehtml::css_token_vector& tokens,
     return builder.detach();
 }
 
+std::shared_ptr<const compiled_clip_path> container_skia::get_compiled_clip_path(
+    const litehtml::css_token_vector& tokens) {
+    auto& cache = m_context.cacheManager.clipPathCache;
+    std::string key = litehtml::get_repr(tokens);
+    if (auto* cached = cache.get(key)) return *cached;
+
+    auto compiled = std::make_shared<compiled_clip_path>();
+    compiled->tokens = tokens;
+    compiled->key = key;
+    cache.put(std::move(key), compiled);
+    return compiled;
+}
+
+SkPath container_skia::clip_path_shape(SatoruContext& context,
+                                       const compiled_clip_path& clip_path,
+                                       const litehtml::position& pos) {
+    // Every shape is relative to the box, so one built at the origin serves all boxes of a size.
+    auto& cache = context.cacheManager.clipPathShapeCache;
+    std::string key = clip_path.key + '\0' + std::to_string(pos.width) + 'x' +
+                      std::to_string(pos.height);
+    SkPath path;
+    if (auto* cached = cache.get(key)) {
+        path = *cached;
+    } else {
+        litehtml::position origin = pos;
+        origin.x = 0;
+        origin.y = 0;
+        path = parse_clip_path(clip_path.tokens, origin);
+        cache.put(std::move(key), path);
+    }
+    if (pos.x == 0 && pos.y == 0) return path;
+    return path.makeOffset((float)pos.x, (float)pos.y);
+}
+
 void container_skia::push_clip_path(litehtml::uint_ptr hdc,
                                     const litehtml::css_token_vector& clip_path,
                                     const litehtml::position& pos) {
     if (!m_canvas || clip_path.empty()) return;
     flush();
 
+    auto compiled = get_compiled_clip_path(clip_path);
+
     if (m_tagging) {
         clip_path_info info;
-        info.tokens = clip_path;
+        info.clip_path = compiled;
         info.pos = pos;
         m_usedClipPaths.push_back(info);
         int index = (int)m_usedClipPaths.size();
@@ -317,7 +354,7 @@ void container_skia::push_clip_path(litehtml::uint_ptr hdc,
         return;
     }
 
-    SkPath path = container_skia::parse_clip_path(clip_path, pos);
+    SkPath path = clip_path_shape(m_context, *compiled, pos);
     if (!path.isEmpty()) {
         m_canvas->save();
         m_canvas->clipPath(path, true);
@@ -8,6 +8,24 @@
 #include "litehtml/render_item.h"
 #include "utils/skia_utils.h"
 
+// ────────────────────────────────────────────────────────────────────────────
+// Compiled filter values
+// ────────────────────────────────────────────────────────────────────────────
+
+std::shared_ptr<const compiled_filter> container_skia::get_compiled_filter(
+    const litehtml::css_token_vector& tokens, bool backdrop) {
+    auto& cache = backdrop ? m_context.cacheManager.backdropFilterCache
+                           : m_context.cacheManager.filterCache;
+    std::string key = litehtml::get_repr(tokens);
+    if (auto* cached = cache.get(key)) return *cached;
+
+    auto compiled = std::make_shared<compiled_filter>();
+    compiled->tokens = tokens;
+    compiled->chain = backdrop ? build_backdrop_filter_chain(tokens) : build_filter_chain(tokens);
+    cache.put(std::move(key), compiled);
+    return compiled;
+}
+
 // ────────────────────────────────────────────────────────────────────────────
 // Backdrop filter
 // ────────────────────────────────────────────────────────────────────────────
@@ -17,9 +35,11 @@ void container_skia::push_backdrop_filter(litehtml::uint_ptr hdc,
     if (!m_canvas || el->src_el()->css().get_backdrop_filter().empty()) return;
     flush();
 
+    auto compiled = get_compiled_filter(el->src_el()->css().get_backdrop_filter(), true);
+
     if (m_tagging) {
         backdrop_filter_info info;
-        info.tokens = el->src_el()->css().get_backdrop_filter();
+        info.filter = compiled;
 
         litehtml::position el_pos_abs = el->get_placement();
         info.box_pos.x = (int)(el_pos_abs.x - el->padding_left() - el->border_left());
@@ -44,7 +64,7 @@ void container_skia::push_backdrop_filter(litehtml::uint_ptr hdc,
         return;
     }
 
-    auto last_filter = build_backdrop_filter_chain(el->src_el()->css().get_backdrop_filter());
+    const auto& last_filter = compiled->chain;
 
     if (last_filter) {
         litehtml::position el_pos_abs = el->get_placement();
@@ -94,9 +114,11 @@ void container_skia::push_filter(litehtml::uint_ptr hdc, const litehtml::css_tok
     if (!m_canvas || filter.empty()) return;
     flush();
 
+    auto compiled = get_compiled_filter(filter, false);
+
     if (m_tagging) {
         filter_info info;
-        info.tokens = filter;
+        info.filter = compiled;
         info.opacity = get_current_opacity();
         m_usedFilters.push_back(info);
         int index = (int)m_usedFilters.size();
@@ -118,11 +140,9 @@ void container_skia::push_filter(litehtml::uint_ptr hdc, const litehtml::css_tok
         return;
     }
 
-    auto last_filter = build_filter_chain(filter);
-
-    if (last_filter) {
+    if (compiled->chain) {
         SkPaint paint;
-        paint.setImageFilter(last_filter);
+        paint.setImageFilter(compiled->chain);
         m_canvas->saveLayer(nullptr, &paint);
         m_filter_stack_depth++;
     } else {
@@ -7,6 +7,8 @@
 #include "bridge/magic_tags.h"
 #include "container_skia.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
 #include "include/core/SkStream.h"
 #include "libs/litehtml/include/litehtml/render_image.h"
 #include "libs/litehtml/include/litehtml/render_item.h"
@@ -33,8 +35,7 @@ class SatoruImageAsset : public skresources::ImageAsset {
 
 class SatoruResourceProvider : public skresources::ResourceProvider {
    public:
-    SatoruResourceProvider(const std::map<std::string, image_info>& imageCache)
-        : m_imageCache(imageCache) {}
+    SatoruResourceProvider(SatoruContext& context) : m_context(context) {}
 
     sk_sp<skresources::ImageAsset> loadImageAsset(const char path[], const char name[],
                                                   const char id[]) const override {
@@ -51,22 +52,26 @@ class SatoruResourceProvider : public skresources::ResourceProvider {
 
         if (full_path.empty()) return nullptr;
 
-        auto it = m_imageCache.find(full_path);
-        if (it != m_imageCache.end() && it->second.skImage) {
-            return sk_make_sp<SatoruImageAsset>(it->second.skImage);
+        if (auto image = m_context.getImage(full_path)) {
+            return sk_make_sp<SatoruImageAsset>(std::move(image));
         }
 
+        m_missingImage = true;
         return nullptr;
     }
 
+    // An SVG drawn without one of its images must not be cached: the image may load later.
+    bool missingImage() const { return m_missingImage; }
+
    private:
-    const std::map<std::string, image_info>& m_imageCache;
+    SatoruContext& m_context;
+    mutable bool m_missingImage = false;
 };
 
 }  // namespace
 
 el_svg::el_svg(const std::shared_ptr<document>& doc) : html_tag(doc) {
-    m_css.set_display(display_inline_block);
+    css_w().set_display(display_inline_block);
 }
 el_svg::~el_svg() {}
 
@@ -118,7 +123,7 @@ void el_svg::get_content_size(size& sz, pixel_t max_width) {
 
 std::shared_ptr<render_item> el_svg::create_render_item(
     const std::shared_ptr<render_item>& parent_ri) {
-    auto ret = std::make_shared<render_item_image>(shared_from_this());
+    auto ret = make_node<render_item_image>(arena(), shared_from_this());
     ret->parent(parent_ri);
     return ret;
 }
@@ -284,24 +289,46 @@ void el_svg::draw(uint_ptr hdc, pixel_t x, pixel_t y, const position* clip,
         canvas->drawRect(
             SkRect::MakeXYWH((float)pos.x, (float)pos.y, (float)pos.width, (float)pos.height), p);
     } else {
-        SkMemoryStream stream(xml.c_str(), xml.size());
-        auto resource_provider =
-            sk_make_sp<SatoruResourceProvider>(container->get_context().imageCache);
-        auto proxy_rp = skresources::DataURIResourceProviderProxy::Make(
-            resource_provider, skresources::ImageDecodeStrategy::kPreDecode);
-
-        SkSVGDOM::Builder builder;
-        builder.setResourceProvider(proxy_rp);
-        auto svg_dom = builder.make(stream);
+        // The XML only depends on the size and the current color here, so repeated icons
+        // replay a recorded picture instead of parsing and building the DOM again. Images and
+        // fonts it refers to can load or change later, so the key also carries their versions.
+        auto& ctx = container->get_context();
+        auto& cache = ctx.cacheManager.svgPictureCache;
+        size_t xml_size = xml.size();
+        xml.push_back('\0');
+        xml.append(std::to_string(ctx.getImageVersion()));
+        xml.push_back(':');
+        xml.append(std::to_string(ctx.getFontVersion()));
+
+        sk_sp<SkPicture> picture;
+        if (auto* cached = cache.get(xml)) {
+            picture = *cached;
+        } else {
+            SkMemoryStream stream(xml.data(), xml_size);
+            auto resource_provider = sk_make_sp<SatoruResourceProvider>(ctx);
+            auto proxy_rp = skresources::DataURIResourceProviderProxy::Make(
+                resource_provider, skresources::ImageDecodeStrategy::kPreDecode);
+
+            SkSVGDOM::Builder builder;
+            builder.setResourceProvider(proxy_rp);
+            auto svg_dom = builder.make(stream);
+
+            if (svg_dom) {
+                SkSize container_size = SkSize::Make((float)pos.width, (float)pos.height);
+                SkPictureRecorder recorder;
+                SkCanvas* recording = recorder.beginRecording(
+                    SkRect::MakeWH(container_size.width(), container_size.height()));
+                svg_dom->setContainerSize(container_size);
+                svg_dom->render(recording);
+                picture = recorder.finishRecordingAsPicture();
+            }
+            if (!resource_provider->missingImage()) cache.put(std::move(xml), picture);
+        }
 
-        if (svg_dom) {
+        if (picture) {
             canvas->save();
             canvas->translate((float)pos.x, (float)pos.y);
-
-            SkSize container_size = SkSize::Make((float)pos.width, (float)pos.height);
-            svg_dom->setContainerSize(container_size);
-            svg_dom->render(canvas);
-
+            canvas->drawPicture(picture);
             canvas->restore();
         }
     }
@@ -6,6 +6,7 @@
 #include <mutex>
 #include <sstream>
 
+#include "core/text/glyph_coverage.h"
 #include "core/text/unicode_service.h"
 #include "include/core/SkData.h"
 #include "include/core/SkFont.h"
@@ -53,6 +54,19 @@ struct global_typeface_clone_key {
 };
 std::map<global_typeface_clone_key, sk_sp<SkTypeface>> g_variable_clone_cache;
 
+// Fallback lookups test this instead of asking each typeface's cmap again. Typefaces are shared
+// by every instance through the registries above, so their coverage is shared as well.
+satoru::GlyphCoverageIndex g_glyph_coverage;
+
+bool has_glyph(const SkTypeface* typeface, char32_t u) {
+    std::lock_guard<std::mutex> lock(g_font_mutex);
+    return g_glyph_coverage.covers(typeface, u);
+}
+
+bool has_glyph(const sk_sp<SkTypeface>& typeface, char32_t u) {
+    return has_glyph(typeface.get(), u);
+}
+
 uint64_t compute_data_hash(const uint8_t* data, size_t size) {
     if (size == 0) return 0;
     uint64_t h = size;
@@ -224,6 +238,10 @@ bool SatoruFontManager::loadFont(const char* name, const uint8_t* data, int size
                 if (cleaned.find("emoji") != std::string::npos) {
                     m_typefaceCache["notocoloremoji"].push_back({typeface, intended_style});
                 }
+                if (cleaned.find("emoji") != std::string::npos ||
+                    cleaned.find("color") != std::string::npos) {
+                    m_emojiFontGeneration++;
+                }
             }
         }
         return changed;
@@ -238,6 +256,7 @@ void SatoruFontManager::clear() {
     m_fontFaces.clear();
     m_fallbackTypefaces.clear();
     m_defaultTypeface = nullptr;
+    m_emojiFontGeneration++;
 }
 
 void SatoruFontManager::scanFontFaces(const std::string& css) {
@@ -691,6 +710,23 @@ std::string SatoruFontManager::generateFontFaceCSS() const {
     return ss.str();
 }
 
+void SatoruFontManager::updateEmojiTypefaces() {
+    if (m_emojiListGeneration == m_emojiFontGeneration) return;
+    m_emojiListGeneration = m_emojiFontGeneration;
+    m_colorTypefaces.clear();
+    m_emojiTypefaces.clear();
+    for (auto const& [name, typefaces] : m_typefaceCache) {
+        std::string lowerName = name;
+        std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
+        bool is_color = lowerName.find("color") != std::string::npos;
+        bool is_emoji = lowerName.find("emoji") != std::string::npos;
+        for (auto const& tc : typefaces) {
+            if (is_color) m_colorTypefaces.push_back(tc.typeface);
+            if (is_emoji) m_emojiTypefaces.push_back(tc.typeface);
+        }
+    }
+}
+
 SkFont SatoruFontManager::selectFont(char32_t u, font_info* fi, SkFont* lastSelectedFont,
                                      const satoru::UnicodeService& unicode) {
     return selectFont(u, fi, lastSelectedFont, unicode, unicode.isEmoji(u), unicode.isMark(u));
@@ -709,11 +745,13 @@ SkFont SatoruFontManager::selectFont(char32_t u, font_info* fi, SkFont* lastSele
     }
 
     if (is_emoji) {
+        updateEmojiTypefaces();
+
         // Pass 0: Exact match for notocoloremoji
         auto it = m_typefaceCache.find("notocoloremoji");
         if (it != m_typefaceCache.end()) {
             for (auto const& tc : it->second) {
-                if (tc.typeface->unicharToGlyph(u) != 0) {
+                if (has_glyph(tc.typeface, u)) {
                     static std::map<SkTypefaceID, std::unique_ptr<SkFont>> s_color_cache;
                     SkTypefaceID id = tc.typeface->uniqueID();
                     if (s_color_cache.find(id) == s_color_cache.end()) {
@@ -728,47 +766,33 @@ SkFont SatoruFontManager::selectFont(char32_t u, font_info* fi, SkFont* lastSele
 
         // PASS 1: Mandatory Color Font Search (name contains "color")
         if (!selected_font) {
-            for (auto const& [name, typefaces] : m_typefaceCache) {
-                std::string lowerName = name;
-                std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
-                if (lowerName.find("color") != std::string::npos) {
-                    for (auto const& tc : typefaces) {
-                        if (tc.typeface->unicharToGlyph(u) != 0) {
-                            static std::map<SkTypefaceID, std::unique_ptr<SkFont>> s_color_cache;
-                            SkTypefaceID id = tc.typeface->uniqueID();
-                            if (s_color_cache.find(id) == s_color_cache.end()) {
-                                s_color_cache[id] = std::unique_ptr<SkFont>(
-                                    createSkFont(tc.typeface, fi->fonts[0]->getSize(), 400));
-                            }
-                            selected_font = s_color_cache[id].get();
-                            break;
-                        }
+            for (auto const& typeface : m_colorTypefaces) {
+                if (has_glyph(typeface, u)) {
+                    static std::map<SkTypefaceID, std::unique_ptr<SkFont>> s_color_cache;
+                    SkTypefaceID id = typeface->uniqueID();
+                    if (s_color_cache.find(id) == s_color_cache.end()) {
+                        s_color_cache[id] = std::unique_ptr<SkFont>(
+                            createSkFont(typeface, fi->fonts[0]->getSize(), 400));
                     }
+                    selected_font = s_color_cache[id].get();
+                    break;
                 }
-                if (selected_font) break;
             }
         }
 
         // PASS 2: General Emoji Font Search
         if (!selected_font) {
-            for (auto const& [name, typefaces] : m_typefaceCache) {
-                std::string lowerName = name;
-                std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
-                if (lowerName.find("emoji") != std::string::npos) {
-                    for (auto const& tc : typefaces) {
-                        if (tc.typeface->unicharToGlyph(u) != 0) {
-                            static std::map<SkTypefaceID, std::unique_ptr<SkFont>> s_emoji_cache;
-                            SkTypefaceID id = tc.typeface->uniqueID();
-                            if (s_emoji_cache.find(id) == s_emoji_cache.end()) {
-                                s_emoji_cache[id] = std::unique_ptr<SkFont>(
-                                    createSkFont(tc.typeface, fi->fonts[0]->getSize(), 400));
-                            }
-                            selected_font = s_emoji_cache[id].get();
-                            break;
-                        }
+            for (auto const& typeface : m_emojiTypefaces) {
+                if (has_glyph(typeface, u)) {
+                    static std::map<SkTypefaceID, std::unique_ptr<SkFont>> s_emoji_cache;
+                    SkTypefaceID id = typeface->uniqueID();
+                    if (s_emoji_cache.find(id) == s_emoji_cache.end()) {
+                        s_emoji_cache[id] = std::unique_ptr<SkFont>(
+                            createSkFont(typeface, fi->fonts[0]->getSize(), 400));
                     }
+                    selected_font = s_emoji_cache[id].get();
+                    break;
                 }
-                if (selected_font) break;
             }
         }
     }
@@ -776,8 +800,7 @@ emoji_found:
 
     // 2. Check if the previous font is usable (MRU optimization)
     if (!selected_font && lastSelectedFont) {
-        SkGlyphID glyph = lastSelectedFont->getTypeface()->unicharToGlyph(u);
-        if (glyph != 0 || is_mark) {
+        if (is_mark || has_glyph(lastSelectedFont->getTypeface(), u)) {
             selected_font = lastSelectedFont;
         }
     }
@@ -785,7 +808,7 @@ emoji_found:
     // 3. If still no font selected, search through all fonts
     if (!selected_font) {
         for (auto f : fi->fonts) {
-            if (f->getTypeface()->unicharToGlyph(u) != 0) {
+            if (has_glyph(f->getTypeface(), u)) {
                 selected_font = f;
                 break;
             }
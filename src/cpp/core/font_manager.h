@@ -1,6 +1,7 @@
 #ifndef SATORU_FONT_MANAGER_H
 #define SATORU_FONT_MANAGER_H
 
+#include <cstdint>
 #include <map>
 #include <set>
 #include <string>
@@ -59,6 +60,10 @@ class SatoruFontManager : public satoru::IFontManager {
     // ── Non-virtual extensions (SatoruFontManager-specific) ───────────
     sk_sp<SkFontMgr> getFontMgr() const { return m_fontMgr; }
 
+    // Bumped whenever a family that selectFont searches for emoji ("emoji"/"color" names) gains
+    // a typeface, since emoji selection looks beyond font_info::fonts.
+    uint32_t getEmojiFontGeneration() const { return m_emojiFontGeneration; }
+
    private:
     sk_sp<SkFontMgr> m_fontMgr;
 
@@ -77,6 +82,15 @@ class SatoruFontManager : public satoru::IFontManager {
 
     sk_sp<SkTypeface> m_defaultTypeface;
     std::vector<sk_sp<SkTypeface>> m_fallbackTypefaces;
+    uint32_t m_emojiFontGeneration = 0;
+
+    // Typefaces of families whose name contains "color" / "emoji", in m_typefaceCache order;
+    // rebuilt when m_emojiFontGeneration moves past m_emojiListGeneration.
+    std::vector<sk_sp<SkTypeface>> m_colorTypefaces;
+    std::vector<sk_sp<SkTypeface>> m_emojiTypefaces;
+    uint32_t m_emojiListGeneration = UINT32_MAX;
+
+    void updateEmojiTypefaces();
 
     std::string cleanName(std::string_view name) const;
     void parseUnicodeRange(const std::string& rangeStr,
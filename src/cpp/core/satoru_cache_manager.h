@@ -1,20 +1,49 @@
 #ifndef SATORU_CACHE_MANAGER_H
 #define SATORU_CACHE_MANAGER_H
 
+#include <cstdint>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "bridge/bridge_types.h"
 #include "core/text/text_types.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPicture.h"
 #include "utils/lru_cache.h"
 
 namespace satoru {
 
+// data URL キャッシュのコスト: 文字列のバイト数
+struct DataUrlWeight {
+    size_t operator()(uint64_t, const std::string& url) const { return url.size(); }
+};
+
+// インライン SVG ピクチャキャッシュのコスト: キーのXMLと記録したピクチャの概算サイズ
+struct SvgPictureWeight {
+    size_t operator()(const std::string& xml, const sk_sp<SkPicture>& picture) const {
+        return xml.size() + (picture ? picture->approximateBytesUsed() : 0);
+    }
+};
+
 /**
  * プロジェクト全体のLRUキャッシュを一括管理するクラス
  */
 class SatoruCacheManager {
    public:
-    SatoruCacheManager() : shapingCache(2000), measureCache(4000), lineBreakCache(2000) {}
+    SatoruCacheManager()
+        : shapingCache(2000),
+          measureCache(4000),
+          runMeasureCache(1000),
+          lineBreakCache(2000),
+          imageDataUrlCache(64, 32 * 1024 * 1024),
+          filterCache(256),
+          backdropFilterCache(256),
+          maskCache(256),
+          clipPathCache(256),
+          clipPathShapeCache(1024),
+          svgPictureCache(128, 16 * 1024 * 1024) {}
 
     /**
      * 全てのキャッシュをクリアする
@@ -22,7 +51,59 @@ class SatoruCacheManager {
     void clearAll() {
         shapingCache.clear();
         measureCache.clear();
+        runMeasureCache.clear();
         lineBreakCache.clear();
+        imageDataUrlCache.clear();
+        filterCache.clear();
+        backdropFilterCache.clear();
+        maskCache.clear();
+        clipPathCache.clear();
+        clipPathShapeCache.clear();
+        svgPictureCache.clear();
+        fontSetIds.clear();
+    }
+
+    /**
+     * フォントセット (解決済みタイプフェイスIDの列など) を整形・計測キャッシュ用のIDに変換する。
+     * 同じ列には常に同じIDを返すため、フォント追加やドキュメント再構築の後も
+     * 結果が変わらないテキストのキャッシュは有効なまま残る。
+     */
+    uint32_t fontSetId(const std::vector<uint32_t>& signature) {
+        auto it = fontSetIds.find(signature);
+        if (it != fontSetIds.end()) return it->second;
+        uint32_t id = nextFontSetId++;
+        fontSetIds.emplace(signature, id);
+        return id;
+    }
+
+    struct CacheStats {
+        const char* name;
+        LruCacheStats counters;
+        size_t size;
+        size_t capacity;
+    };
+
+    /**
+     * 各キャッシュのヒット/ミス/追い出し回数と使用量を返す
+     */
+    std::vector<CacheStats> getStats() const {
+        return {{"Shaping", shapingCache.stats(), shapingCache.size(), shapingCache.capacity()},
+                {"Measure", measureCache.stats(), measureCache.size(), measureCache.capacity()},
+                {"RunMeasure", runMeasureCache.stats(), runMeasureCache.size(),
+                 runMeasureCache.capacity()},
+                {"LineBreak", lineBreakCache.stats(), lineBreakCache.size(),
+                 lineBreakCache.capacity()},
+                {"ImageDataUrl", imageDataUrlCache.stats(), imageDataUrlCache.size(),
+                 imageDataUrlCache.capacity()},
+                {"Filter", filterCache.stats(), filterCache.size(), filterCache.capacity()},
+                {"BackdropFilter", backdropFilterCache.stats(), backdropFilterCache.size(),
+                 backdropFilterCache.capacity()},
+                {"Mask", maskCache.stats(), maskCache.size(), maskCache.capacity()},
+                {"ClipPath", clipPathCache.stats(), clipPathCache.size(), clipPathCache.capacity()},
+                {"ClipPathShape", clipPathShapeCache.stats(), clipPathShapeCache.size(),
+                 clipPathShapeCache.capacity()},
+                {"SvgPicture", svgPictureCache.stats(), svgPictureCache.size(),
+                 svgPictureCache.capacity()}};
     }
 
     // テキスト整形キャッシュ (キー: ShapingKey, 値: ShapedResult)
@@ -31,8 +112,42 @@ class SatoruCacheManager {
     // テキスト計測キャッシュ (キー: MeasureKey, 値: MeasureResult)
     LruCache<MeasureKey, MeasureResult, MeasureKeyHash> measureCache;
 
+    // まとめて計測したテキスト列の各片の幅 (キー: 各片を '\0' で連結した MeasureKey)
+    LruCache<MeasureKey, RunMeasureResult, MeasureKeyHash> runMeasureCache;
+
     // 改行位置解析キャッシュ (キー: std::string, 値: 改行位置フラグ列)
-    LruCache<std::string, std::vector<char>> lineBreakCache;
+    LruCache<std::string, std::vector<char>, StringViewHash> lineBreakCache;
+
+    // SVG出力に埋め込む画像のdata URL (キー: エンコード済みデータの内容ハッシュ、
+    // ピクセルのみの画像は最上位ビットを立てたSkImageのuniqueID)。
+    // 大きな画像が並んでもメモリが膨らまないよう、件数に加えて合計32MBまでに抑える
+    LruCache<uint64_t, std::string, std::hash<uint64_t>, DataUrlWeight> imageDataUrlCache;
+
+    // コンパイル済みの filter / backdrop-filter (キー: トークン列の文字列表現)。
+    // 同じ値を持つ要素は同じハンドルを共有し、描画毎にフィルタを組み直さない
+    LruCache<std::string, std::shared_ptr<const compiled_filter>, StringViewHash> filterCache;
+    LruCache<std::string, std::shared_ptr<const compiled_filter>, StringViewHash>
+        backdropFilterCache;
+
+    // レイヤー分割済みの mask (キー: トークン列の文字列表現)
+    LruCache<std::string, std::shared_ptr<const compiled_mask>, StringViewHash> maskCache;
+
+    // clip-path のハンドル (キー: トークン列の文字列表現)
+    LruCache<std::string, std::shared_ptr<const compiled_clip_path>, StringViewHash> clipPathCache;
+
+    // 原点に置いたボックスに対する clip-path の形状 (キー: compiled_clip_path::key と幅・高さ)
+    LruCache<std::string, SkPath, StringViewHash> clipPathShapeCache;
+
+    // インライン <svg> を記録したピクチャ (キー: currentColor 解決済みの再構築XMLと、
+    // 画像・フォントのバージョン)。同じアイコンの2回目以降はXML解析とDOM構築を行わず
+    // 再生するだけ。画像やフォントが読み込まれるとキーが変わり、古い記録は使われない。
+    // 合計16MBまで
+    LruCache<std::string, sk_sp<SkPicture>, StringViewHash, SvgPictureWeight> svgPictureCache;
+
+   private:
+    // clearAll() でキャッシュと共に表を破棄するが、IDは再利用しない
+    std::map<std::vector<uint32_t>, uint32_t> fontSetIds;
+    uint32_t nextFontSetId = 1;
 };
 
 }  // namespace satoru
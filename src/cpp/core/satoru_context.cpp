@@ -1,6 +1,7 @@
 #include "satoru_context.h"
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <mutex>
 #include <sstream>
@@ -66,7 +67,24 @@ void SatoruContext::loadImage(const char *name, const char *data_url, int width,
 
 void SatoruContext::loadImageFromData(const char *name, const uint8_t *data, size_t size,
                                       const char *original_url) {
+    if (!data || size == 0) return;
     int width = 0, height = 0;
+
+    // Raster images keep only their encoded bytes here; getImage decodes them on first draw.
+    auto encoded = SkData::MakeWithCopy(data, size);
+    if (satoru::ImageDecoder::read_raster_size(encoded, width, height)) {
+        image_info info;
+        info.data_url = original_url ? original_url : "";
+        info.width = width;
+        info.height = height;
+        info.encoded = std::move(encoded);
+        imageCache[name] = info;
+        m_imageVersion++;
+        loadedImages.insert(name);
+        needsRelayout = true;
+        return;
+    }
+
     auto image = satoru::ImageDecoder::decode(data, size, width, height, fontManager.getFontMgr());
     if (image) {
         image_info info;
@@ -76,6 +94,7 @@ void SatoruContext::loadImageFromData(const char *name, const uint8_t *data, siz
         info.skImage = image;
         imageCache[name] = info;
         m_imageVersion++;
+        loadedImages.insert(name);
         needsRelayout = true;
     }
 }
@@ -94,6 +113,7 @@ void SatoruContext::loadImageFromPixels(const char *name, int width, int height,
         info.skImage = image;
         imageCache[name] = info;
         m_imageVersion++;
+        loadedImages.insert(name);
         needsRelayout = true;
     }
 }
@@ -120,6 +140,31 @@ std::vector<sk_sp<SkTypeface>> SatoruContext::get_typefaces(const std::string &f
     return result;
 }
 
+sk_sp<SkImage> SatoruContext::getImage(const std::string &url, int width, int height) {
+    auto it = imageCache.find(url);
+    if (it == imageCache.end()) return nullptr;
+    image_info &info = it->second;
+    if (!info.encoded) return info.skImage;
+
+    // Smallest size with the image's aspect ratio that covers width x height.
+    int need_w = info.width;
+    int need_h = info.height;
+    if (width > 0 && height > 0) {
+        float scale = std::max((float)width / info.width, (float)height / info.height);
+        if (scale < 1.0f) {
+            need_w = std::max(1, (int)std::ceil(info.width * scale));
+            need_h = std::max(1, (int)std::ceil(info.height * scale));
+        }
+    }
+
+    if (info.skImage && info.skImage->width() >= need_w && info.skImage->height() >= need_h) {
+        return info.skImage;
+    }
+    auto image = satoru::ImageDecoder::decode_raster(info.encoded, need_w, need_h);
+    if (image) info.skImage = std::move(image);
+    return info.skImage;
+}
+
 bool SatoruContext::get_image_size(const std::string &url, int &w, int &h) {
     auto it = imageCache.find(url);
     if (it != imageCache.end()) {
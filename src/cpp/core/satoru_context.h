@@ -1,6 +1,8 @@
 #ifndef SATORU_CONTEXT_H
 #define SATORU_CONTEXT_H
 
+#include <litehtml/stylesheet.h>
+
 #include <cstdint>
 #include <map>
 #include <memory>
@@ -36,7 +38,9 @@ class SatoruContext {
     sk_sp<SkData> m_lastWebp;
     sk_sp<SkData> m_lastPdf;
     sk_sp<SkData> m_lastSvg;
-    std::string m_extraCss;
+    // User CSS layer. Every added block is parsed once and merged into the shared selector
+    // index, so a new @font-face block doesn't reparse the blocks added before it.
+    litehtml::shared_stylesheet m_userStylesheet{"", 1};
     std::unordered_set<std::string> m_extraCssBlocks;
     std::map<std::string, std::string> m_fontMap;
     uint64_t m_cssVersion = 0;
@@ -66,6 +70,7 @@ class SatoruContext {
         double container_split_text_ms = 0.0;
         double container_bidi_ms = 0.0;
         double text_measure_ms = 0.0;
+        double text_measure_run_ms = 0.0;
         double text_analyze_ms = 0.0;
         double text_shape_ms = 0.0;
         double text_shape_prepared_ms = 0.0;
@@ -76,6 +81,7 @@ class SatoruContext {
         int container_split_text_count = 0;
         int container_bidi_count = 0;
         int text_measure_count = 0;
+        int text_measure_run_count = 0;
         int text_analyze_count = 0;
         int text_shape_count = 0;
         int text_shape_prepared_count = 0;
@@ -89,6 +95,7 @@ class SatoruContext {
             container_split_text_ms = 0.0;
             container_bidi_ms = 0.0;
             text_measure_ms = 0.0;
+            text_measure_run_ms = 0.0;
             text_analyze_ms = 0.0;
             text_shape_ms = 0.0;
             text_shape_prepared_ms = 0.0;
@@ -99,6 +106,7 @@ class SatoruContext {
             container_split_text_count = 0;
             container_bidi_count = 0;
             text_measure_count = 0;
+            text_measure_run_count = 0;
             text_analyze_count = 0;
             text_shape_count = 0;
             text_shape_prepared_count = 0;
@@ -113,6 +121,8 @@ class SatoruContext {
     satoru::SatoruCacheManager cacheManager;
     LayoutProfile layoutProfile;
     bool needsRelayout = false;
+    // Images loaded since the last layout. needsRelayout with none listed lays out everything.
+    std::unordered_set<std::string> loadedImages;
 
     SatoruContext() {}
     SatoruContext(satoru::ILogger *logger) : m_logger(logger) {}
@@ -128,7 +138,7 @@ class SatoruContext {
     bool addCss(const std::string &css, CssChangeKind kind = CssChangeKind::Generic) {
         if (css.empty()) return false;
         if (!m_extraCssBlocks.insert(css).second) return false;
-        m_extraCss += css + "\n";
+        m_userStylesheet.append(css);
         m_cssVersion++;
         switch (kind) {
             case CssChangeKind::UserScan:
@@ -151,7 +161,8 @@ class SatoruContext {
         }
         return true;
     }
-    const std::string &getExtraCss() const { return m_extraCss; }
+    const std::string &getExtraCss() const { return m_userStylesheet.text(); }
+    litehtml::shared_stylesheet &getUserStylesheet() { return m_userStylesheet; }
     uint64_t getCssVersion() const { return m_cssVersion; }
     uint64_t getUserCssVersion() const { return m_userCssVersion; }
     uint64_t getExternalCssVersion() const { return m_externalCssVersion; }
@@ -186,8 +197,8 @@ class SatoruContext {
     }
     void markFontChanged() { m_fontVersion++; }
     void clearCss() {
-        if (m_extraCss.empty() && m_extraCssBlocks.empty()) return;
-        m_extraCss.clear();
+        if (m_userStylesheet.blocks_count() == 0 && m_extraCssBlocks.empty()) return;
+        m_userStylesheet.clear();
         m_extraCssBlocks.clear();
         m_cssVersion++;
     }
@@ -217,6 +228,7 @@ class SatoruContext {
         if (imageCache.empty()) return;
         imageCache.clear();
         m_imageVersion++;
+        loadedImages.clear();
         needsRelayout = true;
     }
 
@@ -242,6 +254,9 @@ class SatoruContext {
     std::vector<sk_sp<SkTypeface>> get_typefaces(const std::string &family, int weight,
                                                  SkFontStyle::Slant slant, bool &out_fake_bold);
     bool get_image_size(const std::string &url, int &w, int &h);
+    // Image for url, decoded large enough to cover a width x height device-pixel destination.
+    // 0 requests the natural size. Decoded pixels are kept and only re-decoded to grow.
+    sk_sp<SkImage> getImage(const std::string &url, int width = 0, int height = 0);
 
     void set_last_png(sk_sp<SkData> png) { m_lastPng = std::move(png); }
     const sk_sp<SkData> &get_last_png() const { return m_lastPng; }
@@ -0,0 +1,45 @@
+#include "glyph_coverage.h"
+
+#include "include/core/SkSpan.h"
+
+namespace satoru {
+
+bool GlyphCoverage::covers(const SkTypeface& typeface, char32_t u) {
+    uint32_t page_no = (uint32_t)u >> kPageShift;
+    if (page_no >= kPageCount) return false;
+    if (m_pageIndex.empty()) m_pageIndex.resize(kPageCount, 0);
+
+    uint16_t index = m_pageIndex[page_no];
+    if (index == 0) {
+        // One cmap query for the whole page rather than one per codepoint.
+        std::array<SkUnichar, kPageSize> unis;
+        std::array<SkGlyphID, kPageSize> glyphs;
+        SkUnichar first = (SkUnichar)(page_no << kPageShift);
+        for (uint32_t i = 0; i < kPageSize; i++) unis[i] = first + (SkUnichar)i;
+        typeface.unicharsToGlyphs(SkSpan<const SkUnichar>(unis.data(), unis.size()),
+                                  SkSpan<SkGlyphID>(glyphs.data(), glyphs.size()));
+
+        Page page{};
+        for (uint32_t i = 0; i < kPageSize; i++) {
+            if (glyphs[i] != 0) page[i / 64] |= uint64_t(1) << (i % 64);
+        }
+        m_pages.push_back(page);
+        index = (uint16_t)m_pages.size();
+        m_pageIndex[page_no] = index;
+    }
+
+    uint32_t bit = (uint32_t)u & (kPageSize - 1);
+    return (m_pages[index - 1][bit / 64] >> (bit % 64)) & 1;
+}
+
+bool GlyphCoverageIndex::covers(const SkTypeface* typeface, char32_t u) {
+    if (!typeface) return false;
+    SkTypefaceID id = typeface->uniqueID();
+    if (!m_last || id != m_lastId) {
+        m_last = &m_byTypeface[id];
+        m_lastId = id;
+    }
+    return m_last->covers(*typeface, u);
+}
+
+}  // namespace satoru
@@ -0,0 +1,58 @@
+#ifndef SATORU_GLYPH_COVERAGE_H
+#define SATORU_GLYPH_COVERAGE_H
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkTypeface.h"
+
+namespace satoru {
+
+/**
+ * The codepoints a typeface has a glyph for, as a paged bitset.
+ * A page covers 256 codepoints and is read from the typeface's cmap the first time one of them
+ * is queried; after that a lookup is a bit test.
+ */
+class GlyphCoverage {
+   public:
+    // typeface must be the one this coverage was first queried with.
+    bool covers(const SkTypeface& typeface, char32_t u);
+
+   private:
+    static constexpr int kPageShift = 8;
+    static constexpr uint32_t kPageSize = 1u << kPageShift;
+    static constexpr uint32_t kPageCount = 0x110000 >> kPageShift;
+    using Page = std::array<uint64_t, kPageSize / 64>;
+
+    // Index into m_pages + 1 for each page read so far, 0 for pages not read yet.
+    std::vector<uint16_t> m_pageIndex;
+    std::vector<Page> m_pages;
+};
+
+/**
+ * GlyphCoverage of every typeface font fallback has asked about, keyed by SkTypefaceID.
+ * Typeface ids are never reused, so entries of released typefaces are merely never hit again.
+ */
+class GlyphCoverageIndex {
+   public:
+    bool covers(const SkTypeface* typeface, char32_t u);
+    bool covers(const sk_sp<SkTypeface>& typeface, char32_t u) { return covers(typeface.get(), u); }
+    void clear() {
+        m_byTypeface.clear();
+        m_lastId = 0;
+        m_last = nullptr;
+    }
+
+   private:
+    std::unordered_map<SkTypefaceID, GlyphCoverage> m_byTypeface;
+    // Runs of text mostly query one typeface; skip the hash lookup for it.
+    SkTypefaceID m_lastId = 0;
+    GlyphCoverage* m_last = nullptr;
+};
+
+}  // namespace satoru
+
+#endif
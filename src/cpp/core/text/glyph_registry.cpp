@@ -0,0 +1,54 @@
+#include "glyph_registry.h"
+
+#include <cstring>
+
+namespace satoru {
+
+namespace {
+uint64_t path_fingerprint(const SkPath& path) {
+    const SkRect& b = path.getBounds();
+    float parts[4] = {b.fLeft, b.fTop, b.fRight, b.fBottom};
+    uint64_t h = (uint64_t)path.countPoints() << 32 | (uint32_t)path.countVerbs();
+    for (float f : parts) {
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        h ^= bits + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+}  // namespace
+
+int GlyphRegistry::add(const SkFont& font, SkGlyphID glyphId) {
+    auto typeface = font.getTypeface();
+    GlyphKey key;
+    key.typeface_id = typeface ? typeface->uniqueID() : 0;
+    key.glyph_id = glyphId;
+    key.size = font.getSize();
+    key.scale_x = font.getScaleX();
+    key.skew_x = font.getSkewX();
+    key.embolden = font.isEmbolden();
+    auto it = m_byGlyph.find(key);
+    if (it != m_byGlyph.end()) return it->second;
+
+    auto pathOpt = font.getPath(glyphId);
+    int index = 0;
+    if (pathOpt.has_value() && !pathOpt.value().isEmpty()) {
+        index = add(pathOpt.value());
+    }
+    m_byGlyph.emplace(key, index);
+    return index;
+}
+
+int GlyphRegistry::add(const SkPath& path) {
+    uint64_t fingerprint = path_fingerprint(path);
+    auto range = m_byShape.equal_range(fingerprint);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (m_paths[it->second - 1] == path) return it->second;
+    }
+    m_paths.push_back(path);
+    int index = (int)m_paths.size();
+    m_byShape.emplace(fingerprint, index);
+    return index;
+}
+
+}  // namespace satoru
@@ -0,0 +1,72 @@
+#ifndef SATORU_GLYPH_REGISTRY_H
+#define SATORU_GLYPH_REGISTRY_H
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "include/core/SkFont.h"
+#include "include/core/SkPath.h"
+
+namespace satoru {
+
+// Everything that shapes a glyph outline returned by SkFont::getPath.
+struct GlyphKey {
+    uint32_t typeface_id;
+    SkGlyphID glyph_id;
+    float size;
+    float scale_x;
+    float skew_x;
+    bool embolden;
+
+    bool operator==(const GlyphKey& other) const {
+        return typeface_id == other.typeface_id && glyph_id == other.glyph_id &&
+               size == other.size && scale_x == other.scale_x && skew_x == other.skew_x &&
+               embolden == other.embolden;
+    }
+};
+
+struct GlyphKeyHash {
+    std::size_t operator()(const GlyphKey& k) const {
+        std::size_t h = std::hash<uint32_t>{}(k.typeface_id);
+        h ^= std::hash<uint32_t>{}(k.glyph_id) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= std::hash<float>{}(k.size) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= std::hash<float>{}(k.scale_x) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= std::hash<float>{}(k.skew_x) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= std::hash<bool>{}(k.embolden) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+/**
+ * Unique glyph outlines emitted as SVG <defs>, referenced by 1-based index.
+ * Glyphs are looked up by GlyphKey, so repeated glyphs skip both getPath and any path
+ * comparison. New outlines are also matched by shape, comparing paths only when their
+ * fingerprints collide, so identical outlines from different fonts still share one def.
+ */
+class GlyphRegistry {
+   public:
+    // Returns the index of the glyph outline, or 0 if the glyph has no outline.
+    int add(const SkFont& font, SkGlyphID glyphId);
+    int add(const SkPath& path);
+
+    const SkPath& path(int index) const { return m_paths[index - 1]; }
+    const std::vector<SkPath>& paths() const { return m_paths; }
+    size_t size() const { return m_paths.size(); }
+
+    void clear() {
+        m_paths.clear();
+        m_byGlyph.clear();
+        m_byShape.clear();
+    }
+
+   private:
+    std::vector<SkPath> m_paths;
+    std::unordered_map<GlyphKey, int, GlyphKeyHash> m_byGlyph;
+    std::unordered_multimap<uint64_t, int> m_byShape;
+};
+
+}  // namespace satoru
+
+#endif  // SATORU_GLYPH_REGISTRY_H
@@ -9,11 +9,10 @@ namespace satoru {
 
 void TaggingContext::drawGlyph(const SkFont& font, SkGlyphID glyphId, float phys_x, float phys_y,
                                float rotation, const SkPaint& basePaint) {
-    auto pathOpt = font.getPath(glyphId);
+    int glyphIdx = m_usedGlyphs.add(font, glyphId);
 
-    if (pathOpt.has_value() && !pathOpt.value().isEmpty()) {
-        const SkPath& path = pathOpt.value();
-        int glyphIdx = getOrAddGlyphPath(path);
+    if (glyphIdx > 0) {
+        const SkPath& path = m_usedGlyphs.path(glyphIdx);
 
         glyph_draw_info drawInfo;
         drawInfo.glyph_index = glyphIdx;
@@ -58,14 +57,4 @@ void TaggingContext::drawGlyph(const SkFont& font, SkGlyphID glyphId, float phys
     }
 }
 
-int TaggingContext::getOrAddGlyphPath(const SkPath& path) {
-    for (size_t gi = 0; gi < m_usedGlyphs.size(); ++gi) {
-        if (m_usedGlyphs[gi] == path) {
-            return (int)gi + 1;
-        }
-    }
-    m_usedGlyphs.push_back(path);
-    return (int)m_usedGlyphs.size();
-}
-
 }  // namespace satoru
@@ -6,6 +6,7 @@
 
 #include "bridge/bridge_types.h"
 #include "bridge/magic_tags.h"
+#include "glyph_registry.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkPaint.h"
@@ -19,7 +20,7 @@ namespace satoru {
  */
 class TaggingContext {
    public:
-    TaggingContext(SkCanvas* canvas, std::vector<SkPath>& usedGlyphs,
+    TaggingContext(SkCanvas* canvas, GlyphRegistry& usedGlyphs,
                    std::vector<glyph_draw_info>& usedGlyphDraws, int styleTag, int styleIndex)
         : m_canvas(canvas),
           m_usedGlyphs(usedGlyphs),
@@ -35,12 +36,10 @@ class TaggingContext {
 
    private:
     SkCanvas* m_canvas;
-    std::vector<SkPath>& m_usedGlyphs;
+    GlyphRegistry& m_usedGlyphs;
     std::vector<glyph_draw_info>& m_usedGlyphDraws;
     int m_styleTag;
     int m_styleIndex;
-
-    int getOrAddGlyphPath(const SkPath& path);
 };
 
 }  // namespace satoru
@@ -16,23 +16,22 @@
 namespace satoru {
 
 namespace {
-void replayUsedCodepoints(const MeasureResult& result, std::set<char32_t>* usedCodepoints) {
+void replayUsedCodepoints(const std::vector<char32_t>& codepoints,
+                          std::set<char32_t>* usedCodepoints) {
     if (!usedCodepoints) return;
-    for (char32_t codepoint : result.usedCodepoints) {
+    for (char32_t codepoint : codepoints) {
         usedCodepoints->insert(codepoint);
     }
 }
 
-void captureUsedCodepoints(MeasureResult& result, const TextAnalysis& analysis) {
-    result.usedCodepoints.clear();
-    result.usedCodepoints.reserve(analysis.chars.size());
+void captureUsedCodepoints(std::vector<char32_t>& codepoints, const TextAnalysis& analysis) {
+    codepoints.clear();
+    codepoints.reserve(analysis.chars.size());
     for (const auto& ca : analysis.chars) {
-        result.usedCodepoints.push_back(ca.codepoint);
+        codepoints.push_back(ca.codepoint);
     }
-    std::sort(result.usedCodepoints.begin(), result.usedCodepoints.end());
-    result.usedCodepoints.erase(
-        std::unique(result.usedCodepoints.begin(), result.usedCodepoints.end()),
-        result.usedCodepoints.end());
+    std::sort(codepoints.begin(), codepoints.end());
+    codepoints.erase(std::unique(codepoints.begin(), codepoints.end()), codepoints.end());
 }
 
 bool isCjkFastMeasureCodepoint(char32_t u) {
@@ -293,6 +292,41 @@ class OffsetWidthRunHandler : public SkShaper::RunHandler {
     mutable bool fLookupsPrepared = false;
 };
 
+// Shapes analyzed text as a single line, one font run per run of chars with the same font
+// and orientation.
+void shapeAnalysis(SkShaper* shaper, const char* text, size_t len, const TextAnalysis& analysis,
+                   SkShaper::RunHandler* handler) {
+    std::vector<CharFont> charFonts;
+    charFonts.reserve(analysis.chars.size());
+    for (const auto& ca : analysis.chars) {
+        if (!charFonts.empty() && charFonts.back().font == ca.font &&
+            charFonts.back().is_vertical_upright == ca.is_vertical_upright &&
+            charFonts.back().is_vertical_punctuation == ca.is_vertical_punctuation &&
+            charFonts.back().is_substitution_failed == ca.is_substitution_failed) {
+            charFonts.back().len += ca.len;
+        } else {
+            charFonts.push_back({ca.len, ca.font, ca.is_vertical_upright,
+                                 ca.is_vertical_punctuation, ca.is_substitution_failed});
+        }
+    }
+
+    SatoruFontRunIterator fontRuns(charFonts);
+    uint8_t itemLevel = analysis.bidi_level;
+    std::unique_ptr<SkShaper::BiDiRunIterator> bidi =
+        SkShaper::MakeBiDiRunIterator(text, len, itemLevel);
+    if (!bidi) bidi = std::make_unique<SkShaper::TrivialBiDiRunIterator>(itemLevel, len);
+    std::unique_ptr<SkShaper::ScriptRunIterator> script =
+        SkShaper::MakeSkUnicodeHbScriptRunIterator(text, len);
+    if (!script)
+        script = std::make_unique<SkShaper::TrivialScriptRunIterator>(
+            SkSetFourByteTag('Z', 'y', 'y', 'y'), len);
+    std::unique_ptr<SkShaper::LanguageRunIterator> lang =
+        SkShaper::MakeStdLanguageRunIterator(text, len);
+    if (!lang) lang = std::make_unique<SkShaper::TrivialLanguageRunIterator>("en", len);
+
+    shaper->shape(text, len, fontRuns, *bidi, *script, *lang, nullptr, 0, 1000000, handler);
+}
+
 }  // namespace
 
 MeasureResult TextLayout::measureText(SatoruContext* ctx, const char* text, font_info* fi,
@@ -303,12 +337,13 @@ MeasureResult TextLayout::measureText(SatoruContext* ctx, const char* text, font
     LayoutProfileTimer profile_timer(ctx, &SatoruContext::LayoutProfile::text_measure_ms,
                                      &SatoruContext::LayoutProfile::text_measure_count);
 
-    MeasureKey key;
+    MeasureKeyView key;
+    size_t keyHash = 0;
     bool canCache = true;
     if (canCache) {
         if (ctx->layoutProfile.enabled) ctx->layoutProfile.text_measure_cacheable_count++;
         key.text = text;
-        key.font_family = fi->desc.family;
+        key.fontSetId = fi->font_set_id;
         key.font_size = (float)fi->desc.size;
         key.font_weight = fi->desc.weight;
         key.italic = (fi->desc.style == litehtml::font_style_italic);
@@ -318,13 +353,13 @@ MeasureResult TextLayout::measureText(SatoruContext* ctx, const char* text, font
         key.textCombineUpright = fi->desc.text_combine_upright_;
         key.letterSpacing = (float)fi->desc.letter_spacing;
         key.wordSpacing = (float)fi->desc.word_spacing;
-        key.fontVersion = ctx->getFontVersion();
 
-        if (MeasureResult* cached = ctx->cacheManager.measureCache.get(key)) {
+        keyHash = ctx->cacheManager.measureCache.hash(key);
+        if (MeasureResult* cached = ctx->cacheManager.measureCache.get(key, keyHash)) {
             if (ctx->layoutProfile.enabled) ctx->layoutProfile.text_measure_cache_hit_count++;
             MeasureResult res = *cached;
             res.last_safe_pos = text + res.length;
-            replayUsedCodepoints(res, usedCodepoints);
+            replayUsedCodepoints(res.usedCodepoints, usedCodepoints);
             return res;
         }
     }
@@ -345,7 +380,7 @@ MeasureResult TextLayout::measureText(SatoruContext* ctx, const char* text, font
         result.usedCodepoints.clear();
 
         if (canCache) {
-            ctx->cacheManager.measureCache.put(key, result);
+            ctx->cacheManager.measureCache.put(key.owned(), result, keyHash);
         }
         return result;
     }
@@ -364,7 +399,7 @@ MeasureResult TextLayout::measureText(SatoruContext* ctx, const char* text, font
             result.last_safe_pos = text + total_len;
             result.usedCodepoints = {codepoint};
             if (canCache) {
-                ctx->cacheManager.measureCache.put(key, result);
+                ctx->cacheManager.measureCache.put(key.owned(), result, keyHash);
             }
             return result;
         }
@@ -382,7 +417,7 @@ MeasureResult TextLayout::measureText(SatoruContext* ctx, const char* text, font
             result.last_safe_pos = text + total_len;
             result.usedCodepoints = {ca.codepoint};
             if (canCache) {
-                ctx->cacheManager.measureCache.put(key, result);
+                ctx->cacheManager.measureCache.put(key.owned(), result, keyHash);
             }
             return result;
         }
@@ -395,37 +430,9 @@ MeasureResult TextLayout::measureText(SatoruContext* ctx, const char* text, font
     SkShaper* shaper = ctx->getShaper();
     if (!shaper) return result;
 
-    std::vector<CharFont> charFonts;
-    for (const auto& ca : analysis.chars) {
-        if (!charFonts.empty() && charFonts.back().font == ca.font &&
-            charFonts.back().is_vertical_upright == ca.is_vertical_upright &&
-            charFonts.back().is_vertical_punctuation == ca.is_vertical_punctuation &&
-            charFonts.back().is_substitution_failed == ca.is_substitution_failed) {
-            charFonts.back().len += ca.len;
-        } else {
-            charFonts.push_back({ca.len, ca.font, ca.is_vertical_upright,
-                                 ca.is_vertical_punctuation, ca.is_substitution_failed});
-        }
-    }
-
     OffsetWidthRunHandler handler(mode, (float)fi->desc.letter_spacing,
                                   (float)fi->desc.word_spacing, analysis);
-    SatoruFontRunIterator fontRuns(charFonts);
-    uint8_t itemLevel = analysis.bidi_level;
-    std::unique_ptr<SkShaper::BiDiRunIterator> bidi =
-        SkShaper::MakeBiDiRunIterator(shape_text, shape_len, itemLevel);
-    if (!bidi) bidi = std::make_unique<SkShaper::TrivialBiDiRunIterator>(itemLevel, shape_len);
-    std::unique_ptr<SkShaper::ScriptRunIterator> script =
-        SkShaper::MakeSkUnicodeHbScriptRunIterator(shape_text, shape_len);
-    if (!script)
-        script = std::make_unique<SkShaper::TrivialScriptRunIterator>(
-            SkSetFourByteTag('Z', 'y', 'y', 'y'), shape_len);
-    std::unique_ptr<SkShaper::LanguageRunIterator> lang =
-        SkShaper::MakeStdLanguageRunIterator(shape_text, shape_len);
-    if (!lang) lang = std::make_unique<SkShaper::TrivialLanguageRunIterator>("en", shape_len);
-
-    shaper->shape(shape_text, shape_len, fontRuns, *bidi, *script, *lang, nullptr, 0, 1000000,
-                  &handler);
+    shapeAnalysis(shaper, shape_text, shape_len, analysis, &handler);
 
     double measuredWidth = handler.width();
 
@@ -463,15 +470,105 @@ MeasureResult TextLayout::measureText(SatoruContext* ctx, const char* text, font
     }
 
     result.last_safe_pos = text + result.length;
-    captureUsedCodepoints(result, analysis);
+    captureUsedCodepoints(result.usedCodepoints, analysis);
 
     if (canCache) {
-        ctx->cacheManager.measureCache.put(key, result);
+        ctx->cacheManager.measureCache.put(key.owned(), result, keyHash);
     }
 
     return result;
 }
 
+void TextLayout::measureTextRun(SatoruContext* ctx, const std::vector<const char*>& pieces,
+                                font_info* fi, litehtml::writing_mode mode,
+                                std::vector<double>& widths,
+                                std::set<char32_t>* usedCodepoints) {
+    widths.assign(pieces.size(), 0.0);
+    if (pieces.empty() || !fi || fi->fonts.empty() || !ctx) return;
+
+    // Vertical text is mostly upright characters measured one by one, which measureText has
+    // fast paths for.
+    if (pieces.size() == 1 || mode != litehtml::writing_mode_horizontal_tb) {
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            widths[i] = measureText(ctx, pieces[i], fi, mode, -1.0, usedCodepoints).width;
+        }
+        return;
+    }
+    LayoutProfileTimer profile_timer(ctx, &SatoruContext::LayoutProfile::text_measure_run_ms,
+                                     &SatoruContext::LayoutProfile::text_measure_run_count);
+
+    std::string text;
+    std::vector<size_t> ends;
+    ends.reserve(pieces.size());
+    for (const char* piece : pieces) {
+        if (piece) text.append(piece);
+        ends.push_back(text.size());
+    }
+    if (text.empty()) return;
+
+    // Text never contains '\0', so joining the pieces with it keeps their boundaries in the key.
+    std::string keyText;
+    keyText.reserve(text.size() + pieces.size());
+    for (size_t i = 0, start = 0; i < ends.size(); start = ends[i++]) {
+        if (i > 0) keyText.push_back('\0');
+        keyText.append(text, start, ends[i] - start);
+    }
+
+    MeasureKeyView key;
+    key.text = keyText;
+    key.fontSetId = fi->font_set_id;
+    key.font_size = (float)fi->desc.size;
+    key.font_weight = fi->desc.weight;
+    key.italic = (fi->desc.style == litehtml::font_style_italic);
+    key.maxWidth = -1.0;
+    key.mode = mode;
+    key.orientation = fi->desc.orientation;
+    key.textCombineUpright = fi->desc.text_combine_upright_;
+    key.letterSpacing = (float)fi->desc.letter_spacing;
+    key.wordSpacing = (float)fi->desc.word_spacing;
+
+    size_t keyHash = ctx->cacheManager.runMeasureCache.hash(key);
+    if (RunMeasureResult* cached = ctx->cacheManager.runMeasureCache.get(key, keyHash)) {
+        widths = cached->widths;
+        replayUsedCodepoints(cached->usedCodepoints, usedCodepoints);
+        return;
+    }
+
+    SkShaper* shaper = ctx->getShaper();
+    if (!shaper) return;
+
+    TextAnalysis analysis = analyzeText(ctx, text.c_str(), text.size(), fi, mode, usedCodepoints,
+                                        false);
+    OffsetWidthRunHandler handler(mode, (float)fi->desc.letter_spacing,
+                                  (float)fi->desc.word_spacing, analysis);
+    shapeAnalysis(shaper, analysis.substituted_text.c_str(), analysis.substituted_text.size(),
+                  analysis, &handler);
+
+    // analyzeText emits one entry per decoded codepoint, so the piece boundaries can be carried
+    // over to offsets in the (possibly substituted) shaped text by counting codepoints.
+    UnicodeService& unicode = ctx->getUnicodeService();
+    const char* p = text.c_str();
+    size_t char_index = 0;
+    double start_width = 0;
+    for (size_t i = 0; i < ends.size(); ++i) {
+        const char* piece_end = text.c_str() + ends[i];
+        while (p < piece_end) {
+            unicode.decodeUtf8(&p);
+            char_index++;
+        }
+        size_t offset = char_index < analysis.chars.size() ? analysis.chars[char_index].offset
+                                                           : analysis.substituted_text.size();
+        double end_width = handler.widthAtOffset(offset);
+        widths[i] = end_width - start_width;
+        start_width = end_width;
+    }
+
+    RunMeasureResult result;
+    result.widths = widths;
+    captureUsedCodepoints(result.usedCodepoints, analysis);
+    ctx->cacheManager.runMeasureCache.put(key.owned(), std::move(result), keyHash);
+}
+
 TextAnalysis TextLayout::analyzeText(SatoruContext* ctx, const char* text, size_t len,
                                      font_info* fi, litehtml::writing_mode mode,
                                      std::set<char32_t>* usedCodepoints, bool computeLineBreaks) {
@@ -602,9 +699,9 @@ ShapedResult TextLayout::shapeText(SatoruContext* ctx, const char* text, size_t
     LayoutProfileTimer profile_timer(ctx, &SatoruContext::LayoutProfile::text_shape_ms,
                                      &SatoruContext::LayoutProfile::text_shape_count);
 
-    ShapingKey key;
-    key.text.assign(text, len);
-    key.font_family = fi->desc.family;
+    ShapingKeyView key;
+    key.text = std::string_view(text, len);
+    key.fontSetId = fi->font_set_id;
     key.font_size = (float)fi->desc.size;
     key.font_weight = fi->desc.weight;
     key.italic = (fi->desc.style == litehtml::font_style_italic);
@@ -615,15 +712,19 @@ ShapedResult TextLayout::shapeText(SatoruContext* ctx, const char* text, size_t
     key.letterSpacing = (float)fi->desc.letter_spacing;
     key.wordSpacing = (float)fi->desc.word_spacing;
 
-    if (ShapedResult* cached = ctx->cacheManager.shapingCache.get(key)) {
+    size_t keyHash = ctx->cacheManager.shapingCache.hash(key);
+    if (ShapedResult* cached = ctx->cacheManager.shapingCache.get(key, keyHash)) {
         if (usedCodepoints) {
             analyzeText(ctx, text, len, fi, mode, usedCodepoints, false);
         }
         return *cached;
     }
 
+    // Stored under the caller's text rather than the substituted one, so the probe above hits
+    // next time and a miss is counted once.
     TextAnalysis analysis = analyzeText(ctx, text, len, fi, mode, usedCodepoints, false);
-    return shapeAnalyzedText(ctx, text, len, fi, mode, analysis);
+    return shapeAndCache(ctx, key, keyHash, analysis.substituted_text.c_str(),
+                         analysis.substituted_text.size(), fi, mode, analysis);
 }
 
 ShapedResult TextLayout::shapeAnalyzedText(SatoruContext* ctx, const char* text, size_t len,
@@ -642,9 +743,9 @@ ShapedResult TextLayout::shapePreparedText(SatoruContext* ctx, const char* cache
     LayoutProfileTimer profile_timer(ctx, &SatoruContext::LayoutProfile::text_shape_prepared_ms,
                                      &SatoruContext::LayoutProfile::text_shape_prepared_count);
 
-    ShapingKey key;
-    key.text.assign(cacheText, cacheLen);
-    key.font_family = fi->desc.family;
+    ShapingKeyView key;
+    key.text = std::string_view(cacheText, cacheLen);
+    key.fontSetId = fi->font_set_id;
     key.font_size = (float)fi->desc.size;
     key.font_weight = fi->desc.weight;
     key.italic = (fi->desc.style == litehtml::font_style_italic);
@@ -655,24 +756,18 @@ ShapedResult TextLayout::shapePreparedText(SatoruContext* ctx, const char* cache
     key.letterSpacing = (float)fi->desc.letter_spacing;
     key.wordSpacing = (float)fi->desc.word_spacing;
 
-    if (ShapedResult* cached = ctx->cacheManager.shapingCache.get(key)) {
+    size_t keyHash = ctx->cacheManager.shapingCache.hash(key);
+    if (ShapedResult* cached = ctx->cacheManager.shapingCache.get(key, keyHash)) {
         return *cached;
     }
 
-    std::vector<CharFont> charFonts;
-    charFonts.reserve(analysis.chars.size());
-    for (const auto& ca : analysis.chars) {
-        if (!charFonts.empty() && charFonts.back().font == ca.font &&
-            charFonts.back().is_vertical_upright == ca.is_vertical_upright &&
-            charFonts.back().is_vertical_punctuation == ca.is_vertical_punctuation &&
-            charFonts.back().is_substitution_failed == ca.is_substitution_failed) {
-            charFonts.back().len += ca.len;
-        } else {
-            charFonts.push_back({ca.len, ca.font, ca.is_vertical_upright,
-                                 ca.is_vertical_punctuation, ca.is_substitution_failed});
-        }
-    }
+    return shapeAndCache(ctx, key, keyHash, shapeText, shapeLen, fi, mode, analysis);
+}
 
+ShapedResult TextLayout::shapeAndCache(SatoruContext* ctx, const ShapingKeyView& key,
+                                       size_t keyHash, const char* shapeText, size_t shapeLen,
+                                       font_info* fi, litehtml::writing_mode mode,
+                                       const TextAnalysis& analysis) {
     ShapedResult result = {0.0, nullptr, false};
     SkShaper* shaper = ctx->getShaper();
     if (!shaper) return result;
@@ -680,23 +775,7 @@ ShapedResult TextLayout::shapePreparedText(SatoruContext* ctx, const char* cache
     SkTextBlobBuilderRunHandler blobHandler(shapeText, {0, 0});
     WidthProxyRunHandler handler(&blobHandler, result, mode, (float)fi->desc.letter_spacing,
                                  (float)fi->desc.word_spacing, analysis);
-
-    SatoruFontRunIterator fontRuns(charFonts);
-    uint8_t itemLevel = analysis.bidi_level;
-    std::unique_ptr<SkShaper::BiDiRunIterator> bidi =
-        SkShaper::MakeBiDiRunIterator(shapeText, shapeLen, itemLevel);
-    if (!bidi) bidi = std::make_unique<SkShaper::TrivialBiDiRunIterator>(itemLevel, shapeLen);
-    std::unique_ptr<SkShaper::ScriptRunIterator> script =
-        SkShaper::MakeSkUnicodeHbScriptRunIterator(shapeText, shapeLen);
-    if (!script)
-        script = std::make_unique<SkShaper::TrivialScriptRunIterator>(
-            SkSetFourByteTag('Z', 'y', 'y', 'y'), shapeLen);
-    std::unique_ptr<SkShaper::LanguageRunIterator> lang =
-        SkShaper::MakeStdLanguageRunIterator(shapeText, shapeLen);
-    if (!lang) lang = std::make_unique<SkShaper::TrivialLanguageRunIterator>("en", shapeLen);
-
-    shaper->shape(shapeText, shapeLen, fontRuns, *bidi, *script, *lang, nullptr, 0, 1000000,
-                  &handler);
+    shapeAnalysis(shaper, shapeText, shapeLen, analysis, &handler);
 
     result.blob = blobHandler.makeBlob();
     result.is_emoji = false;
@@ -707,7 +786,7 @@ ShapedResult TextLayout::shapePreparedText(SatoruContext* ctx, const char* cache
         }
     }
 
-    ctx->cacheManager.shapingCache.put(key, result);
+    ctx->cacheManager.shapingCache.put(key.owned(), result, keyHash);
     return result;
 }
 
@@ -25,6 +25,14 @@ class TextLayout {
         litehtml::writing_mode mode = litehtml::writing_mode_horizontal_tb, double maxWidth = -1.0,
         std::set<char32_t>* usedCodepoints = nullptr);
 
+    // Widths of consecutive pieces of one run of text (words and spaces) in one font. The run
+    // is shaped once and its advances are split at the piece boundaries, so kerning and
+    // ligatures across the boundaries are taken into account.
+    static void measureTextRun(SatoruContext* ctx, const std::vector<const char*>& pieces,
+                               font_info* fi, litehtml::writing_mode mode,
+                               std::vector<double>& widths,
+                               std::set<char32_t>* usedCodepoints = nullptr);
+
     static std::string ellipsizeText(SatoruContext* ctx, const char* text, font_info* fi,
                                      litehtml::writing_mode mode, double maxWidth,
                                      std::set<char32_t>* usedCodepoints = nullptr);
@@ -49,6 +57,14 @@ class TextLayout {
 
     static double balanceText(SatoruContext* ctx, const char* text, font_info* fi,
                               litehtml::writing_mode mode, double maxWidth);
+
+   private:
+    // Shapes shapeText and stores the result under key. Callers have just missed on key, so
+    // the cache is not probed again.
+    static ShapedResult shapeAndCache(SatoruContext* ctx, const ShapingKeyView& key,
+                                      size_t keyHash, const char* shapeText, size_t shapeLen,
+                                      font_info* fi, litehtml::writing_mode mode,
+                                      const TextAnalysis& analysis);
 };
 
 }  // namespace satoru
@@ -136,7 +136,7 @@ void TextRenderer::drawText(SatoruContext* ctx, SkCanvas* canvas, const char* te
                             litehtml::writing_mode mode, bool tagging, float currentOpacity,
                             std::vector<text_shadow_info>& usedTextShadows,
                             std::vector<text_draw_info>& usedTextDraws,
-                            std::vector<SkPath>& usedGlyphs,
+                            GlyphRegistry& usedGlyphs,
                             std::vector<glyph_draw_info>& usedGlyphDraws,
                             std::set<char32_t>* usedCodepoints, TextBatcher* batcher) {
     if (!canvas || !fi || fi->fonts.empty()) return;
@@ -234,7 +234,7 @@ double TextRenderer::drawTextInternal(SatoruContext* ctx, SkCanvas* canvas, cons
                                       size_t strLen, font_info* fi, const litehtml::position& pos,
                                       litehtml::writing_mode mode, const SkPaint& paint,
                                       bool tagging, std::vector<text_draw_info>& usedTextDraws,
-                                      std::vector<SkPath>& usedGlyphs,
+                                      GlyphRegistry& usedGlyphs,
                                       std::vector<glyph_draw_info>& usedGlyphDraws,
                                       std::set<char32_t>* usedCodepoints, TextBatcher* batcher,
                                       int styleTag, int styleIndex) {
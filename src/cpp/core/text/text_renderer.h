@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "bridge/bridge_types.h"
+#include "core/text/glyph_registry.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkPath.h"
 #include "include/core/SkTextBlob.h"
@@ -80,7 +81,7 @@ class TextRenderer {
                          litehtml::writing_mode mode, bool tagging, float currentOpacity,
                          std::vector<text_shadow_info>& usedTextShadows,
                          std::vector<text_draw_info>& usedTextDraws,
-                         std::vector<SkPath>& usedGlyphs,
+                         GlyphRegistry& usedGlyphs,
                          std::vector<glyph_draw_info>& usedGlyphDraws,
                          std::set<char32_t>* usedCodepoints, TextBatcher* batcher = nullptr);
 
@@ -89,7 +90,7 @@ class TextRenderer {
     static double drawTextInternal(
         SatoruContext* ctx, SkCanvas* canvas, const char* str, size_t strLen, font_info* fi,
         const litehtml::position& pos, litehtml::writing_mode mode, const SkPaint& paint,
-        bool tagging, std::vector<text_draw_info>& usedTextDraws, std::vector<SkPath>& usedGlyphs,
+        bool tagging, std::vector<text_draw_info>& usedTextDraws, GlyphRegistry& usedGlyphs,
         std::vector<glyph_draw_info>& usedGlyphDraws, std::set<char32_t>* usedCodepoints,
         TextBatcher* batcher = nullptr, int styleTag = -1, int styleIndex = -1);
 };
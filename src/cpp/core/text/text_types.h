@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "include/core/SkFont.h"
@@ -29,6 +30,12 @@ struct MeasureResult {
     std::vector<char32_t> usedCodepoints;
 };
 
+// Widths of the pieces of a run of text measured together (TextLayout::measureTextRun)
+struct RunMeasureResult {
+    std::vector<double> widths;
+    std::vector<char32_t> usedCodepoints;
+};
+
 struct TextCharAnalysis {
     char32_t codepoint;
     size_t offset;
@@ -77,9 +84,14 @@ class SatoruFontRunIterator : public SkShaper::FontRunIterator {
     size_t m_currentIndex;
 };
 
-struct MeasureKey {
-    std::string text;
-    std::string font_family;
+// Text fields are std::string in cached keys and std::string_view when probing, so a lookup
+// does not have to copy the text. Fonts are identified by font_info::font_set_id (the resolved
+// typeface set) rather than by family name or a global font version, so cached results stay
+// valid across documents and across font loads that do not change the set.
+template <typename String>
+struct BasicMeasureKey {
+    String text;
+    uint32_t fontSetId;
     float font_size;
     int font_weight;
     bool italic;
@@ -89,22 +101,30 @@ struct MeasureKey {
     litehtml::text_combine_upright textCombineUpright;
     float letterSpacing;
     float wordSpacing;
-    uint64_t fontVersion;
 
-    bool operator==(const MeasureKey& other) const {
+    template <typename Other>
+    bool operator==(const BasicMeasureKey<Other>& other) const {
         return font_size == other.font_size && font_weight == other.font_weight &&
                italic == other.italic && maxWidth == other.maxWidth &&
-               font_family == other.font_family && text == other.text && mode == other.mode &&
+               fontSetId == other.fontSetId && text == other.text && mode == other.mode &&
                orientation == other.orientation && textCombineUpright == other.textCombineUpright &&
-               letterSpacing == other.letterSpacing && wordSpacing == other.wordSpacing &&
-               fontVersion == other.fontVersion;
+               letterSpacing == other.letterSpacing && wordSpacing == other.wordSpacing;
+    }
+
+    BasicMeasureKey<std::string> owned() const {
+        return {std::string(text), fontSetId, font_size, font_weight, italic, maxWidth,
+                mode, orientation, textCombineUpright, letterSpacing, wordSpacing};
     }
 };
 
+using MeasureKey = BasicMeasureKey<std::string>;
+using MeasureKeyView = BasicMeasureKey<std::string_view>;
+
 struct MeasureKeyHash {
-    std::size_t operator()(const MeasureKey& k) const {
-        std::size_t h = std::hash<std::string>{}(k.text);
-        h ^= std::hash<std::string>{}(k.font_family) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    template <typename String>
+    std::size_t operator()(const BasicMeasureKey<String>& k) const {
+        std::size_t h = std::hash<std::string_view>{}(k.text);
+        h ^= std::hash<uint32_t>{}(k.fontSetId) + 0x9e3779b9 + (h << 6) + (h >> 2);
         h ^= std::hash<float>{}(k.font_size) + 0x9e3779b9 + (h << 6) + (h >> 2);
         h ^= std::hash<int>{}(k.font_weight) + 0x9e3779b9 + (h << 6) + (h >> 2);
         h ^= std::hash<bool>{}(k.italic) + 0x9e3779b9 + (h << 6) + (h >> 2);
@@ -114,7 +134,6 @@ struct MeasureKeyHash {
         h ^= std::hash<int>{}(k.textCombineUpright) + 0x9e3779b9 + (h << 6) + (h >> 2);
         h ^= std::hash<float>{}(k.letterSpacing) + 0x9e3779b9 + (h << 6) + (h >> 2);
         h ^= std::hash<float>{}(k.wordSpacing) + 0x9e3779b9 + (h << 6) + (h >> 2);
-        h ^= std::hash<uint64_t>{}(k.fontVersion) + 0x9e3779b9 + (h << 6) + (h >> 2);
         return h;
     }
 };
@@ -125,9 +144,10 @@ struct ShapedResult {
     bool is_emoji;
 };
 
-struct ShapingKey {
-    std::string text;
-    std::string font_family;
+template <typename String>
+struct BasicShapingKey {
+    String text;
+    uint32_t fontSetId;
     float font_size;
     int font_weight;
     bool italic;
@@ -138,19 +158,29 @@ struct ShapingKey {
     float letterSpacing;
     float wordSpacing;
 
-    bool operator==(const ShapingKey& other) const {
+    template <typename Other>
+    bool operator==(const BasicShapingKey<Other>& other) const {
         return font_size == other.font_size && font_weight == other.font_weight &&
                italic == other.italic && is_rtl == other.is_rtl &&
-               font_family == other.font_family && text == other.text && mode == other.mode &&
+               fontSetId == other.fontSetId && text == other.text && mode == other.mode &&
                orientation == other.orientation && textCombineUpright == other.textCombineUpright &&
                letterSpacing == other.letterSpacing && wordSpacing == other.wordSpacing;
     }
+
+    BasicShapingKey<std::string> owned() const {
+        return {std::string(text), fontSetId, font_size, font_weight, italic, is_rtl,
+                mode, orientation, textCombineUpright, letterSpacing, wordSpacing};
+    }
 };
 
+using ShapingKey = BasicShapingKey<std::string>;
+using ShapingKeyView = BasicShapingKey<std::string_view>;
+
 struct ShapingKeyHash {
-    std::size_t operator()(const ShapingKey& k) const {
-        std::size_t h = std::hash<std::string>{}(k.text);
-        h ^= std::hash<std::string>{}(k.font_family) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    template <typename String>
+    std::size_t operator()(const BasicShapingKey<String>& k) const {
+        std::size_t h = std::hash<std::string_view>{}(k.text);
+        h ^= std::hash<uint32_t>{}(k.fontSetId) + 0x9e3779b9 + (h << 6) + (h >> 2);
         h ^= std::hash<float>{}(k.font_size) + 0x9e3779b9 + (h << 6) + (h >> 2);
         h ^= std::hash<int>{}(k.font_weight) + 0x9e3779b9 + (h << 6) + (h >> 2);
         h ^= std::hash<bool>{}(k.italic) + 0x9e3779b9 + (h << 6) + (h >> 2);
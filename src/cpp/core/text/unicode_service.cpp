@@ -168,15 +168,17 @@ void UnicodeService::getLineBreaks(const char* text, size_t len, const char* lan
         return;
     }
 
-    std::string key;
+    std::string langKey;
+    std::string_view key(text, len);
+    size_t keyHash = 0;
     if (cacheManager) {
         if (lang && *lang) {
-            key = std::string(lang) + ":" + std::string(text, len);
-        } else {
-            key = std::string(text, len);
+            langKey = std::string(lang) + ":" + std::string(text, len);
+            key = langKey;
         }
 
-        if (std::vector<char>* cached = cacheManager->lineBreakCache.get(key)) {
+        keyHash = cacheManager->lineBreakCache.hash(key);
+        if (std::vector<char>* cached = cacheManager->lineBreakCache.get(key, keyHash)) {
             breaks = *cached;
             return;
         }
@@ -186,7 +188,7 @@ void UnicodeService::getLineBreaks(const char* text, size_t len, const char* lan
     set_linebreaks_utf8((const unsigned char*)text, len, lang, breaks.data());
 
     if (cacheManager) {
-        cacheManager->lineBreakCache.put(key, breaks);
+        cacheManager->lineBreakCache.put(std::string(key), breaks, keyHash);
     }
 }
 
@@ -62,6 +62,8 @@ namespace litehtml
 		pixel_t		calc_percent(pixel_t width) const;
 		bool		from_token(const css_token& token, int options, const string& predefined_keywords = "");
 		string		to_string() const;
+		bool		operator==(const css_length& val) const;
+		bool		operator!=(const css_length& val) const { return !(*this == val); }
 
 		void        set_calc(float px, float percent, float rem) { m_px = px; m_percent = percent; m_rem = rem; m_is_calc = true; m_is_predefined = false; m_op = op_none; m_operands.clear(); }
 		void        set_math(math_op op, std::vector<css_length>&& operands) { m_px = 0; m_percent = 0; m_rem = 0; m_op = op; m_operands = std::move(operands); m_is_calc = true; m_is_predefined = false; }
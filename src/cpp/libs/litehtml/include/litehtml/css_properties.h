@@ -154,6 +154,9 @@ namespace litehtml
     container_type m_container_type;
     string m_container_name;
     css_token_vector m_clip;
+    page_break m_break_before;
+    page_break m_break_after;
+    page_break m_break_inside;
 
   private:
     void compute_font(const element *el, const std::shared_ptr<document> &doc);
@@ -246,7 +249,10 @@ namespace litehtml
                        m_mix_blend_mode(blend_mode_normal),
                        m_background_blend_mode(blend_mode_normal),
                        m_isolation(isolation_auto),
-                       m_container_type(container_type_none)
+                       m_container_type(container_type_none),
+                       m_break_before(page_break_auto),
+                       m_break_after(page_break_auto),
+                       m_break_inside(page_break_auto)
     {
     }
 
@@ -475,6 +481,10 @@ namespace litehtml
     isolation get_isolation() const;
     void set_isolation(isolation m_iso);
 
+    page_break get_break_before() const;
+    page_break get_break_after() const;
+    page_break get_break_inside() const;
+
     container_type get_container_type() const;
     void set_container_type(container_type type);
 
@@ -492,6 +502,7 @@ namespace litehtml
     int get_text_emphasis_position() const;
 
     const shadow_vector &get_box_shadow() const;
+    const shadow_vector &get_text_shadow() const;
     const css_token_vector &get_transform() const;
     const css_token_vector &get_rotate() const;
     const css_token_vector &get_scale() const;
@@ -1209,6 +1220,21 @@ namespace litehtml
     m_isolation = m_iso;
   }
 
+  inline page_break css_properties::get_break_before() const
+  {
+    return m_break_before;
+  }
+
+  inline page_break css_properties::get_break_after() const
+  {
+    return m_break_after;
+  }
+
+  inline page_break css_properties::get_break_inside() const
+  {
+    return m_break_inside;
+  }
+
   inline container_type css_properties::get_container_type() const
   {
     return m_container_type;
@@ -1263,6 +1289,7 @@ namespace litehtml
   }
 
   inline const shadow_vector &css_properties::get_box_shadow() const { return m_box_shadow; }
+  inline const shadow_vector &css_properties::get_text_shadow() const { return m_text_shadow; }
 
   inline const css_token_vector &css_properties::get_transform() const
   {
@@ -107,6 +107,9 @@ namespace litehtml
 		bool is_media_valid() const;
 		bool is_container_valid(const html_tag* el) const;
 		void add_media_to_doc(document* doc) const;
+		// Whether a match can change when a sibling (+, ~, :nth-child(of S)) or a descendant
+		// (:has) of the subject changes, not only the subject and its ancestors
+		void collect_dependencies(bool& siblings, bool& descendants) const;
 	};
 
 	inline bool css_selector::is_media_valid() const
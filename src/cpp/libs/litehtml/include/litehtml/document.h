@@ -6,6 +6,7 @@
 #include "master_css.h"
 #include "encodings.h"
 #include "font_description.h"
+#include "node_arena.h"
 #include <vector>
 
 typedef struct GumboInternalOutput GumboOutput;
@@ -43,14 +44,7 @@ namespace litehtml
 
 	class html_tag;
 	class render_item;
-
-	struct custom_property_definition
-	{
-		string_id name;
-		string syntax;
-		bool inherits;
-		css_token_vector initial_value;
-	};
+	class style_sharing_cache;
 
 	class document : public std::enable_shared_from_this<document>
 	{
@@ -58,20 +52,26 @@ namespace litehtml
 		typedef std::shared_ptr<document>	ptr;
 		typedef std::weak_ptr<document>		weak_ptr;
 	private:
+		node_arena							m_node_arena;
 		std::shared_ptr<element>			m_root;
 		std::shared_ptr<render_item>		m_root_render;
+		bool								m_draw_extents_dirty = true;
+		bool								m_render_tree_dirty = false;
+		int									m_measure_count = 0;
+		style_sharing_cache*				m_style_sharing = nullptr;
 		document_container*					m_container;
 		fonts_map							m_fonts;
 		css_text::vector					m_css;
 		litehtml::css						m_styles;
 		litehtml::web_color					m_def_color;
-		litehtml::css						m_master_css;
-		litehtml::css						m_user_css;
+		css::const_ptr						m_master_css;
+		css::const_ptr						m_user_css;
 		litehtml::size						m_size;
 		position::vector					m_fixed_boxes;
 		std::shared_ptr<element>			m_over_element;
 		std::shared_ptr<element>			m_active_element;
 		std::list<shared_ptr<render_item>>	m_tabular_elements;
+		std::vector<std::shared_ptr<element>> m_resized_containers;
 		media_query_list_list::vector		m_media_lists;
 		media_features						m_media;
 		string								m_lang;
@@ -114,9 +114,32 @@ namespace litehtml
 		bool							lang_changed();
 		bool							match_lang(const string& lang);
 		void							add_tabular(const std::shared_ptr<render_item>& el);
+		// Called by layout when the size of a container-type element changed
+		void							container_resized(const std::shared_ptr<element>& el);
+		// Style sharing cache of the compute_styles pass in progress, if any
+		style_sharing_cache*			style_sharing() const { return m_style_sharing; }
+		void							style_sharing(style_sharing_cache* cache) { m_style_sharing = cache; }
+		// Pool that elements, computed styles and render items of this document are allocated from
+		const node_arena&				arena() const { return m_node_arena; }
 		std::shared_ptr<const element>	get_over_element() const { return m_over_element; }
 
 		void							append_children_from_string(element& parent, const char* str, bool replace_existing);
+		// Template patching: change a rendered document in place and call render() again.
+		// Edits that keep the shape of the render tree update it directly and only invalidate
+		// the layout of the affected boxes and their ancestors; other edits rebuild the render
+		// tree (not the styles of untouched elements) on the next render(). Only the patched
+		// element and its descendants are restyled, plus the elements following it when a
+		// stylesheet has sibling selectors; a :has() selector restyles the whole document.
+		void							set_element_text(const std::shared_ptr<element>& el, const char* text);
+		void							set_element_attr(const std::shared_ptr<element>& el, const char* name, const char* value);
+		// Drops every memoised measurement so the next render() lays the whole tree out again,
+		// e.g. after every image was unloaded.
+		void							invalidate_layout();
+		// Drops the memoised measurements of the boxes sized by image src and of their ancestors
+		void							invalidate_image(const string& src);
+		// Boxes measured by the last render() rather than answered from the memo
+		int								measure_count() const { return m_measure_count; }
+		void							count_measure() { m_measure_count++; }
 		void							dump(dumper& cout);
 
 		void							add_custom_property(const custom_property_definition& def) { m_custom_properties[def.name] = def; }
@@ -134,9 +157,24 @@ namespace litehtml
 			const string&        master_styles = litehtml::master_css,
 			const string&        user_styles = "");
 
+		// Same as above, but attaches stylesheets that are parsed once and shared between documents
+		static document::ptr  createFromString(
+			const estring&       str,
+			document_container*  container,
+			shared_stylesheet&   master_styles,
+			shared_stylesheet&   user_styles);
+
 	private:
 		uint_ptr	add_font(const font_description& descr, font_metrics* fm);
 
+		static document::ptr create_elements(const estring& str, document_container* container);
+		void attach_css(const css& sheet);
+		void init_styles();
+		void build_render_tree();
+		void restyle(const std::shared_ptr<element>& el);
+		void restyle_container(const std::shared_ptr<element>& el);
+		bool has_container_queries() const;
+
 		GumboOutput* parse_html(estring str);
 		void create_node(void* gnode, elements_list& elements, bool parseTextNode, bool process_root);
 		bool update_media_lists(const media_features& features);
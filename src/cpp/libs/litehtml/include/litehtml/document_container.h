@@ -74,6 +74,10 @@ namespace litehtml
                 virtual void                            get_language(litehtml::string& language, litehtml::string& culture) const = 0;
                 virtual litehtml::string        resolve_color(const litehtml::string& /*color*/) const { return litehtml::string(); }
                 virtual void                            split_text(const char* text, const std::function<void(const char*)>& on_word, const std::function<void(const char*)>& on_space);
+                // Widths of consecutive pieces of one run of text in one font (the words and spaces
+                // split_text() produced), measured as if drawn next to each other. The default
+                // measures each piece on its own with text_width().
+                virtual void                            text_widths(const std::vector<const char*>& texts, litehtml::uint_ptr hFont, litehtml::direction dir, litehtml::writing_mode mode, std::vector<pixel_t>& widths);
 
                 virtual void                            push_layer(uint_ptr hdc, float opacity, blend_mode bm) {}
                 virtual void                            pop_layer(uint_ptr hdc) {}
@@ -15,6 +15,7 @@ namespace litehtml
 		el_image(const document::ptr& doc);
 
 		bool	is_replaced() const override;
+		bool	sizes_from_image(const string& src) const override;
 		void	parse_attributes() override;
 		void	parse_presentational_hints() override;
 		void	compute_styles(bool recursive = true) override;
@@ -21,6 +21,12 @@ namespace litehtml
 		const string&		text() const { return m_use_transformed ? m_transformed_text : m_text; }
 		void				set_text(const char* text) override;
 		void				compute_styles(bool recursive) override;
+		// compute_styles() without the measuring: the inline size is left at zero until
+		// set_inline_size() is called. Lets the parent measure a run of text nodes at once.
+		void				compute_text_box();
+		// False for line breaks and text without a font, which keep a zero size
+		bool				is_measured() const;
+		void				set_inline_size(pixel_t inline_size);
 		virtual void		apply_word_break() override;
 		bool				is_text() const override { return true; }
 
@@ -29,6 +35,7 @@ namespace litehtml
 		std::vector<std::tuple<string, string>> dump_get_attrs() override;
 	protected:
 		void				get_content_size(size& sz, pixel_t max_width) override;
+		void				compute_text_style(const element::ptr& el_parent);
 	};
 }
 
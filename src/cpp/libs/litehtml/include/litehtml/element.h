@@ -8,6 +8,7 @@
 #include "types.h"
 #include "stylesheet.h"
 #include "css_properties.h"
+#include "node_arena.h"
 
 namespace litehtml
 {
@@ -29,7 +30,9 @@ namespace litehtml
 		std::weak_ptr<element>					m_parent;
 		std::weak_ptr<document>					m_doc;
 		elements_list							m_children;
-		css_properties							m_css;
+		// Computed style. Elements that compute to the same style during one pass share one
+		// instance (see style_sharing_cache); css_w() detaches it before any write.
+		std::shared_ptr<css_properties>			m_css;
 		std::list<std::weak_ptr<render_item>>	m_renders;
 		used_selector::vector					m_used_styles;
 
@@ -66,6 +69,8 @@ namespace litehtml
 		bool						is_table_skip() const;
 
 		std::shared_ptr<document>	get_document() const;
+		// Node pool of the owner document; empty if the document is gone
+		node_arena					arena() const;
 		const std::list<std::shared_ptr<element>>& children() const;
 
 		std::shared_ptr<render_item> get_render_item();
@@ -91,6 +96,8 @@ namespace litehtml
 		virtual void				apply_stylesheet(const litehtml::css& stylesheet);
 		virtual void				refresh_styles();
 		virtual void				reset_style() {}
+		// Forgets the selectors applied to this subtree so apply_stylesheet can run again
+		virtual void				reset_cascade();
 		virtual bool				is_white_space() const;
 		virtual bool				is_space() const;
 		virtual bool				is_comment() const;
@@ -106,7 +113,12 @@ namespace litehtml
 		virtual bool				set_pseudo_class(string_id cls, bool add);
 		virtual bool				set_class(const char* pclass, bool add);
 		virtual bool				is_replaced() const;
+		// True when the layout of this element depends on the intrinsic size of image src
+		virtual bool				sizes_from_image(const string& src) const;
 		virtual void				compute_styles(bool recursive = true);
+		// compute_styles() of every child. Runs of consecutive text children share this
+		// element's font and are measured together, see document_container::text_widths().
+		void						compute_child_styles();
 		virtual void				apply_word_break();
 		virtual void				draw(uint_ptr hdc, pixel_t x, pixel_t y, const position *clip, const std::shared_ptr<render_item>& ri);
 		virtual void				draw_background(uint_ptr hdc, pixel_t x, pixel_t y, const position *clip, const std::shared_ptr<render_item> &ri);
@@ -262,17 +274,21 @@ namespace litehtml
 
 	inline const css_properties& element::css() const
 	{
-		return m_css;
+		return *m_css;
 	}
 
 	inline css_properties& element::css_w()
 	{
-		return m_css;
+		if (m_css.use_count() > 1)
+		{
+			m_css = make_node<css_properties>(arena(), *m_css);
+		}
+		return *m_css;
 	}
 
 	inline direction element::get_direction() const
 	{
-		return m_css.get_direction();
+		return m_css->get_direction();
 	}
 
 	inline bool element::is_block_box() const
@@ -52,6 +52,7 @@ namespace litehtml
 		void				apply_stylesheet(const litehtml::css& stylesheet) override;
 		void				refresh_styles() override;
 		void				reset_style() override;
+		void				reset_cascade() override;
 
 		bool				is_white_space() const override;
 		bool				is_body() const override;
@@ -66,6 +67,9 @@ namespace litehtml
 		bool				set_class(const char* pclass, bool add) override;
 		bool				is_replaced() const override;
 		void				compute_styles(bool recursive = true) override;
+		// Style sharing, see style_sharing_cache
+		bool				can_share_style() const;
+		bool				has_same_cascade(const html_tag& other) const;
 		void				apply_word_break() override;
 		void				draw(uint_ptr hdc, pixel_t x, pixel_t y, const position *clip, const std::shared_ptr<render_item> &ri) override;
 		void				draw_background(uint_ptr hdc, pixel_t x, pixel_t y, const position *clip,
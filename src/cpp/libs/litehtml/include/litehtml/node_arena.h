@@ -0,0 +1,64 @@
+#ifndef LH_NODE_ARENA_H
+#define LH_NODE_ARENA_H
+
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+namespace litehtml
+{
+	// Memory for the nodes of one document: elements, their computed styles and render items.
+	//
+	// Nodes are carved out of a pool that grabs memory in large chunks, so creating one is a
+	// size-class lookup instead of a trip through malloc, and nodes freed by a re-layout are
+	// reused by the next one. The pool is shared by the document and every node allocated from
+	// it (through the allocator stored in each node's control block): the chunks are released
+	// in one go when the document and its last node are gone, even if some nodes outlive the
+	// document.
+	using node_arena = std::shared_ptr<std::pmr::memory_resource>;
+
+	inline node_arena make_node_arena()
+	{
+		return std::make_shared<std::pmr::unsynchronized_pool_resource>();
+	}
+
+	template<class T>
+	class node_allocator
+	{
+	public:
+		using value_type = T;
+
+		explicit node_allocator(node_arena arena) : m_arena(std::move(arena)) {}
+		template<class U>
+		node_allocator(const node_allocator<U>& other) : m_arena(other.arena()) {}
+
+		T* allocate(std::size_t n)
+		{
+			return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+		}
+		void deallocate(T* p, std::size_t n)
+		{
+			m_arena->deallocate(p, n * sizeof(T), alignof(T));
+		}
+
+		const node_arena& arena() const { return m_arena; }
+
+		template<class U>
+		bool operator==(const node_allocator<U>& other) const { return m_arena == other.arena(); }
+		template<class U>
+		bool operator!=(const node_allocator<U>& other) const { return m_arena != other.arena(); }
+
+	private:
+		node_arena m_arena;
+	};
+
+	// Creates a T in arena, or on the heap when there is no arena (e.g. the document is gone).
+	template<class T, class... Args>
+	std::shared_ptr<T> make_node(const node_arena& arena, Args&&... args)
+	{
+		if (!arena) return std::make_shared<T>(std::forward<Args>(args)...);
+		return std::allocate_shared<T>(node_allocator<T>(arena), std::forward<Args>(args)...);
+	}
+}
+
+#endif  // LH_NODE_ARENA_H
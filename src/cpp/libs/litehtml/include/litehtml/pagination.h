@@ -0,0 +1,45 @@
+#ifndef LH_PAGINATION_H
+#define LH_PAGINATION_H
+
+#include <memory>
+#include <vector>
+#include "types.h"
+
+namespace litehtml
+{
+	class render_item;
+
+	// A place between two boxes or lines where a page may end
+	struct page_break_point
+	{
+		pixel_t	pos;
+		bool	avoid;
+	};
+
+	// The break opportunities of a laid-out tree, as document offsets. content_tops holds the
+	// tops of the boxes that are not broken further, to tell whether a page has any content.
+	struct page_break_map
+	{
+		std::vector<pixel_t>			forced;
+		std::vector<page_break_point>	breaks;
+		std::vector<pixel_t>			content_tops;
+	};
+
+	// Splits a laid-out render tree into pages of page_height for printing, without laying it
+	// out again. Returns the document offset each page starts at; the first one is 0.
+	//
+	// Pages break between in-flow block boxes, between lines and between table rows (a row, or
+	// rows joined by a rowspan, is not broken). Forced break-before/after values start a new
+	// page; break-before/after: avoid and break-inside: avoid are honoured whenever another
+	// break fits on the page. If no break fits, the page is cut at its end.
+	//
+	// Fixed boxes are not repeated: they are drawn at their place in the document and so only
+	// appear on the page that offset falls on (the first page for a box fixed to the top).
+	std::vector<pixel_t> paginate(const std::shared_ptr<render_item>& root, pixel_t page_height, pixel_t content_height);
+
+	// Picks the page starts from map for pages of page_height; the part of paginate() that does
+	// not look at the render tree.
+	std::vector<pixel_t> select_page_starts(page_break_map map, pixel_t page_height, pixel_t content_height);
+}
+
+#endif  // LH_PAGINATION_H
@@ -33,7 +33,7 @@ namespace litehtml
 
 		std::shared_ptr<render_item> clone() override
 		{
-			return std::make_shared<render_item_block>(src_el());
+			return make_node<render_item_block>(src_el()->arena(), src_el());
 		}
 		std::shared_ptr<render_item> init() override;
 		void apply_vertical_align() override;
@@ -21,7 +21,7 @@ namespace litehtml
 
                 std::shared_ptr<render_item> clone() override
                 {
-                        return std::make_shared<render_item_flex>(src_el());
+                        return make_node<render_item_flex>(src_el()->arena(), src_el());
                 }
                 std::shared_ptr<render_item> init() override;
 
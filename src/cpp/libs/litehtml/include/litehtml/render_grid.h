@@ -66,7 +66,7 @@ namespace litehtml
 
 		std::shared_ptr<render_item> clone() override
 		{
-			return std::make_shared<render_item_grid>(src_el());
+			return make_node<render_item_grid>(src_el()->arena(), src_el());
 		}
 		std::shared_ptr<render_item> init() override;
 		void draw_children(uint_ptr hdc, pixel_t x, pixel_t y, const position* clip, draw_flag flag, int zindex) override;
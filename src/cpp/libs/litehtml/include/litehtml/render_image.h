@@ -8,6 +8,8 @@ namespace litehtml
 	class render_item_image : public render_item
 	{
 	protected:
+		pixel_t m_line_height = 0;
+
 		pixel_t calc_max_height(pixel_t image_height, pixel_t containing_block_height);
 		pixel_t _measure(const containing_block_context &containing_block_size, formatting_context* fmt_ctx) override;
 		void _place(pixel_t x, pixel_t y, const containing_block_context &containing_block_size, formatting_context* fmt_ctx) override;
@@ -19,8 +21,10 @@ namespace litehtml
 
 		std::shared_ptr<render_item> clone() override
 		{
-			return std::make_shared<render_item_image>(src_el());
+			return make_node<render_item_image>(src_el()->arena(), src_el());
 		}
+
+		pixel_t line_height() const override { return m_line_height; }
 	};
 }
 
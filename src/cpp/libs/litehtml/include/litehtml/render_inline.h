@@ -30,7 +30,7 @@ namespace litehtml
 
 		std::shared_ptr<render_item> clone() override
 		{
-			return std::make_shared<render_item_inline>(src_el());
+			return make_node<render_item_inline>(src_el()->arena(), src_el());
 		}
 		virtual void y_shift(pixel_t shift) override
 		{
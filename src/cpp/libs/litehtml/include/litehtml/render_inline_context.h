@@ -46,7 +46,7 @@ namespace litehtml
 
 		std::shared_ptr<render_item> clone() override
 		{
-			return std::make_shared<render_item_inline_context>(src_el());
+			return make_node<render_item_inline_context>(src_el()->arena(), src_el());
 		}
 
 		pixel_t get_first_baseline() override;
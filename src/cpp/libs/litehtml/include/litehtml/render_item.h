@@ -80,6 +80,27 @@ namespace litehtml
         int m_cached_bidi_base_level = -1;
         int m_cached_bidi_level = 0;
 
+        // Draw-time culling, rebuilt by update_draw_extent() once layout is final.
+        // m_ink_top/m_ink_bottom bound what this item and its descendants paint, in the same
+        // coordinate space as m_pos. m_cull_children is false when the children are drawn in a
+        // transformed or filtered space that the document clip rectangle does not describe.
+        pixel_t m_ink_top = 0;
+        pixel_t m_ink_bottom = 0;
+        bool m_ink_bounded = false;
+        bool m_cull_children = false;
+        // Only for items with many children: m_children in order, with the running maximum of
+        // the children's ink bottoms and the running minimum (from the back) of their ink tops.
+        // Both are non-decreasing, so the children that may reach the clip are found by binary
+        // search instead of a walk over the whole list.
+        std::vector<std::list<std::shared_ptr<render_item>>::const_iterator> m_cull_index;
+        std::vector<pixel_t> m_cull_max_bottom;
+        std::vector<pixel_t> m_cull_min_top;
+
+        virtual void update_children_draw_extent();
+        void visible_children(pixel_t y, const position& clip,
+                              std::list<std::shared_ptr<render_item>>::const_iterator& first,
+                              std::list<std::shared_ptr<render_item>>::const_iterator& last) const;
+
                 containing_block_context calculate_containing_block_context(const containing_block_context& cb_context);
                 void calc_cb_length(const css_length& len, pixel_t percent_base, containing_block_context::typed_pixel& out_value) const;
                 pixel_t get_predefined_width(pixel_t parent_width) const;
@@ -209,6 +230,15 @@ namespace litehtml
             return m_pos.width + m_margins.width() + m_padding.width() + m_borders.width();
         }
 
+        /**
+         * Line height this box contributes to its line. Replaced boxes override it with their
+         * own height instead of writing it into the (possibly shared) computed style.
+         */
+        virtual pixel_t line_height() const
+        {
+            return css().line_height().computed_value;
+        }
+
         pixel_t inline_size() const;
         pixel_t block_size() const;
         pixel_t inline_size(const satoru::WritingModeContext& wm) const;
@@ -604,7 +634,7 @@ namespace litehtml
 
         virtual std::shared_ptr<render_item> clone()
         {
-            return std::make_shared<render_item>(src_el());
+            return make_node<render_item>(src_el()->arena(), src_el());
         }
         std::tuple<
                 std::shared_ptr<litehtml::render_item>,
@@ -623,6 +653,26 @@ namespace litehtml
                 virtual void set_inline_boxes( position::vector& /*boxes*/ ) {};
                 virtual void add_inline_box( const position& /*box*/ ) {};
                 virtual void clear_inline_boxes() {};
+        /**
+         * Forgets the memoised measure() result of this item (and of its descendants if deep)
+         * and of its ancestors, so the next layout recomputes them. Siblings keep theirs.
+         */
+        void invalidate_layout(bool deep);
+        /**
+         * Recomputes the draw-time culling extents of this subtree. Called by document::draw
+         * after each layout; cullable is false below transformed or filtered ancestors.
+         */
+        void update_draw_extent(bool cullable);
+        // Vertical range painted by this item itself (not its descendants), relative to its parent.
+        void own_ink_extent(pixel_t& top, pixel_t& bottom) const;
+        // Grows this item's extent by child's, with child's parent coordinates at offset_y.
+        void include_ink(const render_item& child, pixel_t offset_y);
+        // Whether this item may paint inside clip when its parent draws its children at offset y.
+        bool ink_intersects(pixel_t y, const position* clip) const
+        {
+            return !clip || !m_ink_bounded ||
+                   (y + m_ink_bottom >= clip->top() && y + m_ink_top <= clip->bottom());
+        }
         void draw_stacking_context( uint_ptr hdc, pixel_t x, pixel_t y, const position* clip, bool with_positioned );
         virtual void draw_children( uint_ptr hdc, pixel_t x, pixel_t y, const position* clip, draw_flag flag, int zindex );
         virtual pixel_t get_draw_vertical_offset() { return 0; }
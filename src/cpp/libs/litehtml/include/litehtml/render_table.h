@@ -14,6 +14,7 @@ namespace litehtml
 		pixel_t						m_border_spacing_y;
 
 		pixel_t layout_table(pixel_t x, pixel_t y, const containing_block_context &containing_block_size, formatting_context* fmt_ctx);
+		void update_children_draw_extent() override;
 		pixel_t _measure(const containing_block_context &containing_block_size, formatting_context* fmt_ctx) override;
 		void _place(pixel_t x, pixel_t y, const containing_block_context &containing_block_size, formatting_context* fmt_ctx) override;
 
@@ -22,11 +23,13 @@ namespace litehtml
 
 		std::shared_ptr<render_item> clone() override
 		{
-			return std::make_shared<render_item_table>(src_el());
+			return make_node<render_item_table>(src_el()->arena(), src_el());
 		}
 		void draw_children(uint_ptr hdc, pixel_t x, pixel_t y, const position* clip, draw_flag flag, int zindex) override;
 		pixel_t get_draw_vertical_offset() override;
 		std::shared_ptr<render_item> init() override;
+		// Captions, rows and cells are positioned against this grid, relative to the table's content box
+		table_grid* grid() const { return m_grid.get(); }
 	};
 
 	class render_item_table_part : public render_item
@@ -37,7 +40,7 @@ namespace litehtml
 
 		std::shared_ptr<render_item> clone() override
 		{
-			return std::make_shared<render_item_table_part>(src_el());
+			return make_node<render_item_table_part>(src_el()->arena(), src_el());
 		}
 	};
 
@@ -49,7 +52,7 @@ namespace litehtml
 
 		std::shared_ptr<render_item> clone() override
 		{
-			return std::make_shared<render_item_table_row>(src_el());
+			return make_node<render_item_table_row>(src_el()->arena(), src_el());
 		}
 		void get_inline_boxes( position::vector& boxes ) const override;
 	};
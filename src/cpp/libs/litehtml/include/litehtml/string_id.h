@@ -11,7 +11,7 @@ namespace litehtml
   {                    \
     __VA_ARGS__        \
   };                   \
-  const auto initial_string_ids = #__VA_ARGS__;
+  constexpr auto initial_string_ids = #__VA_ARGS__;
 
   STRING_ID(
 
@@ -400,6 +400,12 @@ namespace litehtml
       _cover_,
       _scale_down_,
       _isolation_,
+      _break_before_,
+      _break_after_,
+      _break_inside_,
+      _page_break_before_,
+      _page_break_after_,
+      _page_break_inside_,
       _order_,
       _filter_,
       _backdrop_filter_,
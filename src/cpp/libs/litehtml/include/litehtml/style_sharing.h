@@ -0,0 +1,32 @@
+#ifndef LH_STYLE_SHARING_H
+#define LH_STYLE_SHARING_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "css_properties.h"
+
+namespace litehtml
+{
+	class html_tag;
+
+	// Computed styles reused across elements during one compute_styles pass.
+	//
+	// Elements with the same tag, attributes and matched rules, no id or inline style, whose
+	// parents have the same computed style, compute to identical css_properties: the later ones
+	// take a reference to the first one's instead of computing their own. Since parent styles
+	// are compared by address, sharing spreads from siblings to cousins (every <td> of a table,
+	// every <li> of a list) but the cache is only valid for the pass that created it.
+	class style_sharing_cache
+	{
+	public:
+		static constexpr size_t max_candidates = 32;
+
+		// Recently computed shareable elements, most recent first.
+		std::vector<html_tag*> candidates;
+		// Computed style of text nodes, by the address of their parent's computed style.
+		std::unordered_map<const css_properties*, std::shared_ptr<css_properties>> text_styles;
+	};
+}
+
+#endif  // LH_STYLE_SHARING_H
@@ -19,6 +19,15 @@ struct raw_declaration
 	operator bool() const { return name != ""; }
 };
 
+// https://drafts.css-houdini.org/css-properties-values-api/#at-property-rule
+struct custom_property_definition
+{
+	string_id name;
+	string syntax;
+	bool inherits;
+	css_token_vector initial_value;
+};
+
 // intermediate half-parsed rule that is used internally by the parser
 class raw_rule
 {
@@ -43,8 +52,16 @@ public:
 class css
 {
 	bool	m_has_container_queries = false;
+	bool	m_has_sibling_selectors = false;
+	bool	m_has_descendant_selectors = false;
 public:
+	using ptr = shared_ptr<css>;
+	using const_ptr = shared_ptr<const css>;
+
 	bool has_container_queries() const { return m_has_container_queries; }
+	// Selectors whose match depends on siblings or on descendants, see css_selector::collect_dependencies
+	bool has_sibling_selectors() const { return m_has_sibling_selectors; }
+	bool has_descendant_selectors() const { return m_has_descendant_selectors; }
 private:
 	css_selector::vector	m_selectors;
 	std::map<string_id, css_selector::vector> m_id_selectors;
@@ -52,6 +69,11 @@ private:
 	std::map<string_id, css_selector::vector> m_tag_selectors;
 	css_selector::vector	m_universal_selectors;
 
+	// Per-document state created while parsing. It is kept here too, so a parsed sheet
+	// can be attached to other documents (see document::attach_css).
+	media_query_list_list::vector			m_media_lists;
+	std::vector<custom_property_definition>	m_custom_properties;
+
 	std::map<string, int>	m_resolved_ranks;
 	std::map<string, int>	m_segment_orders;
 	std::map<string, int>	m_next_order;
@@ -78,14 +100,18 @@ public:
 		return nullptr;
 	}
 	const css_selector::vector& universal_selectors() const { return m_universal_selectors; }
+	const media_query_list_list::vector& media_lists() const { return m_media_lists; }
+	const std::vector<custom_property_definition>& custom_properties() const { return m_custom_properties; }
 
 	template<class Input>
 	void	parse_css_stylesheet(const Input& input, string baseurl, shared_ptr<document> doc, media_query_list_list::ptr media = nullptr, container_query_list_list::ptr container = nullptr, bool top_level = true, int layer = unlayered_id, string layer_prefix = "");
 
-	void	sort_selectors();
+	// Selectors before sorted_count are already sorted and indexed, only the rest are merged in
+	void	sort_selectors(size_t sorted_count = 0);
 	size_t	get_selectors_count() const { return m_selectors.size(); }
 
 private:
+	void	index_selector(const css_selector::ptr& selector);
 	bool	parse_style_rule(raw_rule::ptr rule, string baseurl, shared_ptr<document> doc, media_query_list_list::ptr media, container_query_list_list::ptr container, int layer);
 	void	parse_import_rule(raw_rule::ptr rule, string baseurl, shared_ptr<document> doc, media_query_list_list::ptr media, container_query_list_list::ptr container, int layer, string layer_prefix);
 	void	add_selector(const css_selector::ptr& selector, int layer);
@@ -96,10 +122,40 @@ private:
 	bool	evaluate_supports_feature(const css_token& token, shared_ptr<document> doc);
 };
 
+// Stylesheet text that is parsed once and then attached to every document created from it.
+// Text is appended in blocks that behave as if they were concatenated; appending a block
+// only parses that block and merges its selectors into the existing sorted index.
+// Selector parsing depends on the document mode (quirks mode lowercases ids and classes),
+// so one parsed sheet is kept per mode.
+class shared_stylesheet
+{
+	struct parsed_sheet
+	{
+		css::ptr	sheet;
+		size_t		blocks = 0;
+	};
+
+	string				m_text;
+	std::vector<size_t>	m_block_starts;
+	int					m_layer;
+	parsed_sheet		m_parsed[limited_quirks_mode + 1];
+public:
+	using ptr = shared_ptr<shared_stylesheet>;
+
+	explicit shared_stylesheet(const string& text = "", int layer = 0) : m_layer(layer) { append(text); }
+
+	const string&	text() const { return m_text; }
+	size_t			blocks_count() const { return m_block_starts.size(); }
+	void			append(const string& text);
+	void			clear();
+	css::const_ptr	get(const shared_ptr<document>& doc);
+};
+
 inline void css::add_selector(const css_selector::ptr& selector, int layer)
 {
 	selector->m_order = (int)m_selectors.size();
 	selector->m_layer = layer;
+	selector->collect_dependencies(m_has_sibling_selectors, m_has_descendant_selectors);
 	m_selectors.push_back(selector);
 }
 
@@ -774,6 +774,40 @@ namespace litehtml
 
 #define isolation_strings "auto;isolate"
 
+// Values of break-before, break-after and break-inside (and of the legacy page-break-*
+// properties). break-inside only accepts auto and the avoid values.
+#define page_break_strings "auto;avoid;always;all;page;left;right;recto;verso;avoid-page;column;avoid-column;region;avoid-region"
+
+	enum page_break
+	{
+		page_break_auto,
+		page_break_avoid,
+		page_break_always,
+		page_break_all,
+		page_break_page,
+		page_break_left,
+		page_break_right,
+		page_break_recto,
+		page_break_verso,
+		page_break_avoid_page,
+		page_break_column,
+		page_break_avoid_column,
+		page_break_region,
+		page_break_avoid_region
+	};
+
+	// True for the values that force a page break
+	inline bool is_forced_page_break(page_break val)
+	{
+		return val >= page_break_always && val <= page_break_verso;
+	}
+
+	// True for the values that avoid a page break
+	inline bool is_avoided_page_break(page_break val)
+	{
+		return val == page_break_avoid || val == page_break_avoid_page;
+	}
+
 	enum isolation
 	{
 		isolation_auto,
@@ -233,6 +233,20 @@ css_length css_length::predef_value(int val)
 	return res;
 }
 
+bool css_length::operator==(const css_length& val) const
+{
+	if (m_is_predefined || val.m_is_predefined)
+	{
+		return m_is_predefined == val.m_is_predefined && m_predef == val.m_predef;
+	}
+	if (m_is_calc || val.m_is_calc)
+	{
+		return m_is_calc == val.m_is_calc && m_op == val.m_op && m_px == val.m_px &&
+			m_percent == val.m_percent && m_rem == val.m_rem && m_operands == val.m_operands;
+	}
+	return m_value == val.m_value && m_units == val.m_units;
+}
+
 string css_length::to_string() const
 {
 	if (is_predefined()) return "";
@@ -68,6 +68,25 @@ void litehtml::css_properties::compute(const element* el, const document::ptr& d
     }
     m_isolation =
         (isolation)el->get_property<int>(_isolation_, false, isolation_auto, offset(m_isolation));
+    // The legacy page-break-* properties are aliases of break-*
+    m_break_before = (page_break)el->get_property<int>(_break_before_, false, page_break_auto,
+                                                       offset(m_break_before));
+    if (m_break_before == page_break_auto) {
+        m_break_before = (page_break)el->get_property<int>(
+            _page_break_before_, false, page_break_auto, offset(m_break_before));
+    }
+    m_break_after = (page_break)el->get_property<int>(_break_after_, false, page_break_auto,
+                                                      offset(m_break_after));
+    if (m_break_after == page_break_auto) {
+        m_break_after = (page_break)el->get_property<int>(_page_break_after_, false,
+                                                          page_break_auto, offset(m_break_after));
+    }
+    m_break_inside = (page_break)el->get_property<int>(_break_inside_, false, page_break_auto,
+                                                       offset(m_break_inside));
+    if (m_break_inside == page_break_auto) {
+        m_break_inside = (page_break)el->get_property<int>(
+            _page_break_inside_, false, page_break_auto, offset(m_break_inside));
+    }
     m_mix_blend_mode = (blend_mode)el->get_property<int>(_mix_blend_mode_, false, blend_mode_normal,
                                                          offset(m_mix_blend_mode));
     m_background_blend_mode = (blend_mode)el->get_property<int>(
@@ -47,6 +47,27 @@ void css_selector::add_media_to_doc(document* doc) const {
     }
 }
 
+void css_selector::collect_dependencies(bool& siblings, bool& descendants) const {
+    if (m_combinator == combinator_adjacent_sibling || m_combinator == combinator_general_sibling) {
+        siblings = true;
+    }
+    for (const auto& attr : m_right.m_attrs) {
+        if (attr.type != select_pseudo_class) continue;
+        if (attr.name == _has_) {
+            descendants = true;
+        } else if ((attr.name == _nth_child_ || attr.name == _nth_last_child_) &&
+                   !attr.selector_list.empty()) {
+            siblings = true;
+        }
+        for (const auto& sel : attr.selector_list) {
+            sel->collect_dependencies(siblings, descendants);
+        }
+    }
+    if (m_left) {
+        m_left->collect_dependencies(siblings, descendants);
+    }
+}
+
 // https://www.w3.org/TR/selectors-4/#type-nmsp
 // <ns-prefix> = [ <ident-token> | '*' ]? '|' https://www.w3.org/TR/selectors-4/#typedef-ns-prefix
 string parse_ns_prefix(const css_token_vector& tokens, int& index) {
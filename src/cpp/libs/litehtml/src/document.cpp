@@ -34,6 +34,9 @@ namespace litehtml
 document::document(document_container* container)
 {
 	m_container	= container;
+	m_node_arena = make_node_arena();
+	m_master_css = make_shared<css>();
+	m_user_css = m_master_css;
 }
 
 document::~document()
@@ -53,6 +56,46 @@ document::ptr document::createFromString(
 	document_container* container,
 	const string& master_styles,
 	const string& user_styles )
+{
+	document::ptr doc = create_elements(str, container);
+
+	if (master_styles != "")
+	{
+		auto master_css = make_shared<css>();
+		master_css->parse_css_stylesheet(master_styles, "", doc, nullptr, nullptr, true, 0);
+		master_css->sort_selectors();
+		doc->m_master_css = master_css;
+	}
+	if (user_styles != "")
+	{
+		auto user_css = make_shared<css>();
+		user_css->parse_css_stylesheet(user_styles, "", doc, nullptr, nullptr, true, 1);
+		user_css->sort_selectors();
+		doc->m_user_css = user_css;
+	}
+
+	doc->init_styles();
+	return doc;
+}
+
+document::ptr document::createFromString(
+	const estring& str,
+	document_container* container,
+	shared_stylesheet& master_styles,
+	shared_stylesheet& user_styles )
+{
+	document::ptr doc = create_elements(str, container);
+
+	doc->m_master_css = master_styles.get(doc);
+	doc->attach_css(*doc->m_master_css);
+	doc->m_user_css = user_styles.get(doc);
+	doc->attach_css(*doc->m_user_css);
+
+	doc->init_styles();
+	return doc;
+}
+
+document::ptr document::create_elements(const estring& str, document_container* container)
 {
 	// Create litehtml::document
 	document::ptr doc = make_shared<document>(container);
@@ -79,28 +122,37 @@ document::ptr document::createFromString(
 	// Destroy GumboOutput
 	gumbo_destroy_output(&kGumboDefaultOptions, output);
 
-	if (master_styles != "")
+	return doc;
+}
+
+// Registers the media lists and @property rules of a sheet, which may have been parsed for another document
+void document::attach_css(const css& sheet)
+{
+	for (const auto& media : sheet.media_lists())
 	{
-		doc->m_master_css.parse_css_stylesheet(master_styles, "", doc, nullptr, nullptr, true, 0);
-		doc->m_master_css.sort_selectors();
+		add_media_list(media);
 	}
-	if (user_styles != "")
+	for (const auto& def : sheet.custom_properties())
 	{
-		doc->m_user_css.parse_css_stylesheet(user_styles, "", doc, nullptr, nullptr, true, 1);
-		doc->m_user_css.sort_selectors();
+		add_custom_property(def);
 	}
+}
+
+void document::init_styles()
+{
+	document::ptr doc = shared_from_this();
 
 	// Let's process created elements tree
-	if (doc->m_root)
+	if (m_root)
 	{
-		doc->container()->get_media_features(doc->m_media);
+		container()->get_media_features(m_media);
 
-		doc->m_root->set_pseudo_class(_root_, true);
+		m_root->set_pseudo_class(_root_, true);
 
-		doc->m_root->apply_stylesheet(doc->m_master_css);
+		m_root->apply_stylesheet(*m_master_css);
 
-		doc->m_root->parse_attributes();
-		for (const auto& css : doc->m_css)
+		m_root->parse_attributes();
+		for (const auto& css : m_css)
 		{
 			media_query_list_list::ptr media;
 			if (css.media != "")
@@ -109,32 +161,39 @@ document::ptr document::createFromString(
 				media = make_shared<media_query_list_list>();
 				media->add(mq_list);
 			}
-			doc->m_styles.parse_css_stylesheet(css.text, css.baseurl, doc, media, nullptr);
+			m_styles.parse_css_stylesheet(css.text, css.baseurl, doc, media, nullptr);
 		}
-		doc->m_styles.sort_selectors();
+		m_styles.sort_selectors();
 
 
-		doc->update_media_lists(doc->m_media);
+		update_media_lists(m_media);
 
-		doc->m_root->apply_stylesheet(doc->m_styles);
+		m_root->apply_stylesheet(m_styles);
 
-		doc->m_root->apply_stylesheet(doc->m_user_css);
+		m_root->apply_stylesheet(*m_user_css);
 
-		doc->m_root->compute_styles();
+		m_root->compute_styles();
 
-		doc->m_root->apply_word_break();
-		doc->m_root_render = doc->m_root->create_render_item(nullptr);
+		m_root->apply_word_break();
+		build_render_tree();
+	}
+}
 
-		doc->fix_tables_layout();
+void document::build_render_tree()
+{
+	// Release the old tree first so elements stop referring to its boxes
+	m_root_render = nullptr;
+	m_tabular_elements.clear();
+	m_render_tree_dirty = false;
 
-		if(doc->m_root_render)
-		{
-			doc->m_root_render = doc->m_root_render->init();
-		}
-	}
+	m_root_render = m_root->create_render_item(nullptr);
 
+	fix_tables_layout();
 
-	return doc;
+	if(m_root_render)
+	{
+		m_root_render = m_root_render->init();
+	}
 }
 
 // https://html.spec.whatwg.org/multipage/parsing.html#change-the-encoding
@@ -312,26 +371,26 @@ void document::create_node(void* gnode, elements_list& elements, bool parseTextN
 	{
 		if (!parseTextNode)
 		{
-			elements.push_back(std::make_shared<el_text>(node->v.text.text, shared_from_this()));
+			elements.push_back(make_node<el_text>(m_node_arena, node->v.text.text, shared_from_this()));
 		}
 		else
 		{
 			m_container->split_text(node->v.text.text,
-				[this, &elements](const char* text) { elements.push_back(std::make_shared<el_text>(text, shared_from_this())); },
-				[this, &elements](const char* text) { elements.push_back(std::make_shared<el_space>(text, shared_from_this())); });
+				[this, &elements](const char* text) { elements.push_back(make_node<el_text>(m_node_arena, text, shared_from_this())); },
+				[this, &elements](const char* text) { elements.push_back(make_node<el_space>(m_node_arena, text, shared_from_this())); });
 		}
 	}
 	break;
 	case GUMBO_NODE_CDATA:
 	{
-		element::ptr ret = std::make_shared<el_cdata>(shared_from_this());
+		element::ptr ret = make_node<el_cdata>(m_node_arena, shared_from_this());
 		ret->set_data(node->v.text.text);
 		elements.push_back(ret);
 	}
 	break;
 	case GUMBO_NODE_COMMENT:
 	{
-		element::ptr ret = std::make_shared<el_comment>(shared_from_this());
+		element::ptr ret = make_node<el_comment>(m_node_arena, shared_from_this());
 		ret->set_data(node->v.text.text);
 		elements.push_back(ret);
 	}
@@ -341,7 +400,7 @@ void document::create_node(void* gnode, elements_list& elements, bool parseTextN
 		string str = node->v.text.text;
 		for (size_t i = 0; i < str.length(); i++)
 		{
-			elements.push_back(std::make_shared<el_space>(str.substr(i, 1).c_str(), shared_from_this()));
+			elements.push_back(make_node<el_space>(m_node_arena, str.substr(i, 1).c_str(), shared_from_this()));
 		}
 	}
 	break;
@@ -378,90 +437,90 @@ element::ptr document::create_element(const char* tag_name, int gumbo_tag)
 		{
 			switch (gumbo_tag)
 			{
-			case GUMBO_TAG_BR:		newTag = std::make_shared<el_break>(this_doc);	break;
-			case GUMBO_TAG_P:		newTag = std::make_shared<el_para>(this_doc);	break;
-			case GUMBO_TAG_IMG:		newTag = std::make_shared<el_image>(this_doc);	break;
-			case GUMBO_TAG_TABLE:	newTag = std::make_shared<el_table>(this_doc);	break;
+			case GUMBO_TAG_BR:		newTag = make_node<el_break>(m_node_arena, this_doc);	break;
+			case GUMBO_TAG_P:		newTag = make_node<el_para>(m_node_arena, this_doc);	break;
+			case GUMBO_TAG_IMG:		newTag = make_node<el_image>(m_node_arena, this_doc);	break;
+			case GUMBO_TAG_TABLE:	newTag = make_node<el_table>(m_node_arena, this_doc);	break;
 			case GUMBO_TAG_TD:
-			case GUMBO_TAG_TH:		newTag = std::make_shared<el_td>(this_doc);		break;
-			case GUMBO_TAG_LINK:	newTag = std::make_shared<el_link>(this_doc);	break;
-			case GUMBO_TAG_TITLE:	newTag = std::make_shared<el_title>(this_doc);	break;
-			case GUMBO_TAG_A:		newTag = std::make_shared<el_anchor>(this_doc);	break;
-			case GUMBO_TAG_TR:		newTag = std::make_shared<el_tr>(this_doc);		break;
-			case GUMBO_TAG_STYLE:	newTag = std::make_shared<el_style>(this_doc);	break;
-			case GUMBO_TAG_BASE:	newTag = std::make_shared<el_base>(this_doc);	break;
-			case GUMBO_TAG_BODY:	newTag = std::make_shared<el_body>(this_doc);	break;
-			case GUMBO_TAG_DIV:		newTag = std::make_shared<el_div>(this_doc);	break;
-			case GUMBO_TAG_SCRIPT:	newTag = std::make_shared<el_script>(this_doc);	break;
-			case GUMBO_TAG_FONT:	newTag = std::make_shared<el_font>(this_doc);	break;
-			default:				newTag = std::make_shared<html_tag>(this_doc);	break;
+			case GUMBO_TAG_TH:		newTag = make_node<el_td>(m_node_arena, this_doc);		break;
+			case GUMBO_TAG_LINK:	newTag = make_node<el_link>(m_node_arena, this_doc);	break;
+			case GUMBO_TAG_TITLE:	newTag = make_node<el_title>(m_node_arena, this_doc);	break;
+			case GUMBO_TAG_A:		newTag = make_node<el_anchor>(m_node_arena, this_doc);	break;
+			case GUMBO_TAG_TR:		newTag = make_node<el_tr>(m_node_arena, this_doc);		break;
+			case GUMBO_TAG_STYLE:	newTag = make_node<el_style>(m_node_arena, this_doc);	break;
+			case GUMBO_TAG_BASE:	newTag = make_node<el_base>(m_node_arena, this_doc);	break;
+			case GUMBO_TAG_BODY:	newTag = make_node<el_body>(m_node_arena, this_doc);	break;
+			case GUMBO_TAG_DIV:		newTag = make_node<el_div>(m_node_arena, this_doc);	break;
+			case GUMBO_TAG_SCRIPT:	newTag = make_node<el_script>(m_node_arena, this_doc);	break;
+			case GUMBO_TAG_FONT:	newTag = make_node<el_font>(m_node_arena, this_doc);	break;
+			default:				newTag = make_node<html_tag>(m_node_arena, this_doc);	break;
 			}
 		}
 		else
 		{
 			if (!strcmp(tag_name, "br"))
 			{
-				newTag = std::make_shared<el_break>(this_doc);
+				newTag = make_node<el_break>(m_node_arena, this_doc);
 			}
 			else if (!strcmp(tag_name, "p"))
 			{
-				newTag = std::make_shared<el_para>(this_doc);
+				newTag = make_node<el_para>(m_node_arena, this_doc);
 			}
 			else if (!strcmp(tag_name, "img"))
 			{
-				newTag = std::make_shared<el_image>(this_doc);
+				newTag = make_node<el_image>(m_node_arena, this_doc);
 			}
 			else if (!strcmp(tag_name, "table"))
 			{
-				newTag = std::make_shared<el_table>(this_doc);
+				newTag = make_node<el_table>(m_node_arena, this_doc);
 			}
 			else if (!strcmp(tag_name, "td") || !strcmp(tag_name, "th"))
 			{
-				newTag = std::make_shared<el_td>(this_doc);
+				newTag = make_node<el_td>(m_node_arena, this_doc);
 			}
 			else if (!strcmp(tag_name, "link"))
 			{
-				newTag = std::make_shared<el_link>(this_doc);
+				newTag = make_node<el_link>(m_node_arena, this_doc);
 			}
 			else if (!strcmp(tag_name, "title"))
 			{
-				newTag = std::make_shared<el_title>(this_doc);
+				newTag = make_node<el_title>(m_node_arena, this_doc);
 			}
 			else if (!strcmp(tag_name, "a"))
 			{
-				newTag = std::make_shared<el_anchor>(this_doc);
+				newTag = make_node<el_anchor>(m_node_arena, this_doc);
 			}
 			else if (!strcmp(tag_name, "tr"))
 			{
-				newTag = std::make_shared<el_tr>(this_doc);
+				newTag = make_node<el_tr>(m_node_arena, this_doc);
 			}
 			else if (!strcmp(tag_name, "style"))
 			{
-				newTag = std::make_shared<el_style>(this_doc);
+				newTag = make_node<el_style>(m_node_arena, this_doc);
 			}
 			else if (!strcmp(tag_name, "base"))
 			{
-				newTag = std::make_shared<el_base>(this_doc);
+				newTag = make_node<el_base>(m_node_arena, this_doc);
 			}
 			else if (!strcmp(tag_name, "body"))
 			{
-				newTag = std::make_shared<el_body>(this_doc);
+				newTag = make_node<el_body>(m_node_arena, this_doc);
 			}
 			else if (!strcmp(tag_name, "div"))
 			{
-				newTag = std::make_shared<el_div>(this_doc);
+				newTag = make_node<el_div>(m_node_arena, this_doc);
 			}
 			else if (!strcmp(tag_name, "script"))
 			{
-				newTag = std::make_shared<el_script>(this_doc);
+				newTag = make_node<el_script>(m_node_arena, this_doc);
 			}
 			else if (!strcmp(tag_name, "font"))
 			{
-				newTag = std::make_shared<el_font>(this_doc);
+				newTag = make_node<el_font>(m_node_arena, this_doc);
 			}
 			else
 			{
-				newTag = std::make_shared<html_tag>(this_doc);
+				newTag = make_node<html_tag>(m_node_arena, this_doc);
 			}
 		}
 	}
@@ -517,9 +576,51 @@ uint_ptr document::get_font( const font_description& descr, font_metrics* fm )
 	return add_font(descr, fm);
 }
 
+// Returns the render item of el if it has exactly one (inline elements split around blocks have several)
+static std::shared_ptr<render_item> sole_render_item(const element::ptr& el)
+{
+	std::shared_ptr<render_item> ret;
+	int count = 0;
+	el->run_on_renderers([&](const std::shared_ptr<render_item>& ri)
+		{
+			ret = ri;
+			return ++count < 2;
+		});
+	return count == 1 ? ret : nullptr;
+}
+
+// What the render tree is built from: the elements of a subtree and how each one is boxed
+struct box_shape
+{
+	const element*	el;
+	style_display	display;
+	element_float	float_;
+	element_position position;
+
+	bool operator==(const box_shape& val) const
+	{
+		return el == val.el && display == val.display && float_ == val.float_ && position == val.position;
+	}
+};
+
+static void collect_box_shape(const element::ptr& el, std::vector<box_shape>& shape)
+{
+	shape.push_back({ el.get(), el->css().get_display(), el->css().get_float(), el->css().get_position() });
+	for (const auto& child : el->children())
+	{
+		collect_box_shape(child, shape);
+	}
+}
+
 pixel_t document::render( pixel_t max_width, render_type rt )
 {
 	pixel_t ret = 0;
+	m_draw_extents_dirty = true;
+	m_measure_count = 0;
+	if(m_root && m_render_tree_dirty)
+	{
+		build_render_tree();
+	}
 	if(m_root && m_root_render)
 	{
 		position viewport;
@@ -550,27 +651,50 @@ pixel_t document::render( pixel_t max_width, render_type rt )
 			m_root_render->render_positioned(rt);
 		} else
 		{
+			m_resized_containers.clear();
 			ret = m_root_render->measure(cb_context, nullptr); m_root_render->place(0, 0, cb_context, nullptr);
-			
-			// Container Queries support: 
-			// After the first layout, container sizes are known.
-			// We trigger a style refresh and a second layout pass.
-			bool has_cq = m_master_css.has_container_queries() || m_styles.has_container_queries() || m_user_css.has_container_queries();
-			bool has_tables = !m_tabular_elements.empty();
-			if (has_cq || has_tables) {
-			m_root->refresh_styles();
-			m_root->compute_styles();
-
-			// Rebuild rendering tree because structure might have changed (e.g. pseudo-elements)
-			m_root_render = m_root->create_render_item(nullptr);
-			fix_tables_layout();
-			if (m_root_render)
+
+			// Container Queries support:
+			// Container sizes are known only after layout. Restyle the subtrees of the containers
+			// whose size changed and lay out again; the rest of the tree keeps its styles and
+			// its memoised measurements.
+			if (!m_resized_containers.empty())
 			{
-				m_root_render = m_root_render->init();
-			}
-			
-			// Second pass
-			ret = m_root_render->measure(cb_context, nullptr); m_root_render->place(0, 0, cb_context, nullptr);
+				// Shared stylesheets may have evaluated their media lists for another document
+				update_media_lists(m_media);
+
+				auto containers = std::move(m_resized_containers);
+				m_resized_containers.clear();
+				// A container measured more than once in a pass is listed more than once
+				std::sort(containers.begin(), containers.end());
+				containers.erase(std::unique(containers.begin(), containers.end()), containers.end());
+				for (const auto& el : containers)
+				{
+					// A resized ancestor container restyles this one too
+					bool nested = false;
+					for (const auto& other : containers)
+					{
+						if (other != el && el->is_ancestor(other))
+						{
+							nested = true;
+							break;
+						}
+					}
+					if (!nested)
+					{
+						restyle_container(el);
+					}
+				}
+
+				// Rebuild rendering tree if its structure changed (e.g. display or pseudo-elements)
+				if (m_render_tree_dirty)
+				{
+					build_render_tree();
+				}
+
+				// Second pass
+				ret = m_root_render->measure(cb_context, nullptr); m_root_render->place(0, 0, cb_context, nullptr);
+				m_resized_containers.clear();
 			}
 
 			if(m_root_render->fetch_positioned())
@@ -590,6 +714,14 @@ void document::draw( uint_ptr hdc, pixel_t x, pixel_t y, const position* clip )
 {
 	if(m_root && m_root_render)
 	{
+		// Subtree extents let draw_children skip everything outside clip. They depend only on
+		// layout, so repeated draws (crops, raster bands) share one pass over the tree.
+		if(m_draw_extents_dirty)
+		{
+			m_root_render->update_draw_extent(true);
+			m_draw_extents_dirty = false;
+		}
+
 		float opacity = m_root->css().get_opacity();
 		blend_mode mix_blend = m_root->css().get_mix_blend_mode();
 		if (opacity < 1.0f || mix_blend != blend_mode_normal) m_container->push_layer(hdc, opacity, mix_blend);
@@ -1005,20 +1137,20 @@ void document::fix_table_children(const std::shared_ptr<render_item>& el_ptr, st
 
 	auto flush_elements = [&]()
 	{
-		element::ptr annon_tag = std::make_shared<el_anonymous>(shared_from_this(), disp);
+		element::ptr annon_tag = make_node<el_anonymous>(m_node_arena, shared_from_this(), disp);
 			annon_tag->parent(el_ptr->src_el());
 			annon_tag->compute_styles(false);
 		std::shared_ptr<render_item> annon_ri;
 		if(annon_tag->css().get_display() == display_table_cell)
 		{
 			annon_tag->set_tagName("table_cell");
-			annon_ri = std::make_shared<render_item_block>(annon_tag);
+			annon_ri = make_node<render_item_block>(m_node_arena, annon_tag);
 		} else if(annon_tag->css().get_display() == display_table_row)
 		{
-			annon_ri = std::make_shared<render_item_table_row>(annon_tag);
+			annon_ri = make_node<render_item_table_row>(m_node_arena, annon_tag);
 		} else
 		{
-			annon_ri = std::make_shared<render_item_table_part>(annon_tag);
+			annon_ri = make_node<render_item_table_part>(m_node_arena, annon_tag);
 		}
 		for(const auto& el : tmp)
 		{
@@ -1128,19 +1260,19 @@ void document::fix_table_parent(const std::shared_ptr<render_item>& el_ptr, styl
 			}
 
 			// extract elements with the same display and wrap them with anonymous object
-			element::ptr annon_tag = std::make_shared<el_anonymous>(shared_from_this(), disp);
+			element::ptr annon_tag = make_node<el_anonymous>(m_node_arena, shared_from_this(), disp);
 			annon_tag->parent(parent->src_el());
 			annon_tag->compute_styles(false);
 			std::shared_ptr<render_item> annon_ri;
 			if(annon_tag->css().get_display() == display_table || annon_tag->css().get_display() == display_inline_table)
 			{
-				annon_ri = std::make_shared<render_item_table>(annon_tag);
+				annon_ri = make_node<render_item_table>(m_node_arena, annon_tag);
 			} else if(annon_tag->css().get_display() == display_table_row)
 			{
-				annon_ri = std::make_shared<render_item_table_row>(annon_tag);
+				annon_ri = make_node<render_item_table_row>(m_node_arena, annon_tag);
 			} else
 			{
-				annon_ri = std::make_shared<render_item_table_part>(annon_tag);
+				annon_ri = make_node<render_item_table_part>(m_node_arena, annon_tag);
 			}
 			std::for_each(first, std::next(last, 1),
 				[&annon_ri](std::shared_ptr<render_item>& el)
@@ -1194,7 +1326,7 @@ void document::append_children_from_string(element& parent, const char* str, boo
 		parent.appendChild(child);
 
 		// apply master CSS
-		child->apply_stylesheet(m_master_css);
+		child->apply_stylesheet(*m_master_css);
 
 		// parse elements attributes
 		child->parse_attributes();
@@ -1203,7 +1335,7 @@ void document::append_children_from_string(element& parent, const char* str, boo
 		child->apply_stylesheet(m_styles);
 
 		// Apply user styles if any
-		child->apply_stylesheet(m_user_css);
+		child->apply_stylesheet(*m_user_css);
 
 		// Initialize m_css
 		child->compute_styles();
@@ -1228,6 +1360,230 @@ void document::append_children_from_string(element& parent, const char* str, boo
 	fix_tables_layout();
 }
 
+// Runs the cascade again for el and its descendants, the way init_styles does for the whole document
+void document::restyle(const element::ptr& el)
+{
+	el->reset_cascade();
+	el->apply_stylesheet(*m_master_css);
+	el->parse_attributes();
+	el->apply_stylesheet(m_styles);
+	el->apply_stylesheet(*m_user_css);
+	el->compute_styles();
+	el->apply_word_break();
+}
+
+bool document::has_container_queries() const
+{
+	return m_master_css->has_container_queries() || m_styles.has_container_queries() || m_user_css->has_container_queries();
+}
+
+void document::container_resized(const element::ptr& el)
+{
+	if (has_container_queries())
+	{
+		m_resized_containers.push_back(el);
+	}
+}
+
+// Re-evaluates the container query selectors below a container that changed size
+void document::restyle_container(const element::ptr& el)
+{
+	std::vector<box_shape> old_shape;
+	collect_box_shape(el, old_shape);
+
+	el->refresh_styles();
+	el->compute_styles();
+
+	std::vector<box_shape> new_shape;
+	collect_box_shape(el, new_shape);
+
+	auto ri = sole_render_item(el);
+	if (old_shape != new_shape || !ri)
+	{
+		m_render_tree_dirty = true;
+		return;
+	}
+	ri->invalidate_layout(true);
+}
+
+void document::set_element_text(const element::ptr& el, const char* text)
+{
+	if (!el || el->is_text() || el->get_document().get() != this)
+	{
+		return;
+	}
+
+	// Text boxes map one to one to text elements, so they can be swapped in place
+	bool text_only = true;
+	for (const auto& child : el->children())
+	{
+		if (child->css().get_display() != display_inline_text)
+		{
+			text_only = false;
+			break;
+		}
+	}
+
+	// ::before and ::after are only created while the stylesheet is applied, so they are kept
+	element::ptr after;
+	if (!el->children().empty() && el->children().back()->tag() == __tag_after_)
+	{
+		after = el->children().back();
+		el->removeChild(after);
+	}
+	elements_list replaced;
+	for (const auto& child : el->children())
+	{
+		if (child->tag() != __tag_before_)
+		{
+			replaced.push_back(child);
+		}
+	}
+	for (const auto& child : replaced)
+	{
+		child->clearRecursive();
+		el->removeChild(child);
+	}
+	m_container->split_text(text ? text : "",
+		[this, &el](const char* word) { el->appendChild(make_node<el_text>(m_node_arena, word, shared_from_this())); },
+		[this, &el](const char* space) { el->appendChild(make_node<el_space>(m_node_arena, space, shared_from_this())); });
+	if (after)
+	{
+		el->appendChild(after);
+	}
+	el->compute_child_styles();
+	el->apply_word_break();
+
+	auto ri = text_only ? sole_render_item(el) : nullptr;
+	if (!ri)
+	{
+		m_render_tree_dirty = true;
+		return;
+	}
+	ri->children().clear();
+	for (const auto& child : el->children())
+	{
+		auto child_ri = child->create_render_item(ri);
+		if (child_ri)
+		{
+			ri->add_child(child_ri->init());
+		}
+	}
+	ri->invalidate_layout(false);
+}
+
+void document::set_element_attr(const element::ptr& el, const char* name, const char* value)
+{
+	if (!el || !name || el->get_document().get() != this)
+	{
+		return;
+	}
+
+	const css* sheets[] = { m_master_css.get(), &m_styles, m_user_css.get() };
+	bool siblings = false;
+	bool descendants = false;
+	for (const auto* sheet : sheets)
+	{
+		siblings = siblings || sheet->has_sibling_selectors();
+		descendants = descendants || sheet->has_descendant_selectors();
+	}
+
+	// :has() lets the attribute change the style of any ancestor and of their siblings
+	if (descendants)
+	{
+		el->set_attr(name, value ? value : "");
+		restyle(m_root);
+		m_render_tree_dirty = true;
+		return;
+	}
+
+	// The patched element, and with sibling selectors the elements following it
+	elements_list restyled = { el };
+	auto parent = el->parent();
+	if (siblings && parent)
+	{
+		bool following = false;
+		for (const auto& sibling : parent->children())
+		{
+			if (following && !sibling->is_text() && !sibling->is_comment())
+			{
+				restyled.push_back(sibling);
+			}
+			following = following || sibling == el;
+		}
+	}
+
+	std::vector<box_shape> old_shape;
+	for (const auto& item : restyled)
+	{
+		collect_box_shape(item, old_shape);
+	}
+
+	el->set_attr(name, value ? value : "");
+	for (const auto& item : restyled)
+	{
+		restyle(item);
+	}
+
+	std::vector<box_shape> new_shape;
+	for (const auto& item : restyled)
+	{
+		collect_box_shape(item, new_shape);
+	}
+
+	if (old_shape != new_shape)
+	{
+		m_render_tree_dirty = true;
+		return;
+	}
+	for (const auto& item : restyled)
+	{
+		if (item->css().get_display() == display_none)
+		{
+			continue;
+		}
+		auto ri = sole_render_item(item);
+		if (!ri)
+		{
+			m_render_tree_dirty = true;
+			return;
+		}
+		ri->invalidate_layout(true);
+	}
+}
+
+void document::invalidate_layout()
+{
+	if (m_root_render)
+	{
+		m_root_render->invalidate_layout(true);
+	}
+}
+
+static void invalidate_image_users(const element::ptr& el, const string& src)
+{
+	if (el->sizes_from_image(src))
+	{
+		el->run_on_renderers([](const std::shared_ptr<render_item>& ri)
+			{
+				ri->invalidate_layout(true);
+				return true;
+			});
+	}
+	for (const auto& child : el->children())
+	{
+		invalidate_image_users(child, src);
+	}
+}
+
+void document::invalidate_image(const string& src)
+{
+	if (m_root_render && m_root)
+	{
+		invalidate_image_users(m_root, src);
+	}
+}
+
 void document::dump(dumper& cout)
 {
 	if(m_root_render)
@@ -40,3 +40,13 @@ void litehtml::document_container::split_text(const char* text, const std::funct
 		on_word(utf32_to_utf8(str));
 	}
 }
+
+void litehtml::document_container::text_widths(const std::vector<const char*>& texts, litehtml::uint_ptr hFont, litehtml::direction dir, litehtml::writing_mode mode, std::vector<pixel_t>& widths)
+{
+	widths.clear();
+	widths.reserve(texts.size());
+	for (auto text : texts)
+	{
+		widths.push_back(text_width(text, hFont, dir, mode));
+	}
+}
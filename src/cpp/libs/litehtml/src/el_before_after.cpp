@@ -106,12 +106,12 @@ void litehtml::el_before_after_base::add_text( const string& txt )
 			{
 				if(!word.empty())
 				{
-					element::ptr el = std::make_shared<el_text>(word.c_str(), get_document());
+					element::ptr el = make_node<el_text>(arena(), word.c_str(), get_document());
 					appendChild(el);
 					word.clear();
 				}
 				word += chr;
-				element::ptr el = std::make_shared<el_space>(word.c_str(), get_document());
+				element::ptr el = make_node<el_space>(arena(), word.c_str(), get_document());
 				appendChild(el);
 				word.clear();
 			} else
@@ -127,7 +127,7 @@ void litehtml::el_before_after_base::add_text( const string& txt )
 	}
 	if(!word.empty())
 	{
-		element::ptr el = std::make_shared<el_text>(word.c_str(), get_document());
+		element::ptr el = make_node<el_text>(arena(), word.c_str(), get_document());
 		appendChild(el);
 		word.clear();
 	}
@@ -189,7 +189,7 @@ void litehtml::el_before_after_base::add_function( const string& fnc, const stri
 			}
 			if(!p_url.empty())
 			{
-				element::ptr el = std::make_shared<el_image>(get_document());
+				element::ptr el = make_node<el_image>(arena(), get_document());
 				el->set_attr("src", p_url.c_str());
 				el->set_attr("style", "display:inline-block");
 				el->set_tagName("img");
@@ -4,7 +4,7 @@
 
 litehtml::el_image::el_image(const document::ptr& doc) : html_tag(doc)
 {
-	m_css.set_display(display_inline_block);
+	css_w().set_display(display_inline_block);
 }
 
 void litehtml::el_image::get_content_size( size& sz, pixel_t /*max_width*/ )
@@ -17,6 +17,11 @@ bool litehtml::el_image::is_replaced() const
 	return true;
 }
 
+bool litehtml::el_image::sizes_from_image(const string& src) const
+{
+	return m_src == src || html_tag::sizes_from_image(src);
+}
+
 void litehtml::el_image::parse_attributes()
 {
 	m_src = get_attr("src", "");
@@ -116,7 +121,7 @@ litehtml::string litehtml::el_image::dump_get_name()
 
 std::shared_ptr<litehtml::render_item> litehtml::el_image::create_render_item(const std::shared_ptr<render_item>& parent_ri)
 {
-	auto ret = std::make_shared<render_item_image>(shared_from_this());
+	auto ret = make_node<render_item_image>(arena(), shared_from_this());
 	ret->parent(parent_ri);
 	return ret;
 }
\ No newline at end of file
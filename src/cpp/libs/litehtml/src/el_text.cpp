@@ -2,6 +2,7 @@
 #include "el_text.h"
 #include "render_item.h"
 #include "document_container.h"
+#include "style_sharing.h"
 
 litehtml::el_text::el_text(const char* text, const document::ptr& doc) : element(doc)
 {
@@ -36,9 +37,8 @@ void litehtml::el_text::set_text( const char* text )
 	compute_styles(false);
 }
 
-void litehtml::el_text::compute_styles(bool /*recursive*/)
+void litehtml::el_text::compute_text_style(const element::ptr& el_parent)
 {
-	element::ptr el_parent = parent();
 	if (el_parent)
 	{
 		css_w().line_height_w() = el_parent->css().line_height();
@@ -50,17 +50,7 @@ void litehtml::el_text::compute_styles(bool /*recursive*/)
 	css_w().set_display(display_inline_text);
 	css_w().set_float(float_none);
 
-	if(m_css.get_text_transform() != text_transform_none)
-	{
-		m_transformed_text	= m_text;
-		m_use_transformed = true;
-		get_document()->container()->transform_text(m_transformed_text, m_css.get_text_transform());
-	} else
-	{
-		m_use_transformed = false;
-	}
-
-	element::ptr p = parent();
+	element::ptr p = el_parent;
 	while(p && p->css().get_display() == display_inline)
 	{
 		if(p->css().get_position() == element_position_relative)
@@ -75,6 +65,49 @@ void litehtml::el_text::compute_styles(bool /*recursive*/)
 	{
 		css_w().set_position(element_position_static);
 	}
+}
+
+void litehtml::el_text::compute_styles(bool /*recursive*/)
+{
+	compute_text_box();
+	if (is_measured())
+	{
+		element::ptr el_parent = parent();
+		set_inline_size(get_document()->container()->text_width(text().c_str(), el_parent->css().get_font(), el_parent->get_direction(), el_parent->css().get_writing_mode()));
+	}
+}
+
+void litehtml::el_text::compute_text_box()
+{
+	element::ptr el_parent = parent();
+	// Text takes its whole style from its ancestors, so text nodes whose parents share a
+	// computed style can share theirs as well.
+	style_sharing_cache* sharing = el_parent ? get_document()->style_sharing() : nullptr;
+	if (sharing)
+	{
+		auto it = sharing->text_styles.find(&el_parent->css());
+		if (it != sharing->text_styles.end())
+		{
+			m_css = it->second;
+		} else
+		{
+			compute_text_style(el_parent);
+			sharing->text_styles.emplace(&el_parent->css(), m_css);
+		}
+	} else
+	{
+		compute_text_style(el_parent);
+	}
+
+	if(m_css->get_text_transform() != text_transform_none)
+	{
+		m_transformed_text	= m_text;
+		m_use_transformed = true;
+		get_document()->container()->transform_text(m_transformed_text, m_css->get_text_transform());
+	} else
+	{
+		m_use_transformed = false;
+	}
 
 	if(is_white_space())
 	{
@@ -109,18 +142,38 @@ void litehtml::el_text::compute_styles(bool /*recursive*/)
 	{
         if (el_parent->css().get_writing_mode() == writing_mode_horizontal_tb)
         {
-		    m_size.width	= get_document()->container()->text_width(m_use_transformed ? m_transformed_text.c_str() : m_text.c_str(), font, el_parent->get_direction(), el_parent->css().get_writing_mode());
+		    m_size.width	= 0;
 		    m_size.height	= fm.height;
         }
         else
         {
 		    m_size.width	= fm.height;
-		    m_size.height	= get_document()->container()->text_width(m_use_transformed ? m_transformed_text.c_str() : m_text.c_str(), font, el_parent->get_direction(), el_parent->css().get_writing_mode());
+		    m_size.height	= 0;
         }
 	}
 	m_draw_spaces = fm.draw_spaces;
 }
 
+bool litehtml::el_text::is_measured() const
+{
+	if (is_break()) return false;
+	element::ptr el_parent = parent();
+	return el_parent && el_parent->css().get_font();
+}
+
+void litehtml::el_text::set_inline_size(pixel_t inline_size)
+{
+	element::ptr el_parent = parent();
+	if (!el_parent) return;
+	if (el_parent->css().get_writing_mode() == writing_mode_horizontal_tb)
+	{
+		m_size.width = inline_size;
+	} else
+	{
+		m_size.height = inline_size;
+	}
+}
+
 void litehtml::el_text::apply_word_break()
 {
 }
@@ -7,6 +7,8 @@
 #include "render_inline.h"
 #include "render_table.h"
 #include "el_before_after.h"
+#include "el_text.h"
+#include "document_container.h"
 
 namespace litehtml
 {
@@ -14,10 +16,16 @@ namespace litehtml
 #define LITEHTML_EMPTY_FUNC			{}
 #define LITEHTML_RETURN_FUNC(ret)	{return ret;}
 
-element::element(const document::ptr& doc) : m_doc(doc)
+element::element(const document::ptr& doc) : m_doc(doc), m_css(make_node<css_properties>(doc ? doc->arena() : nullptr))
 {
 }
 
+node_arena element::arena() const
+{
+	auto doc = m_doc.lock();
+	return doc ? doc->arena() : nullptr;
+}
+
 position element::get_placement() const
 {
 	position pos;
@@ -102,7 +110,7 @@ string element::dump_get_name()
 
 std::vector<std::tuple<string, string>> element::dump_get_attrs()
 {
-	return m_css.dump_get_attrs();
+	return m_css->dump_get_attrs();
 }
 
 void element::dump(dumper& cout)
@@ -143,10 +151,10 @@ std::shared_ptr<render_item> element::create_render_item(const std::shared_ptr<r
 	   css().get_display() == display_table_header_group ||
 	   css().get_display() == display_table_row_group)
 	{
-		ret = std::make_shared<render_item_table_part>(shared_from_this());
+		ret = make_node<render_item_table_part>(arena(), shared_from_this());
 	} else if(css().get_display() == display_table_row)
 	{
-		ret = std::make_shared<render_item_table_row>(shared_from_this());
+		ret = make_node<render_item_table_row>(arena(), shared_from_this());
 	} else if(css().get_display() == display_block ||
 				css().get_display() == display_table_cell ||
 				css().get_display() == display_table_caption ||
@@ -157,24 +165,24 @@ std::shared_ptr<render_item> element::create_render_item(const std::shared_ptr<r
 	{
 		if (css().get_column_count() > 0)
 		{
-			ret = std::make_shared<render_item_grid>(shared_from_this());
+			ret = make_node<render_item_grid>(arena(), shared_from_this());
 		}
 		else
 		{
-			ret = std::make_shared<render_item_block>(shared_from_this());
+			ret = make_node<render_item_block>(arena(), shared_from_this());
 		}
 	} else if(css().get_display() == display_table || css().get_display() == display_inline_table)
 	{
-		ret = std::make_shared<render_item_table>(shared_from_this());
+		ret = make_node<render_item_table>(arena(), shared_from_this());
 	} else if(css().get_display() == display_inline || css().get_display() == display_inline_text)
 	{
-		ret = std::make_shared<render_item_inline>(shared_from_this());
+		ret = make_node<render_item_inline>(arena(), shared_from_this());
 	} else if(css().get_display() == display_flex || css().get_display() == display_inline_flex)
 	{
-		ret = std::make_shared<render_item_flex>(shared_from_this());
+		ret = make_node<render_item_flex>(arena(), shared_from_this());
 	} else if(css().get_display() == display_grid || css().get_display() == display_inline_grid)
 	{
-		ret = std::make_shared<render_item_grid>(shared_from_this());
+		ret = make_node<render_item_grid>(arena(), shared_from_this());
 	}
 	if(ret)
 	{
@@ -223,6 +231,8 @@ bool element::requires_styles_update()
 
 void element::add_render(const std::shared_ptr<render_item>& ri)
 {
+	// Boxes of render trees that were rebuilt since are gone
+	m_renders.remove_if([](const std::weak_ptr<render_item>& weak_ri) { return weak_ri.expired(); });
 	m_renders.push_back(ri);
 }
 
@@ -278,11 +288,11 @@ element::ptr element::_add_before_after(int type, const style& /*style*/)
 	element::ptr el;
 	if(type == 0)
 	{
-		el = std::make_shared<el_before>(get_document());
+		el = make_node<el_before>(arena(), get_document());
 		m_children.insert(m_children.begin(), el);
 	} else
 	{
-		el = std::make_shared<el_after>(get_document());
+		el = make_node<el_after>(arena(), get_document());
 		m_children.insert(m_children.end(), el);
 	}
 	el->parent(shared_from_this());
@@ -291,7 +301,7 @@ element::ptr element::_add_before_after(int type, const style& /*style*/)
 
 bool element::is_block_formatting_context() const
 {
-	if(m_css.get_display() == display_block)
+	if(m_css->get_display() == display_block)
 	{
 		auto par = parent();
 		if(par && (par->css().get_display() == display_inline_flex || par->css().get_display() == display_flex))
@@ -299,19 +309,19 @@ bool element::is_block_formatting_context() const
 			return true;
 		}
 	}
-	if(	m_css.get_display() == display_inline_block ||
-		   m_css.get_display() == display_table_cell ||
-		   m_css.get_display() == display_inline_flex ||
-		   m_css.get_display() == display_flex ||
-		   m_css.get_display() == display_inline_grid ||
-		   m_css.get_display() == display_grid ||
-		   m_css.get_display() == display_table_caption ||
+	if(	m_css->get_display() == display_inline_block ||
+		   m_css->get_display() == display_table_cell ||
+		   m_css->get_display() == display_inline_flex ||
+		   m_css->get_display() == display_flex ||
+		   m_css->get_display() == display_inline_grid ||
+		   m_css->get_display() == display_grid ||
+		   m_css->get_display() == display_table_caption ||
 		   is_root() ||
-		   m_css.get_float() != float_none ||
-		   m_css.get_position() == element_position_absolute ||
-		   m_css.get_position() == element_position_fixed ||
-		   m_css.get_overflow() > overflow_visible ||
-		   m_css.get_opacity() < 1.0f)
+		   m_css->get_float() != float_none ||
+		   m_css->get_position() == element_position_absolute ||
+		   m_css->get_position() == element_position_fixed ||
+		   m_css->get_overflow() > overflow_visible ||
+		   m_css->get_opacity() < 1.0f)
 	{
 		return true;
 	}
@@ -493,6 +503,7 @@ void element::set_data( const char* /*data*/ )										LITEHTML_EMPTY_FUNC
 void element::set_attr( const char* /*name*/, const char* /*val*/ )					LITEHTML_EMPTY_FUNC
 void element::apply_stylesheet( const litehtml::css& /*stylesheet*/ )				LITEHTML_EMPTY_FUNC
 void element::refresh_styles()														LITEHTML_EMPTY_FUNC
+void element::reset_cascade()														LITEHTML_EMPTY_FUNC
 void element::on_click()															LITEHTML_EMPTY_FUNC
 const litehtml::property_value& litehtml::element::get_property_value(string_id /*name*/) const
 {
@@ -507,16 +518,53 @@ bool litehtml::element::get_custom_property(string_id /*name*/, css_token_vector
 
 void element::compute_styles( bool /*recursive*/ )                                                                   LITEHTML_EMPTY_FUNC
 
-void litehtml::el_anonymous::compute_styles(bool recursive)
+void element::compute_child_styles()
 {
-	m_css.compute(this, get_document());
-	if (recursive)
+	uint_ptr font = css().get_font();
+	std::vector<el_text*> run;
+	std::vector<const char*> texts;
+	std::vector<pixel_t> widths;
+	auto measure_run = [&]()
 	{
-		for (auto& el : m_children)
+		if (run.empty()) return;
+		get_document()->container()->text_widths(texts, font, get_direction(), css().get_writing_mode(), widths);
+		for (size_t i = 0; i < run.size(); i++)
+		{
+			run[i]->set_inline_size(i < widths.size() ? widths[i] : 0);
+		}
+		run.clear();
+		texts.clear();
+	};
+
+	for (const auto& el : m_children)
+	{
+		if (!el->is_text())
+		{
+			measure_run();
+			el->compute_styles();
+			continue;
+		}
+		auto text = static_cast<el_text*>(el.get());
+		text->compute_text_box();
+		if (text->is_measured())
 		{
-			el->compute_styles(recursive);
+			run.push_back(text);
+			texts.push_back(text->text().c_str());
+		} else
+		{
+			measure_run();
 		}
 	}
+	measure_run();
+}
+
+void litehtml::el_anonymous::compute_styles(bool recursive)
+{
+	css_w().compute(this, get_document());
+	if (recursive)
+	{
+		compute_child_styles();
+	}
 }
 
 const litehtml::property_value& litehtml::el_anonymous::get_property_value(string_id name) const
@@ -539,6 +587,12 @@ void element::apply_word_break()
 		el->apply_word_break();
 	}
 }
+
+bool element::sizes_from_image(const string& src) const
+{
+	return css().get_list_style_image() == src;
+}
+
 const char* element::get_attr( const char* /*name*/, const char* def /*= 0*/ ) const LITEHTML_RETURN_FUNC(def)
 bool element::is_white_space() const												LITEHTML_RETURN_FUNC(false)
 bool element::is_space() const														LITEHTML_RETURN_FUNC(false)
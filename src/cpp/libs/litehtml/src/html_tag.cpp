@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <typeinfo>
 
 #include "html.h"
 #include "html_tag.h"
@@ -13,6 +14,7 @@
 #include "render_item.h"
 #include "internal.h"
 #include "document_container.h"
+#include "style_sharing.h"
 
 namespace litehtml
 {
@@ -315,7 +317,7 @@ void litehtml::html_tag::apply_stylesheet( const litehtml::css& stylesheet )
 void litehtml::html_tag::get_content_size( size& sz, pixel_t max_width )
 {
         sz.height       = 0;
-        if(m_css.get_display() == display_block)
+        if(m_css->get_display() == display_block)
         {
                 sz.width        = max_width;
         } else
@@ -335,16 +337,16 @@ void litehtml::html_tag::draw(uint_ptr hdc, pixel_t x, pixel_t y, const position
         draw_background(hdc, x, y, clip, ri);
         draw_borders(hdc, x, y, clip, ri);
 
-        if(m_css.get_display() == display_list_item &&
-                (m_css.get_list_style_type() != list_style_type_none || m_css.get_list_style_image() != ""))
+        if(m_css->get_display() == display_list_item &&
+                (m_css->get_list_style_type() != list_style_type_none || m_css->get_list_style_image() != ""))
         {
-                if(m_css.get_overflow() > overflow_visible)
+                if(m_css->get_overflow() > overflow_visible)
                 {
                         position border_box = pos;
                         border_box += ri->get_paddings();
                         border_box += ri->get_borders();
 
-                        border_radiuses bdr_radius = m_css.get_borders().radius.calc_percents(border_box.width, border_box.height);
+                        border_radiuses bdr_radius = m_css->get_borders().radius.calc_percents(border_box.width, border_box.height);
 
                         bdr_radius -= ri->get_borders();
                         bdr_radius -= ri->get_paddings();
@@ -354,7 +356,7 @@ void litehtml::html_tag::draw(uint_ptr hdc, pixel_t x, pixel_t y, const position
 
                 draw_list_marker(hdc, pos, ri);
 
-                if(m_css.get_overflow() > overflow_visible)
+                if(m_css->get_overflow() > overflow_visible)
                 {
                         get_document()->container()->del_clip();
                 }
@@ -440,6 +442,16 @@ void litehtml::html_tag::compute_styles(bool recursive)
     const char* style = get_attr("style");
     document::ptr doc = get_document();
 
+    // The outermost recursive call owns the style sharing cache for its whole subtree.
+    std::unique_ptr<style_sharing_cache> own_sharing;
+    if (recursive && !doc->style_sharing())
+    {
+        own_sharing = std::make_unique<style_sharing_cache>();
+        doc->style_sharing(own_sharing.get());
+    }
+    style_sharing_cache* sharing = doc->style_sharing();
+    bool shareable = sharing && can_share_style();
+
     if (style)
     {
               fflush(stdout);
@@ -450,24 +462,80 @@ void litehtml::html_tag::compute_styles(bool recursive)
     m_style.subst_vars(this);
 
       fflush(stdout);
-    m_css.compute(this, doc);
+    html_tag* shared_from = nullptr;
+    if (shareable)
+    {
+        auto& candidates = sharing->candidates;
+        for (auto it = candidates.begin(); it != candidates.end(); ++it)
+        {
+            if ((*it)->has_same_cascade(*this))
+            {
+                shared_from = *it;
+                std::rotate(candidates.begin(), it, it + 1);
+                break;
+            }
+        }
+    }
+    if (shared_from)
+    {
+        m_css = shared_from->m_css;
+    } else
+    {
+        css_w().compute(this, doc);
+        if (shareable)
+        {
+            auto& candidates = sharing->candidates;
+            if (candidates.size() >= style_sharing_cache::max_candidates) candidates.pop_back();
+            candidates.insert(candidates.begin(), this);
+        }
+    }
 
     if (recursive)
     {
               fflush(stdout);
-        for (const auto& el : m_children)
-        {
-            el->compute_styles();
-        }
+        compute_child_styles();
+    }
+    if (own_sharing)
+    {
+        doc->style_sharing(nullptr);
     }
       fflush(stdout);
     g_cs_depth--;
 }
 
+bool litehtml::html_tag::can_share_style() const
+{
+    // Anonymous boxes (no tag), ids and inline styles give an element a cascade of its own.
+    return m_tag != empty_id && m_id == empty_id && !get_attr("style") && !is_root() && parent();
+}
+
+bool litehtml::html_tag::has_same_cascade(const html_tag& other) const
+{
+    if (m_tag != other.m_tag || typeid(*this) != typeid(other)) return false;
+
+    element::ptr el_parent = parent();
+    element::ptr other_parent = other.parent();
+    if (!el_parent || !other_parent || &el_parent->css() != &other_parent->css()) return false;
+
+    // Equal attributes give equal presentational hints; the matched rules (in order, with
+    // their pseudo-class state) give the rest of the cascade.
+    if (m_attrs != other.m_attrs || m_pseudo_classes != other.m_pseudo_classes) return false;
+    if (m_used_styles.size() != other.m_used_styles.size()) return false;
+    for (size_t i = 0; i < m_used_styles.size(); i++)
+    {
+        if (m_used_styles[i]->m_selector != other.m_used_styles[i]->m_selector ||
+            m_used_styles[i]->m_used != other.m_used_styles[i]->m_used)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 void litehtml::html_tag::apply_word_break()
 {
-	word_break wb = m_css.get_word_break();
-	overflow_wrap ow = m_css.get_overflow_wrap();
+	word_break wb = m_css->get_word_break();
+	overflow_wrap ow = m_css->get_overflow_wrap();
 	if(wb == word_break_break_all || wb == word_break_break_word || ow == overflow_wrap_break_word || ow == overflow_wrap_anywhere)
 	{
 		for (auto it = m_children.begin(); it != m_children.end(); )
@@ -496,7 +564,7 @@ void litehtml::html_tag::apply_word_break()
 						decode_utf8(&next_p);
 						
 						string char_str(p, next_p - p);
-						auto new_el = std::make_shared<el_text>(char_str.c_str(), get_document());
+						auto new_el = make_node<el_text>(arena(), char_str.c_str(), get_document());
 						new_el->parent(shared_from_this());
 						new_el->compute_styles(false);
 						
@@ -1103,7 +1171,7 @@ bool litehtml::html_tag::is_break() const
 void litehtml::html_tag::draw_background(uint_ptr hdc, pixel_t x, pixel_t y, const position *clip,   
                                                                                  const std::shared_ptr<render_item> &ri)
 {
-        if(m_css.get_display() != display_inline && m_css.get_display() != display_table_row)        
+        if(m_css->get_display() != display_inline && m_css->get_display() != display_table_row)        
         {
                 position pos = ri->pos();
                 pos.x   += x;
@@ -1120,11 +1188,11 @@ void litehtml::html_tag::draw_background(uint_ptr hdc, pixel_t x, pixel_t y, con
                         pos.height -= v_offset;
 
                         border_box.round();
-                        border_radiuses radius = m_css.get_borders().radius.calc_percents(border_box.width, border_box.height);
+                        border_radiuses radius = m_css->get_borders().radius.calc_percents(border_box.width, border_box.height);
 
-                        if(!m_css.get_box_shadow().empty())
+                        if(!m_css->get_box_shadow().empty())
                         {
-                                get_document()->container()->draw_box_shadow(hdc, m_css.get_box_shadow(), border_box, radius, false);
+                                get_document()->container()->draw_box_shadow(hdc, m_css->get_box_shadow(), border_box, radius, false);
                         }
 
                         const background* bg = get_background();
@@ -1151,9 +1219,9 @@ void litehtml::html_tag::draw_background(uint_ptr hdc, pixel_t x, pixel_t y, con
                                 }
                         }
 
-                                                if(!m_css.get_box_shadow().empty())
+                                                if(!m_css->get_box_shadow().empty())
                         {
-                                get_document()->container()->draw_box_shadow(hdc, m_css.get_box_shadow(), border_box, radius, true);
+                                get_document()->container()->draw_box_shadow(hdc, m_css->get_box_shadow(), border_box, radius, true);
                         }
                 }
         } else
@@ -1181,31 +1249,31 @@ void litehtml::html_tag::draw_background(uint_ptr hdc, pixel_t x, pixel_t y, con
                                 // set left borders radius for the first box
                                 if(box == boxes.begin())
                                 {
-                                        bdr.radius.bottom_left_x        = m_css.get_borders().radius.bottom_left_x;
-                                        bdr.radius.bottom_left_y        = m_css.get_borders().radius.bottom_left_y;
-                                        bdr.radius.top_left_x           = m_css.get_borders().radius.top_left_x;
-                                        bdr.radius.top_left_y           = m_css.get_borders().radius.top_left_y;
+                                        bdr.radius.bottom_left_x        = m_css->get_borders().radius.bottom_left_x;
+                                        bdr.radius.bottom_left_y        = m_css->get_borders().radius.bottom_left_y;
+                                        bdr.radius.top_left_x           = m_css->get_borders().radius.top_left_x;
+                                        bdr.radius.top_left_y           = m_css->get_borders().radius.top_left_y;
                                 }
 
                                 // set right borders radius for the last box
                                 if(box == boxes.end() - 1)
                                 {
-                                        bdr.radius.bottom_right_x       = m_css.get_borders().radius.bottom_right_x;
-                                        bdr.radius.bottom_right_y       = m_css.get_borders().radius.bottom_right_y;
-                                        bdr.radius.top_right_x          = m_css.get_borders().radius.top_right_x;
-                                        bdr.radius.top_right_y          = m_css.get_borders().radius.top_right_y;
+                                        bdr.radius.bottom_right_x       = m_css->get_borders().radius.bottom_right_x;
+                                        bdr.radius.bottom_right_y       = m_css->get_borders().radius.bottom_right_y;
+                                        bdr.radius.top_right_x          = m_css->get_borders().radius.top_right_x;
+                                        bdr.radius.top_right_y          = m_css->get_borders().radius.top_right_y;
                                 }
 
 
-                                bdr.top         = m_css.get_borders().top;
-                                bdr.bottom      = m_css.get_borders().bottom;
+                                bdr.top         = m_css->get_borders().top;
+                                bdr.bottom      = m_css->get_borders().bottom;
                                 if(box == boxes.begin())
                                 {
-                                        bdr.left        = m_css.get_borders().left;
+                                        bdr.left        = m_css->get_borders().left;
                                 }
                                 if(box == boxes.end() - 1)
                                 {
-                                        bdr.right       = m_css.get_borders().right;
+                                        bdr.right       = m_css->get_borders().right;
                                 }
 
                                 if(bg)
@@ -1226,9 +1294,9 @@ void litehtml::html_tag::draw_background(uint_ptr hdc, pixel_t x, pixel_t y, con
                                                 bg->draw_layer(hdc, i, layer, get_document()->container());  
                                         }
                                 }
-                                if(!m_css.get_box_shadow().empty())
+                                if(!m_css->get_box_shadow().empty())
                                 {
-                                        get_document()->container()->draw_box_shadow(hdc, m_css.get_box_shadow(), *box, bdr.radius.calc_percents(box->width, box->height), true);
+                                        get_document()->container()->draw_box_shadow(hdc, m_css->get_box_shadow(), *box, bdr.radius.calc_percents(box->width, box->height), true);
                                 }
                         }
                 }
@@ -1237,7 +1305,7 @@ void litehtml::html_tag::draw_background(uint_ptr hdc, pixel_t x, pixel_t y, con
 
 void litehtml::html_tag::draw_borders(uint_ptr hdc, pixel_t x, pixel_t y, const position *clip, const std::shared_ptr<render_item> &ri)
 {
-        if(m_css.get_display() != display_inline && m_css.get_display() != display_table_row)        
+        if(m_css->get_display() != display_inline && m_css->get_display() != display_table_row)        
         {
                 position pos = ri->pos();
                 pos.x   += x;
@@ -1254,13 +1322,13 @@ void litehtml::html_tag::draw_borders(uint_ptr hdc, pixel_t x, pixel_t y, const
                         pos.height -= v_offset;
 
                         border_box.round();
-                        border_radiuses radius = m_css.get_borders().radius.calc_percents(border_box.width, border_box.height);
+                        border_radiuses radius = m_css->get_borders().radius.calc_percents(border_box.width, border_box.height);
 
-                        borders bdr = m_css.get_borders();
-                        if(m_css.get_border_image().is_valid())
+                        borders bdr = m_css->get_borders();
+                        if(m_css->get_border_image().is_valid())
                         {
                             bdr.radius = radius;
-                            get_document()->container()->draw_border_image(hdc, m_css.get_border_image(), bdr, border_box, is_root());
+                            get_document()->container()->draw_border_image(hdc, m_css->get_border_image(), bdr, border_box, is_root());
                         }
                         else if(bdr.is_visible())
                         {
@@ -1285,39 +1353,39 @@ void litehtml::html_tag::draw_borders(uint_ptr hdc, pixel_t x, pixel_t y, const
                                 // set left borders radius for the first box
                                 if(box == boxes.begin())
                                 {
-                                        bdr.radius.bottom_left_x        = m_css.get_borders().radius.bottom_left_x;
-                                        bdr.radius.bottom_left_y        = m_css.get_borders().radius.bottom_left_y;
-                                        bdr.radius.top_left_x           = m_css.get_borders().radius.top_left_x;
-                                        bdr.radius.top_left_y           = m_css.get_borders().radius.top_left_y;
+                                        bdr.radius.bottom_left_x        = m_css->get_borders().radius.bottom_left_x;
+                                        bdr.radius.bottom_left_y        = m_css->get_borders().radius.bottom_left_y;
+                                        bdr.radius.top_left_x           = m_css->get_borders().radius.top_left_x;
+                                        bdr.radius.top_left_y           = m_css->get_borders().radius.top_left_y;
                                 }
 
                                 // set right borders radius for the last box
                                 if(box == boxes.end() - 1)
                                 {
-                                        bdr.radius.bottom_right_x       = m_css.get_borders().radius.bottom_right_x;
-                                        bdr.radius.bottom_right_y       = m_css.get_borders().radius.bottom_right_y;
-                                        bdr.radius.top_right_x          = m_css.get_borders().radius.top_right_x;
-                                        bdr.radius.top_right_y          = m_css.get_borders().radius.top_right_y;
+                                        bdr.radius.bottom_right_x       = m_css->get_borders().radius.bottom_right_x;
+                                        bdr.radius.bottom_right_y       = m_css->get_borders().radius.bottom_right_y;
+                                        bdr.radius.top_right_x          = m_css->get_borders().radius.top_right_x;
+                                        bdr.radius.top_right_y          = m_css->get_borders().radius.top_right_y;
                                 }
 
 
-                                bdr.top         = m_css.get_borders().top;
-                                bdr.bottom      = m_css.get_borders().bottom;
+                                bdr.top         = m_css->get_borders().top;
+                                bdr.bottom      = m_css->get_borders().bottom;
                                 if(box == boxes.begin())
                                 {
-                                        bdr.left        = m_css.get_borders().left;
+                                        bdr.left        = m_css->get_borders().left;
                                 }
                                 if(box == boxes.end() - 1)
                                 {
-                                        bdr.right       = m_css.get_borders().right;
+                                        bdr.right       = m_css->get_borders().right;
                                 }
 
-                                if(m_css.get_border_image().is_valid())
+                                if(m_css->get_border_image().is_valid())
                                 {
                                     borders b = bdr;
                                     b.radius = bdr.radius.calc_percents(box->width, box->height);
                                     box->round();
-                                    get_document()->container()->draw_border_image(hdc, m_css.get_border_image(), b, *box, false);
+                                    get_document()->container()->draw_border_image(hdc, m_css->get_border_image(), b, *box, false);
                                 }
                                 else if(bdr.is_visible())
                                 {
@@ -1457,9 +1525,9 @@ void litehtml::html_tag::draw_list_marker( uint_ptr hdc, const position& pos, co
                 lm.pos.height   = img_size.height;
         }
 
-        if (m_css.get_list_style_position() == list_style_position_outside)
+        if (m_css->get_list_style_position() == list_style_position_outside)
         {
-                if (m_css.get_list_style_type() >= list_style_type_armenian)
+                if (m_css->get_list_style_type() >= list_style_type_armenian)
                 {
                         if(lm.font)
                         {
@@ -1477,7 +1545,7 @@ void litehtml::html_tag::draw_list_marker( uint_ptr hdc, const position& pos, co
                 }
         }
 
-        if (m_css.get_list_style_type() >= list_style_type_armenian)
+        if (m_css->get_list_style_type() >= list_style_type_armenian)
         {
                 auto marker_text = get_list_marker_text(lm.index);
                 if (marker_text.empty())
@@ -1506,7 +1574,7 @@ void litehtml::html_tag::draw_list_marker( uint_ptr hdc, const position& pos, co
 
 litehtml::string litehtml::html_tag::get_list_marker_text(int index)
 {
-        switch (m_css.get_list_style_type())
+        switch (m_css->get_list_style_type())
         {
         case litehtml::list_style_type_decimal:
                 return std::to_string(index);
@@ -1769,6 +1837,20 @@ void litehtml::html_tag::reset_style()
 	m_style.clear();
 }
 
+void litehtml::html_tag::reset_cascade()
+{
+	// ::before/::after children are kept: apply_stylesheet finds and restyles them, as refresh_styles does
+	for (auto& el : m_children)
+	{
+		if (el->css().get_display() != display_inline_text)
+		{
+			el->reset_cascade();
+		}
+	}
+	m_used_styles.clear();
+	m_style.clear();
+}
+
 const litehtml::property_value& litehtml::html_tag::get_property_value(string_id name) const
 {
 	return m_style.get_property(name);
@@ -1894,14 +1976,14 @@ const litehtml::background* litehtml::html_tag::get_background(bool own_only)
         if(own_only)
         {
                 // return own background with check for empty one
-                if(m_css.get_bg().is_empty())
+                if(m_css->get_bg().is_empty())
                 {
                         return nullptr;
                 }
-                return &m_css.get_bg();
+                return &m_css->get_bg();
         }
 
-        if(m_css.get_bg().is_empty())
+        if(m_css->get_bg().is_empty())
         {
                 // if this is root element (<html>) try to get background from body
                 if (is_root())
@@ -1931,7 +2013,7 @@ const litehtml::background* litehtml::html_tag::get_background(bool own_only)
                 }
         }
 
-        return &m_css.get_bg();
+        return &m_css->get_bg();
 }
 
 string html_tag::dump_get_name()
@@ -617,7 +617,7 @@ std::list< std::unique_ptr<litehtml::line_box_item> > litehtml::line_box::finish
 															line_max_height.top, line_max_height.bottom);
 			}
 			current_context.fm = lbi->get_el()->css().get_font_metrics();
-			current_context.line_height = lbi->get_el()->css().line_height().computed_value;
+			current_context.line_height = lbi->get_el()->line_height();
 		}
 
 		pixel_t bl = current_context.baseline;
@@ -727,10 +727,10 @@ std::list< std::unique_ptr<litehtml::line_box_item> > litehtml::line_box::finish
 		{
 			if(line_height.has_value())
 			{
-				line_height = std::max(line_height.value(), lbi->get_el()->css().line_height().computed_value);
+				line_height = std::max(line_height.value(), lbi->get_el()->line_height());
 			} else
 			{
-				line_height = lbi->get_el()->css().line_height().computed_value;
+				line_height = lbi->get_el()->line_height();
 			}
 		}
 
@@ -0,0 +1,56 @@
+#include "html.h"
+#include "pagination.h"
+#include <algorithm>
+
+namespace litehtml
+{
+
+std::vector<pixel_t> select_page_starts(page_break_map map, pixel_t page_height, pixel_t content_height)
+{
+	std::vector<pixel_t> pages = {0};
+	if (page_height <= 0) return pages;
+
+	std::sort(map.forced.begin(), map.forced.end());
+	std::sort(map.breaks.begin(), map.breaks.end(), [](const page_break_point& a, const page_break_point& b) { return a.pos < b.pos; });
+	std::sort(map.content_tops.begin(), map.content_tops.end());
+
+	pixel_t top = 0;
+	while (true)
+	{
+		pixel_t limit = top + page_height;
+		pixel_t next = -1;
+
+		// A forced break only counts if the page above it has content, so a break before the
+		// first box or several forced breaks in a row do not make empty pages.
+		auto content = std::lower_bound(map.content_tops.begin(), map.content_tops.end(), top);
+		for (auto f = std::upper_bound(map.forced.begin(), map.forced.end(), top);
+			 f != map.forced.end() && *f < std::min(limit, content_height); ++f)
+		{
+			if (content != map.content_tops.end() && *content < *f)
+			{
+				next = *f;
+				break;
+			}
+		}
+
+		if (next < 0)
+		{
+			if (limit >= content_height) break;
+			// The last break that fits, preferring one that is not avoided
+			pixel_t any = -1;
+			auto it = std::upper_bound(map.breaks.begin(), map.breaks.end(), top, [](pixel_t pos, const page_break_point& b) { return pos < b.pos; });
+			for (; it != map.breaks.end() && it->pos <= limit; ++it)
+			{
+				if (!it->avoid) next = it->pos;
+				any = it->pos;
+			}
+			if (next < 0) next = any >= 0 ? any : limit;
+		}
+
+		pages.push_back(next);
+		top = next;
+	}
+	return pages;
+}
+
+}
@@ -0,0 +1,140 @@
+#include "html.h"
+#include "pagination.h"
+#include "render_item.h"
+#include "render_table.h"
+#include <algorithm>
+
+namespace litehtml
+{
+
+namespace
+{
+	// An in-flow box of a container; pos() of item is relative to origin
+	struct flow_box
+	{
+		std::shared_ptr<render_item> item;
+		pixel_t	origin;
+		pixel_t	top;		// border box top
+		pixel_t	bottom;		// margin box bottom
+		bool	leaf;		// the children of item are not positioned relative to it (table rows)
+	};
+
+	class paginator : public page_break_map
+	{
+	public:
+
+		// origin is the document offset the pos() of el's children is relative to
+		void collect(const std::shared_ptr<render_item>& el, pixel_t origin, bool avoid)
+		{
+			std::vector<flow_box> boxes;
+			if (auto table = std::dynamic_pointer_cast<render_item_table>(el))
+			{
+				collect_table_flow(*table, origin, boxes);
+			} else
+			{
+				collect_flow(el, origin, boxes);
+			}
+			std::stable_sort(boxes.begin(), boxes.end(), [](const flow_box& a, const flow_box& b) { return a.top < b.top; });
+
+			// Overlapping boxes form one group that is never broken: the boxes of one line, or
+			// blocks placed side by side. A page can break above every group but the first.
+			page_break after_prev = page_break_auto;
+			for (size_t i = 0; i < boxes.size(); )
+			{
+				size_t end = i + 1;
+				pixel_t bottom = boxes[i].bottom;
+				while (end < boxes.size() && boxes[end].top < bottom)
+				{
+					bottom = std::max(bottom, boxes[end].bottom);
+					end++;
+				}
+				const flow_box* single = end == i + 1 ? &boxes[i] : nullptr;
+				pixel_t top = boxes[i].top;
+
+				page_break before = single ? single->item->css().get_break_before() : page_break_auto;
+				if (is_forced_page_break(before) || is_forced_page_break(after_prev))
+				{
+					forced.push_back(top);
+				} else if (i > 0)
+				{
+					breaks.push_back({top, avoid || is_avoided_page_break(before) || is_avoided_page_break(after_prev)});
+				}
+
+				if (single && !single->leaf && !single->item->children().empty())
+				{
+					bool avoid_inside = avoid || is_avoided_page_break(single->item->css().get_break_inside());
+					collect(single->item, single->origin + single->item->pos().y, avoid_inside);
+				} else
+				{
+					content_tops.push_back(top);
+				}
+
+				after_prev = single ? single->item->css().get_break_after() : page_break_auto;
+				if (end == boxes.size() && is_forced_page_break(after_prev))
+				{
+					forced.push_back(bottom);
+				}
+				i = end;
+			}
+		}
+
+	private:
+		static void collect_flow(const std::shared_ptr<render_item>& el, pixel_t origin, std::vector<flow_box>& boxes)
+		{
+			for (const auto& child : el->children())
+			{
+				if (child->skip() || child->css().get_display() == display_none) continue;
+				element_position position = child->css().get_position();
+				if (position == element_position_absolute || position == element_position_fixed) continue;
+				if (child->css().get_display() == display_inline)
+				{
+					// An inline box can span several lines; its content takes part in the lines
+					collect_flow(child, origin + child->pos().y, boxes);
+					continue;
+				}
+				boxes.push_back({child, origin, origin + child->top() + child->margin_top(), origin + child->bottom(), false});
+			}
+		}
+
+		// The boxes of a table are its captions and rows; the row groups and rows of its render
+		// tree are not placed, so their children are walked through the grid instead. A row is
+		// never broken, and a cell spanning rows holds them together.
+		static void collect_table_flow(const render_item_table& table, pixel_t origin, std::vector<flow_box>& boxes)
+		{
+			table_grid* grid = table.grid();
+			if (!grid) return;
+			auto& rows = *grid;
+
+			for (const auto& caption : rows.captions())
+			{
+				boxes.push_back({caption, origin, origin + caption->top() + caption->margin_top(), origin + caption->bottom(), false});
+			}
+			pixel_t offset = origin + rows.top_captions_height();
+			for (int row = 0; row < rows.rows_count(); row++)
+			{
+				pixel_t bottom = rows.row(row).bottom;
+				for (int col = 0; col < rows.cols_count(); col++)
+				{
+					table_cell* cell = rows.cell(col, row);
+					if (cell && cell->el && cell->rowspan > 1)
+					{
+						int span_row = std::min(row + cell->rowspan - 1, rows.rows_count() - 1);
+						bottom = std::max(bottom, rows.row(span_row).bottom);
+					}
+				}
+				boxes.push_back({rows.row(row).el_row, offset, offset + rows.row(row).top, offset + bottom, true});
+			}
+		}
+	};
+}
+
+std::vector<pixel_t> paginate(const std::shared_ptr<render_item>& root, pixel_t page_height, pixel_t content_height)
+{
+	if (!root || page_height <= 0) return {0};
+
+	paginator p;
+	p.collect(root, root->pos().y, false);
+	return select_page_starts(std::move(p), page_height, content_height);
+}
+
+}
@@ -133,7 +133,7 @@ std::shared_ptr<litehtml::render_item> litehtml::render_item_block::init()
     }
     if(has_block_level)
     {
-        ret = std::make_shared<render_item_block_context>(src_el());
+        ret = make_node<render_item_block_context>(src_el()->arena(), src_el());
         ret->parent(parent());
 
         auto doc = src_el()->get_document();
@@ -151,8 +151,8 @@ std::shared_ptr<litehtml::render_item> litehtml::render_item_block::init()
             {
                 if(not_ws_added)
                 {
-                    auto anon_el = std::make_shared<html_tag>(src_el());
-                    auto anon_ri = std::make_shared<render_item_block>(anon_el);
+                    auto anon_el = make_node<html_tag>(src_el()->arena(), src_el());
+                    auto anon_ri = make_node<render_item_block>(src_el()->arena(), anon_el);
                     for(const auto& inl : inlines)
                     {
                         anon_ri->add_child(inl);
@@ -169,8 +169,8 @@ std::shared_ptr<litehtml::render_item> litehtml::render_item_block::init()
         }
         if(!inlines.empty() && not_ws_added)
         {
-            auto anon_el = std::make_shared<html_tag>(src_el());
-            auto anon_ri = std::make_shared<render_item_block>(anon_el);
+            auto anon_el = make_node<html_tag>(src_el()->arena(), src_el());
+            auto anon_ri = make_node<render_item_block>(src_el()->arena(), anon_el);
             for(const auto& inl : inlines)
             {
                 anon_ri->add_child(inl);
@@ -184,7 +184,7 @@ std::shared_ptr<litehtml::render_item> litehtml::render_item_block::init()
 
     if(!ret)
     {
-        ret = std::make_shared<render_item_inline_context>(src_el());
+        ret = make_node<render_item_inline_context>(src_el()->arena(), src_el());
         ret->parent(parent());
         ret->children() = children();
         for (const auto &el: ret->children())
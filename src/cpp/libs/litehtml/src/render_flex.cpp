@@ -503,8 +503,8 @@ std::shared_ptr<litehtml::render_item> litehtml::render_item_flex::init()
                 inlines.erase((not_space.base()), inlines.end());
             }
 
-            auto anon_el = std::make_shared<el_anonymous>(src_el()->get_document());
-            auto anon_ri = std::make_shared<render_item_block>(anon_el);
+            auto anon_el = make_node<el_anonymous>(src_el()->arena(), src_el()->get_document());
+            auto anon_ri = make_node<render_item_block>(src_el()->arena(), anon_el);
             for(const auto& inl : inlines)
             {
                 anon_ri->add_child(inl);
@@ -543,8 +543,8 @@ std::shared_ptr<litehtml::render_item> litehtml::render_item_flex::init()
             } else
             {
                 // Wrap inlines with anonymous block box
-                auto anon_el = std::make_shared<el_anonymous>(src_el()->get_document());
-                auto anon_ri = std::make_shared<render_item_block>(anon_el);
+                auto anon_el = make_node<el_anonymous>(src_el()->arena(), src_el()->get_document());
+                auto anon_ri = make_node<render_item_block>(src_el()->arena(), anon_el);
                 anon_ri->add_child(el->init());
                 anon_ri->parent(shared_from_this());
                 anon_el->parent(src_el());
@@ -39,10 +39,10 @@ std::shared_ptr<render_item> render_item_grid::init()
                         for (const auto& word : words)
                         {
                             if (word.empty()) continue;
-                            auto t_el = std::make_shared<el_text>((word + " ").c_str(), src_el()->get_document());
+                            auto t_el = make_node<el_text>(src_el()->arena(), (word + " ").c_str(), src_el()->get_document());
                             t_el->parent(src_el());
                             t_el->compute_styles(false);
-                            auto t_ri = std::make_shared<render_item_inline>(t_el);
+                            auto t_ri = make_node<render_item_inline>(src_el()->arena(), t_el);
                             items.push_back(t_ri->init());
                         }
                     }
@@ -55,10 +55,10 @@ std::shared_ptr<render_item> render_item_grid::init()
             else
             {
                 // Normal Grid: wrap inlines in a single anonymous block
-                auto anon_el = std::make_shared<el_anonymous>(src_el()->get_document());
+                auto anon_el = make_node<el_anonymous>(src_el()->arena(), src_el()->get_document());
                 anon_el->parent(src_el());
                 anon_el->compute_styles(false);
-                auto anon_ri = std::make_shared<render_item_block>(anon_el);
+                auto anon_ri = make_node<render_item_block>(src_el()->arena(), anon_el);
                 for(const auto& inl : current_inlines)
                 {
                     anon_ri->add_child(inl);
@@ -94,13 +94,13 @@ std::shared_ptr<render_item> render_item_grid::init()
         std::vector<std::shared_ptr<render_item>> columns;
         for (int i = 0; i < column_count; i++)
         {
-            auto anon_el = std::make_shared<el_div>(src_el()->get_document());
+            auto anon_el = make_node<el_div>(src_el()->arena(), src_el()->get_document());
             anon_el->parent(src_el());
             string style = "display: block; width: 100%; grid-column-start: " + std::to_string(i + 1);
             anon_el->set_attr("style", style.c_str());
             anon_el->compute_styles(false);
             
-            auto anon_ri = std::make_shared<render_item_block>(anon_el);
+            auto anon_ri = make_node<render_item_block>(src_el()->arena(), anon_el);
             anon_ri->parent(shared_from_this());
             columns.push_back(anon_ri);
         }
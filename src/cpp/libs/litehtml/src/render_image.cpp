@@ -53,7 +53,7 @@ litehtml::pixel_t litehtml::render_item_image::_measure(
         }
     }
 
-    src_el()->css_w().line_height_w().computed_value = height();
+    m_line_height = height();
 
     return m_pos.width + content_offset_width();
 }
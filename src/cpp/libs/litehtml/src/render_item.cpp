@@ -1,5 +1,8 @@
 #include "render_item.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <typeinfo>
 
 #include "css_parser.h"
@@ -48,6 +51,7 @@ litehtml::pixel_t litehtml::render_item::measure(
     m_cached_cb_context = containing_block_size;
     m_self_size = calculate_containing_block_context(containing_block_size);
     m_is_measured = true;
+    src_el()->get_document()->count_measure();
 
     pixel_t measured_size = 0;
     if (src_el()->is_block_formatting_context() || !fmt_ctx) {
@@ -68,21 +72,14 @@ litehtml::pixel_t litehtml::render_item::measure(
         pixel_t current_w = m_pos.width - m_padding.width() - m_borders.width();
         pixel_t current_h = m_pos.height - m_padding.height() - m_borders.height();
 
-        if (src_el()->css_w().m_last_container_size.width != current_w ||
-            src_el()->css_w().m_last_container_size.height != current_h) {
+        if (src_el()->css().m_last_container_size.width != current_w ||
+            src_el()->css().m_last_container_size.height != current_h) {
             src_el()->css_w().m_last_container_size.width = current_w;
             src_el()->css_w().m_last_container_size.height = current_h;
 
-            // Trigger style re-computation for all descendants based on new container size
-            src_el()->compute_styles(true);
-
-            // Re-measure after restyle to apply changes
-            if (src_el()->is_block_formatting_context() || !fmt_ctx) {
-                formatting_context fmt(css().get_writing_mode());
-                measured_size = _measure(containing_block_size, &fmt);
-            } else {
-                measured_size = _measure(containing_block_size, fmt_ctx);
-            }
+            // The document restyles this container's subtree and lays it out again once the
+            // current pass is done.
+            src_el()->get_document()->container_resized(src_el());
         }
     }
 
@@ -847,6 +844,161 @@ void litehtml::render_item::calc_document_size(litehtml::size& sz, pixel_t x /*=
     }
 }
 
+void litehtml::render_item::own_ink_extent(pixel_t& top, pixel_t& bottom) const {
+    const auto& el_css = src_el()->css();
+    const auto& fm = el_css.get_font_metrics();
+    document::ptr doc = src_el()->get_document();
+
+    position::vector boxes;
+    get_inline_boxes(boxes);
+    if (boxes.empty()) {
+        position box = m_pos;
+        box += m_padding;
+        box += m_borders;
+        boxes.push_back(box);
+    }
+    top = boxes.front().top();
+    bottom = boxes.front().bottom();
+    for (const auto& box : boxes) {
+        top = std::min(top, box.top());
+        bottom = std::max(bottom, box.bottom());
+    }
+
+    // Glyphs can overhang their line box by about a font size (tight line-height, italics,
+    // decorations); shadows and outlines paint outside the border box.
+    pixel_t overflow = el_css.get_font_size();
+    pixel_t shadow = 0;
+    for (const auto* shadows : {&el_css.get_box_shadow(), &el_css.get_text_shadow()}) {
+        for (const auto& s : *shadows) {
+            if (s.inset) continue;
+            pixel_t offset_y = doc->to_pixels(s.y, fm, 0);
+            pixel_t blur = doc->to_pixels(s.blur, fm, 0);
+            pixel_t spread = doc->to_pixels(s.spread, fm, 0);
+            shadow = std::max(shadow, std::abs(offset_y) + std::max(spread, (pixel_t)0) + blur * 2);
+        }
+    }
+    overflow += shadow;
+
+    const auto& outline = el_css.get_outline();
+    if (outline.top.style != border_style_none || outline.bottom.style != border_style_none) {
+        pixel_t width = std::max(doc->to_pixels(outline.top.width, fm, 0),
+                                 doc->to_pixels(outline.bottom.width, fm, 0));
+        overflow += width + std::max(doc->to_pixels(el_css.get_outline_offset(), fm, 0), (pixel_t)0);
+    }
+
+    top -= overflow;
+    bottom += overflow;
+
+    // border-image-outset draws the border image outside the border box; resolved the way
+    // container_skia::draw_border_image does (numbers are multiples of the border width).
+    const auto& border_img = el_css.get_border_image();
+    if (border_img.is_valid()) {
+        pixel_t box_height = m_pos.height + m_padding.height() + m_borders.height();
+        auto outset = [&](const css_length& len, pixel_t border_width) {
+            pixel_t val = len.units() == css_units_none ? len.val() * border_width
+                                                         : doc->to_pixels(len, fm, box_height);
+            return std::max(val, (pixel_t)0);
+        };
+        top -= outset(border_img.outset[0], m_borders.top);
+        bottom += outset(border_img.outset[2], m_borders.bottom);
+    }
+}
+
+void litehtml::render_item::include_ink(const render_item& child, pixel_t offset_y) {
+    if (!child.m_ink_bounded) {
+        m_ink_bounded = false;
+        return;
+    }
+    m_ink_top = std::min(m_ink_top, offset_y + child.m_ink_top);
+    m_ink_bottom = std::max(m_ink_bottom, offset_y + child.m_ink_bottom);
+}
+
+void litehtml::render_item::invalidate_layout(bool deep) {
+    m_is_measured = false;
+    // Outlines are recomputed only when the parent width changes; styles may have changed them.
+    m_cached_parent_width = -1;
+    if (deep) {
+        for (const auto& child : m_children) {
+            child->invalidate_layout(true);
+        }
+    }
+    for (auto ri = parent(); ri; ri = ri->parent()) {
+        ri->m_is_measured = false;
+    }
+}
+
+void litehtml::render_item::update_draw_extent(bool cullable) {
+    const auto& el_css = src_el()->css();
+    // Transforms and filters move or spread pixels in ways the box geometry does not show, and
+    // fixed boxes are drawn relative to the viewport rather than to their parent.
+    bool transformed = !el_css.get_transform().empty() || !el_css.get_rotate().empty() ||
+                       !el_css.get_scale().empty() || !el_css.get_translate().empty() ||
+                       !el_css.get_filter().empty() || !el_css.get_backdrop_filter().empty();
+    m_ink_bounded = !transformed && el_css.get_position() != element_position_fixed;
+    m_cull_children = cullable && !transformed;
+    own_ink_extent(m_ink_top, m_ink_bottom);
+    update_children_draw_extent();
+}
+
+void litehtml::render_item::update_children_draw_extent() {
+    // draw_children clips every pass (positioned descendants included) to the padding box of
+    // a box with non-visible overflow, so such a box never paints outside its own extent.
+    bool clipped = src_el()->css().get_overflow() != overflow_visible &&
+                   src_el()->css().get_display() != display_inline;
+    pixel_t offset_y = m_pos.y - get_scroll_top();
+
+    m_cull_index.clear();
+    m_cull_max_bottom.clear();
+    m_cull_min_top.clear();
+    bool indexed = m_cull_children && m_children.size() >= 16;
+
+    for (auto it = m_children.cbegin(); it != m_children.cend(); ++it) {
+        const auto& el = *it;
+        el->update_draw_extent(m_cull_children);
+        if (!el->is_visible()) {
+            if (indexed) {
+                m_cull_index.push_back(it);
+                m_cull_max_bottom.push_back(std::numeric_limits<pixel_t>::lowest());
+                m_cull_min_top.push_back(std::numeric_limits<pixel_t>::max());
+            }
+            continue;
+        }
+        if (!clipped) include_ink(*el, offset_y);
+        if (indexed) {
+            m_cull_index.push_back(it);
+            m_cull_max_bottom.push_back(el->m_ink_bounded ? el->m_ink_bottom
+                                                          : std::numeric_limits<pixel_t>::max());
+            m_cull_min_top.push_back(el->m_ink_bounded ? el->m_ink_top
+                                                       : std::numeric_limits<pixel_t>::lowest());
+        }
+    }
+
+    for (size_t i = 1; i < m_cull_max_bottom.size(); i++) {
+        m_cull_max_bottom[i] = std::max(m_cull_max_bottom[i], m_cull_max_bottom[i - 1]);
+    }
+    for (size_t i = m_cull_min_top.size(); i-- > 1;) {
+        m_cull_min_top[i - 1] = std::min(m_cull_min_top[i - 1], m_cull_min_top[i]);
+    }
+}
+
+void litehtml::render_item::visible_children(
+    pixel_t y, const position& clip, std::list<std::shared_ptr<render_item>>::const_iterator& first,
+    std::list<std::shared_ptr<render_item>>::const_iterator& last) const {
+    if (m_cull_index.empty()) return;
+    // Children before lo end above the clip and children from hi on start below it.
+    size_t lo = std::lower_bound(m_cull_max_bottom.begin(), m_cull_max_bottom.end(),
+                                 clip.top() - y) -
+                m_cull_max_bottom.begin();
+    size_t hi = std::upper_bound(m_cull_min_top.begin(), m_cull_min_top.end(), clip.bottom() - y) -
+                m_cull_min_top.begin();
+    if (lo >= hi) {
+        first = last = m_children.cend();
+        return;
+    }
+    first = m_cull_index[lo];
+    last = hi < m_cull_index.size() ? m_cull_index[hi] : m_children.cend();
+}
+
 void litehtml::render_item::draw_stacking_context(uint_ptr hdc, pixel_t x, pixel_t y,
                                                   const position* clip, bool with_positioned) {
     if (!is_visible()) return;
@@ -941,7 +1093,14 @@ void litehtml::render_item::draw_children(uint_ptr hdc, pixel_t x, pixel_t y, co
         }
     }
 
-    for (const auto& el : m_children) {
+    bool cull = clip && m_cull_children;
+    auto first = m_children.cbegin();
+    auto last = m_children.cend();
+    if (cull) visible_children(pos.y, *clip, first, last);
+
+    for (auto it = first; it != last; ++it) {
+        const auto& el = *it;
+        if (cull && !el->ink_intersects(pos.y, clip)) continue;
         if (el->is_visible()) {
             bool is_positioned = el->src_el()->is_positioned();
             int el_z_index = 0;
@@ -597,6 +597,7 @@ void litehtml::render_item_table::draw_children(uint_ptr hdc, pixel_t x, pixel_t
             table_cell* cell = m_grid->cell(col, row);
             if (cell->el)
             {
+                if (clip && m_cull_children && !cell->el->ink_intersects(pos.y, clip)) continue;
                 if (flag == draw_block)
                 {
                     cell->el->src_el()->draw_borders(hdc, pos.x, pos.y, clip, cell->el);
@@ -607,6 +608,38 @@ void litehtml::render_item_table::draw_children(uint_ptr hdc, pixel_t x, pixel_t
     }
 }
 
+void litehtml::render_item_table::update_children_draw_extent()
+{
+	for (auto& el : m_children)
+	{
+		el->update_draw_extent(m_cull_children);
+	}
+	if (!m_grid) return;
+
+	// draw_children paints captions, rows and cells straight from the grid, all relative to
+	// the table's content box, so the extent is gathered from there rather than m_children.
+	for (auto& caption : m_grid->captions())
+	{
+		include_ink(*caption, m_pos.y);
+	}
+	for (int row = 0; row < m_grid->rows_count(); row++)
+	{
+		const auto& el_row = m_grid->row(row).el_row;
+		pixel_t top, bottom;
+		el_row->own_ink_extent(top, bottom);
+		m_ink_top = std::min(m_ink_top, m_pos.y + top);
+		m_ink_bottom = std::max(m_ink_bottom, m_pos.y + bottom);
+		for (int col = 0; col < m_grid->cols_count(); col++)
+		{
+			table_cell* cell = m_grid->cell(col, row);
+			if (cell->el)
+			{
+				include_ink(*cell->el, m_pos.y);
+			}
+		}
+	}
+}
+
 litehtml::pixel_t litehtml::render_item_table::get_draw_vertical_offset()
 {
     if(m_grid)
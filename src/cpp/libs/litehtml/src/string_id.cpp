@@ -1,6 +1,8 @@
 #include "html.h"
 #include "string_id.h"
+#include <atomic>
 #include <cassert>
+#include <cstring>
 
 #ifndef LITEHTML_NO_THREADS
 	#include <mutex>
@@ -13,20 +15,178 @@
 namespace litehtml
 {
 
-static std::map<string, string_id> map;
-static std::vector<string> array;
+// Interning is split in two:
+//  - the built-in names from initial_string_ids are resolved through an open-addressed table
+//    built at compile time, so no lookup of a known tag/attribute/property name touches shared
+//    mutable state;
+//  - other strings live in an append-only store that readers access without locking. Only
+//    inserting a new string takes the mutex.
+
+static constexpr uint32_t hash_name(const char* str, size_t len)
+{
+	uint32_t h = 2166136261u; // FNV-1a
+	for (size_t i = 0; i < len; i++)
+	{
+		h ^= (unsigned char) str[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+static constexpr size_t builtin_text_length()
+{
+	size_t len = 0;
+	while (initial_string_ids[len]) len++;
+	return len;
+}
+
+static constexpr size_t builtin_name_count()
+{
+	size_t count = 1;
+	for (size_t i = 0; initial_string_ids[i]; i++)
+	{
+		if (initial_string_ids[i] == ',') count++;
+	}
+	return count;
+}
+
+static constexpr size_t builtin_count = builtin_name_count();
+static constexpr size_t builtin_table_size = 2048;
+static_assert(builtin_count == _size_ + 1, "initial_string_ids must match the string_id enum");
+static_assert(builtin_table_size >= builtin_count * 2, "built-in table is too small");
+
+struct builtin_table
+{
+	char names[builtin_text_length()] = {};
+	uint16_t offset[builtin_count] = {};
+	uint16_t length[builtin_count] = {};
+	uint16_t slots[builtin_table_size] = {}; // id + 1, 0 = empty
+};
+
+// _border_color_ -> border-color, in enum order
+static constexpr builtin_table make_builtin_table()
+{
+	builtin_table table;
+	size_t pos = 0;
+	size_t out = 0;
+	for (size_t id = 0; id < builtin_count; id++)
+	{
+		while (initial_string_ids[pos] == ' ' || initial_string_ids[pos] == ',') pos++;
+		size_t start = pos;
+		while (initial_string_ids[pos] && initial_string_ids[pos] != ',' && initial_string_ids[pos] != ' ') pos++;
+		// strip the leading and trailing '_'
+		table.offset[id] = (uint16_t) out;
+		for (size_t i = start + 1; i + 1 < pos; i++)
+		{
+			table.names[out++] = initial_string_ids[i] == '_' ? '-' : initial_string_ids[i];
+		}
+		table.length[id] = (uint16_t) (out - table.offset[id]);
+
+		size_t slot = hash_name(table.names + table.offset[id], table.length[id]) & (builtin_table_size - 1);
+		while (table.slots[slot]) slot = (slot + 1) & (builtin_table_size - 1);
+		table.slots[slot] = (uint16_t) (id + 1);
+	}
+	return table;
+}
+
+static constexpr builtin_table builtins = make_builtin_table();
+
+static int find_builtin(const char* str, size_t len, uint32_t hash)
+{
+	for (size_t slot = hash & (builtin_table_size - 1);; slot = (slot + 1) & (builtin_table_size - 1))
+	{
+		int id = (int) builtins.slots[slot] - 1;
+		if (id < 0) return -1;
+		if (builtins.length[id] == len && memcmp(builtins.names + builtins.offset[id], str, len) == 0)
+			return id;
+	}
+}
+
+// Append-only string storage. A chunk is never moved or freed once published, so _s() reads
+// it without locking; an id is handed out only after its string is stored.
+static constexpr size_t chunk_bits = 10;
+static constexpr size_t chunk_size = size_t(1) << chunk_bits;
+static constexpr size_t max_chunks = 4096;
+static std::atomic<string*> string_chunks[max_chunks];
+static std::atomic<uint32_t> string_count{0};
+
+// Lookup table for the strings that are not built-in: slot = id + 1, 0 = empty. When it fills
+// up a bigger copy is published and the old one is retired but kept alive for readers that
+// may still be probing it.
+struct lookup_table
+{
+	size_t mask;
+	std::atomic<uint32_t>* slots;
+};
+static std::atomic<lookup_table*> dynamic_table{nullptr};
+static size_t dynamic_table_used = 0;
+
+static const string& stored(uint32_t id)
+{
+	return string_chunks[id >> chunk_bits].load(std::memory_order_acquire)[id & (chunk_size - 1)];
+}
+
+static uint32_t store(const string& str)
+{
+	uint32_t id = string_count.load(std::memory_order_relaxed);
+	size_t chunk = id >> chunk_bits;
+	assert(chunk < max_chunks);
+	string* strings = string_chunks[chunk].load(std::memory_order_relaxed);
+	if (!strings)
+	{
+		strings = new string[chunk_size];
+		string_chunks[chunk].store(strings, std::memory_order_release);
+	}
+	strings[id & (chunk_size - 1)] = str;
+	string_count.store(id + 1, std::memory_order_release);
+	return id;
+}
+
+static int find_dynamic(const lookup_table* t, const char* str, size_t len, uint32_t hash)
+{
+	if (!t) return -1;
+	for (size_t slot = hash & t->mask;; slot = (slot + 1) & t->mask)
+	{
+		uint32_t value = t->slots[slot].load(std::memory_order_acquire);
+		if (!value) return -1;
+		const string& s = stored(value - 1);
+		if (s.size() == len && memcmp(s.data(), str, len) == 0) return (int) value - 1;
+	}
+}
+
+static void insert_dynamic(lookup_table* t, uint32_t id, uint32_t hash)
+{
+	size_t slot = hash & t->mask;
+	while (t->slots[slot].load(std::memory_order_relaxed)) slot = (slot + 1) & t->mask;
+	t->slots[slot].store(id + 1, std::memory_order_release);
+}
+
+static lookup_table* grow_table(lookup_table* old)
+{
+	size_t size = old ? (old->mask + 1) * 2 : 1024;
+	auto* t = new lookup_table{size - 1, new std::atomic<uint32_t>[size]};
+	for (size_t i = 0; i < size; i++) t->slots[i].store(0, std::memory_order_relaxed);
+	if (old)
+	{
+		for (size_t i = 0; i <= old->mask; i++)
+		{
+			uint32_t value = old->slots[i].load(std::memory_order_relaxed);
+			if (value)
+			{
+				const string& s = stored(value - 1);
+				insert_dynamic(t, value - 1, hash_name(s.data(), s.size()));
+			}
+		}
+	}
+	dynamic_table.store(t, std::memory_order_release);
+	return t;
+}
 
 static int init()
 {
-	string_vector names;
-	split_string(initial_string_ids, names, ",");
-	for (auto& name : names)
+	for (size_t id = 0; id < builtin_count; id++)
 	{
-		trim(name);
-		assert(name[0] == '_' && name.back() == '_');
-		name = name.substr(1, name.size() - 2);				// _border_color_ -> border_color
-		std::replace(name.begin(), name.end(), '_', '-');	// border_color   -> border-color
-		_id(name);  // this will create association _border_color_ <-> "border-color"
+		store(string(builtins.names + builtins.offset[id], builtins.length[id]));
 	}
 	return 0;
 }
@@ -37,18 +197,29 @@ const string_id star_id = _id("*");
 
 string_id _id(const string& str)
 {
+	uint32_t hash = hash_name(str.data(), str.size());
+	int id = find_builtin(str.data(), str.size(), hash);
+	if (id >= 0) return (string_id) id;
+
+	id = find_dynamic(dynamic_table.load(std::memory_order_acquire), str.data(), str.size(), hash);
+	if (id >= 0) return (string_id) id;
+
 	lock_guard;
-	auto it = map.find(str);
-	if (it != map.end()) return it->second;
-	// else: str not found, add it to the array and the map
-	array.push_back(str);
-	return map[str] = (string_id)(array.size() - 1);
+	lookup_table* t = dynamic_table.load(std::memory_order_acquire);
+	// another thread may have added it since the unlocked probe
+	id = find_dynamic(t, str.data(), str.size(), hash);
+	if (id >= 0) return (string_id) id;
+
+	if (!t || (dynamic_table_used + 1) * 2 > t->mask + 1) t = grow_table(t);
+	uint32_t new_id = store(str);
+	insert_dynamic(t, new_id, hash);
+	dynamic_table_used++;
+	return (string_id) new_id;
 }
 
 const string& _s(string_id id)
 {
-	lock_guard;
-	return array[id];
+	return stored((uint32_t) id);
 }
 
-} // namespace litehtml
\ No newline at end of file
+} // namespace litehtml
@@ -96,6 +96,12 @@ namespace litehtml
           {_mix_blend_mode_, blend_mode_strings},
           {_background_blend_mode_, blend_mode_strings},
           {_isolation_, isolation_strings},
+          {_break_before_, page_break_strings},
+          {_break_after_, page_break_strings},
+          {_break_inside_, page_break_strings},
+          {_page_break_before_, page_break_strings},
+          {_page_break_after_, page_break_strings},
+          {_page_break_inside_, page_break_strings},
   };
   std::map<string_id, vector<string_id>> shorthands =
       {
@@ -297,6 +303,12 @@ namespace litehtml
     case _mix_blend_mode_:
     case _background_blend_mode_:
     case _isolation_:
+    case _break_before_:
+    case _break_after_:
+    case _break_inside_:
+    case _page_break_before_:
+    case _page_break_after_:
+    case _page_break_inside_:
       if (int index = value_index(ident, m_valid_values[name]); index >= 0)
 
 
@@ -11,6 +11,8 @@ namespace litehtml
 template<class Input> // Input == string or css_token_vector
 void css::parse_css_stylesheet(const Input& input, string baseurl, document::ptr doc, media_query_list_list::ptr media, container_query_list_list::ptr container, bool top_level, int layer, string layer_prefix)
 {
+	if (media && !contains(m_media_lists, media))
+		m_media_lists.push_back(media);
 	if (doc && media)
 		doc->add_media_list(media);
 
@@ -232,61 +234,69 @@ bool css::parse_style_rule(raw_rule::ptr rule, string baseurl, document::ptr doc
 	return true;
 }
 
-void css::sort_selectors()
+void css::sort_selectors(size_t sorted_count)
 {
-	std::sort(m_selectors.begin(), m_selectors.end(),
-		 [](const css_selector::ptr& v1, const css_selector::ptr& v2)
-		 {
-			 return (*v1) < (*v2);
-		 }
-	);
-
-	m_id_selectors.clear();
-	m_class_selectors.clear();
-	m_tag_selectors.clear();
-	m_universal_selectors.clear();
-
-	for (const auto& selector : m_selectors)
+	auto less = [](const css_selector::ptr& v1, const css_selector::ptr& v2)
+		{
+			return (*v1) < (*v2);
+		};
+
+	if (sorted_count == 0)
 	{
-		bool added = false;
+		m_id_selectors.clear();
+		m_class_selectors.clear();
+		m_tag_selectors.clear();
+		m_universal_selectors.clear();
+	}
+	if (sorted_count >= m_selectors.size()) return;
 
-		// Check for ID
-		for (const auto& attr : selector->m_right.m_attrs)
-		{
-			if (attr.type == select_id)
-			{
-				m_id_selectors[attr.name].push_back(selector);
-				added = true;
-				break;
-			}
-		}
-		if (added) continue;
+	auto first_new = m_selectors.begin() + sorted_count;
+	std::sort(first_new, m_selectors.end(), less);
+	for (auto it = first_new; it != m_selectors.end(); ++it)
+	{
+		index_selector(*it);
+	}
+	std::inplace_merge(m_selectors.begin(), first_new, m_selectors.end(), less);
+}
 
-		// Check for Class
-		for (const auto& attr : selector->m_right.m_attrs)
+void css::index_selector(const css_selector::ptr& selector)
+{
+	// Keep every bucket sorted: new selectors usually go to the end
+	auto insert = [&](css_selector::vector& bucket)
 		{
-			if (attr.type == select_class)
-			{
-				m_class_selectors[attr.name].push_back(selector);
-				added = true;
-				break;
-			}
-		}
-		if (added) continue;
+			bucket.insert(std::upper_bound(bucket.begin(), bucket.end(), selector,
+				[](const css_selector::ptr& v1, const css_selector::ptr& v2) { return (*v1) < (*v2); }), selector);
+		};
 
-		// Check for Tag
-		if (selector->m_right.m_tag != empty_id && selector->m_right.m_tag != star_id)
+	// Check for ID
+	for (const auto& attr : selector->m_right.m_attrs)
+	{
+		if (attr.type == select_id)
 		{
-			m_tag_selectors[selector->m_right.m_tag].push_back(selector);
-			added = true;
+			insert(m_id_selectors[attr.name]);
+			return;
 		}
+	}
 
-		// Universal / Fallback
-		if (!added)
+	// Check for Class
+	for (const auto& attr : selector->m_right.m_attrs)
+	{
+		if (attr.type == select_class)
 		{
-			m_universal_selectors.push_back(selector);
+			insert(m_class_selectors[attr.name]);
+			return;
 		}
 	}
+
+	// Check for Tag
+	if (selector->m_right.m_tag != empty_id && selector->m_right.m_tag != star_id)
+	{
+		insert(m_tag_selectors[selector->m_right.m_tag]);
+		return;
+	}
+
+	// Universal / Fallback
+	insert(m_universal_selectors);
 }
 
 int css::get_layer_id(const string& name)
@@ -381,6 +391,7 @@ void css::parse_property_rule(raw_rule::ptr rule, shared_ptr<document> doc)
 		}
 	}
 
+	m_custom_properties.push_back(def);
 	doc->add_custom_property(def);
 }
 
@@ -491,4 +502,52 @@ bool css::evaluate_supports_feature(const css_token& block, shared_ptr<document>
 	return !st.get_property(id).is<invalid>();
 }
 
+void shared_stylesheet::append(const string& text)
+{
+	if (text.empty()) return;
+	m_block_starts.push_back(m_text.size());
+	m_text += text;
+	m_text += "\n";
+}
+
+void shared_stylesheet::clear()
+{
+	m_text.clear();
+	m_block_starts.clear();
+	for (auto& parsed : m_parsed)
+	{
+		parsed = parsed_sheet();
+	}
+}
+
+css::const_ptr shared_stylesheet::get(const document::ptr& doc)
+{
+	parsed_sheet& parsed = m_parsed[doc->mode()];
+	if (parsed.sheet && parsed.blocks == m_block_starts.size())
+	{
+		return parsed.sheet;
+	}
+
+	if (!parsed.sheet)
+	{
+		parsed.sheet = make_shared<css>();
+	}
+	else if (parsed.sheet.use_count() > 1)
+	{
+		// Documents keep using the sheet they were created with, so extend a copy.
+		// Copying shares the parsed selectors and only duplicates the index.
+		parsed.sheet = make_shared<css>(*parsed.sheet);
+	}
+
+	size_t sorted_count = parsed.sheet->get_selectors_count();
+	for (; parsed.blocks < m_block_starts.size(); parsed.blocks++)
+	{
+		size_t start = m_block_starts[parsed.blocks];
+		size_t end = parsed.blocks + 1 < m_block_starts.size() ? m_block_starts[parsed.blocks + 1] : m_text.size();
+		parsed.sheet->parse_css_stylesheet(m_text.substr(start, end - start), "", doc, nullptr, nullptr, true, m_layer);
+	}
+	parsed.sheet->sort_selectors(sorted_count);
+	return parsed.sheet;
+}
+
 } // namespace litehtml
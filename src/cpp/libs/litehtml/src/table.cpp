@@ -143,7 +143,9 @@ void litehtml::table_grid::finish()
 	{
 		for(int row = 0; row < m_rows_count; row++)
 		{
-			if(cell(col, row)->el && cell(col, row)->colspan == 1)
+			// css_w() detaches a shared style, so only write when the width actually differs
+			if(cell(col, row)->el && cell(col, row)->colspan == 1 &&
+				cell(col, row)->el->src_el()->css().get_width() != m_columns[col].css_width)
 			{
 				cell(col, row)->el->src_el()->css_w().set_width(m_columns[col].css_width);
 			}
@@ -2,6 +2,8 @@
 #include <emscripten/bind.h>
 #include <emscripten/val.h>
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -109,6 +111,9 @@ void parse_options(RenderOptions& options, val options_val) {
     if (options_val.hasOwnProperty("pdfFooter")) {
         options.pdfFooter = options_val["pdfFooter"].as<std::string>();
     }
+    if (options_val.hasOwnProperty("pdfPageHeight")) {
+        options.pdfPageHeight = options_val["pdfPageHeight"].as<int>();
+    }
 }
 
 // EMSCRIPTEN_BINDINGS helper
@@ -137,6 +142,143 @@ val render_val(SatoruInstance* inst, val htmls, int width, int height, int forma
     return val(typed_memory_view(size, data));
 }
 
+val render_formats_val(SatoruInstance* inst, std::string html, int width, int height,
+                       val formats, val options_list) {
+    if (!inst || !formats.isArray()) return val::null();
+
+    std::vector<RenderFormat> format_vector;
+    std::vector<RenderOptions> options_vector;
+    auto l = formats["length"].as<unsigned>();
+    bool has_options = options_list.isArray();
+    for (unsigned i = 0; i < l; ++i) {
+        format_vector.push_back((RenderFormat)formats[i].as<int>());
+        RenderOptions options;
+        if (has_options && i < options_list["length"].as<unsigned>()) {
+            parse_options(options, options_list[i]);
+        }
+        options_vector.push_back(std::move(options));
+    }
+
+    const auto& outputs =
+        api_render_formats(inst, html, width, height, format_vector, options_vector);
+    val result = val::array();
+    for (const auto& data : outputs) {
+        if (data && data->size() > 0) {
+            result.call<void>("push", val(typed_memory_view(data->size(), data->bytes())));
+        } else {
+            result.call<void>("push", val::null());
+        }
+    }
+    return result;
+}
+
+val render_batch_val(SatoruInstance* inst, val htmls, int width, int height, val formats,
+                     val options_list) {
+    if (!inst || !htmls.isArray()) return val::null();
+
+    std::vector<std::string> html_vector;
+    auto l = htmls["length"].as<unsigned>();
+    for (unsigned i = 0; i < l; ++i) {
+        html_vector.push_back(htmls[i].as<std::string>());
+    }
+
+    // A single format/options value applies to every item.
+    std::vector<RenderFormat> format_vector;
+    if (formats.isArray()) {
+        auto fl = formats["length"].as<unsigned>();
+        for (unsigned i = 0; i < fl; ++i) {
+            format_vector.push_back((RenderFormat)formats[i].as<int>());
+        }
+    } else {
+        format_vector.push_back((RenderFormat)formats.as<int>());
+    }
+
+    std::vector<RenderOptions> options_vector;
+    if (options_list.isArray()) {
+        auto ol = options_list["length"].as<unsigned>();
+        for (unsigned i = 0; i < ol; ++i) {
+            RenderOptions options;
+            parse_options(options, options_list[i]);
+            options_vector.push_back(std::move(options));
+        }
+    } else if (!options_list.isUndefined() && !options_list.isNull()) {
+        RenderOptions options;
+        parse_options(options, options_list);
+        options_vector.push_back(std::move(options));
+    }
+
+    const auto& outputs =
+        api_render_batch(inst, html_vector, width, height, format_vector, options_vector);
+    val result = val::array();
+    for (const auto& data : outputs) {
+        if (data && data->size() > 0) {
+            result.call<void>("push", val(typed_memory_view(data->size(), data->bytes())));
+        } else {
+            result.call<void>("push", val::null());
+        }
+    }
+    return result;
+}
+
+// Hands output to JS through one reusable buffer: `on_chunk` receives a view of the buffer
+// each time it fills and must copy or consume it before returning.
+class JsChunkStream : public SkWStream {
+   public:
+    JsChunkStream(val on_chunk, size_t chunk_size) : m_onChunk(on_chunk), m_buffer(chunk_size) {}
+
+    bool write(const void* buffer, size_t size) override {
+        const uint8_t* p = (const uint8_t*)buffer;
+        m_written += size;
+        while (size > 0) {
+            size_t n = std::min(size, m_buffer.size() - m_used);
+            memcpy(m_buffer.data() + m_used, p, n);
+            m_used += n;
+            p += n;
+            size -= n;
+            if (m_used == m_buffer.size()) flush();
+        }
+        return true;
+    }
+
+    void flush() override {
+        if (m_used == 0) return;
+        m_onChunk(val(typed_memory_view(m_used, m_buffer.data())));
+        m_used = 0;
+    }
+
+    size_t bytesWritten() const override { return m_written; }
+
+   private:
+    val m_onChunk;
+    std::vector<uint8_t> m_buffer;
+    size_t m_used = 0;
+    size_t m_written = 0;
+};
+
+double render_stream_val(SatoruInstance* inst, val htmls, int width, int height, int format,
+                         val options_val, val on_chunk) {
+    if (!inst) return -1;
+
+    std::vector<std::string> html_vector;
+    if (htmls.isArray()) {
+        auto l = htmls["length"].as<unsigned>();
+        for (unsigned i = 0; i < l; ++i) {
+            html_vector.push_back(htmls[i].as<std::string>());
+        }
+    } else {
+        html_vector.push_back(htmls.as<std::string>());
+    }
+
+    RenderOptions options;
+    parse_options(options, options_val);
+
+    JsChunkStream stream(on_chunk, 64 * 1024);
+    bool ok = api_render_to_stream(inst, html_vector, width, height, (RenderFormat)format, options,
+                                   &stream);
+    stream.flush();
+    return ok ? (double)stream.bytesWritten() : -1;
+}
+
 void add_resource_val(SatoruInstance* inst, std::string url, int type, val data) {
     if (!inst) return;
     auto vec = val_to_vector(data);
@@ -184,6 +326,11 @@ std::string get_collect_profile_val(SatoruInstance* inst) {
     return api_get_collect_profile(inst);
 }
 
+std::string get_document_stats_val(SatoruInstance* inst) {
+    if (!inst) return "{}";
+    return api_get_document_stats(inst);
+}
+
 void set_collect_profile_enabled_val(SatoruInstance* inst, bool enabled) {
     if (!inst) return;
     api_set_collect_profile_enabled(inst, enabled);
@@ -207,6 +354,24 @@ void layout_document_val(SatoruInstance* inst, int width) {
     api_layout_document(inst, width);
 }
 
+int patch_document_val(SatoruInstance* inst, val patches) {
+    if (!inst || !patches.isArray()) return 0;
+
+    std::vector<DocumentPatch> patch_vector;
+    auto l = patches["length"].as<unsigned>();
+    for (unsigned i = 0; i < l; ++i) {
+        val patch_val = patches[i];
+        DocumentPatch patch;
+        patch.selector = patch_val["selector"].as<std::string>();
+        if (patch_val.hasOwnProperty("attribute")) {
+            patch.attribute = patch_val["attribute"].as<std::string>();
+        }
+        patch.value = patch_val["value"].as<std::string>();
+        patch_vector.push_back(std::move(patch));
+    }
+    return api_patch_document(inst, patch_vector);
+}
+
 val render_from_state_val(SatoruInstance* inst, int width, int height, int format,
                           val options_val) {
     if (!inst) return val::null();
@@ -263,9 +428,13 @@ EMSCRIPTEN_BINDINGS(satoru) {
     function("create_instance", &create_instance, allow_raw_pointers());
     function("destroy_instance", &destroy_instance, allow_raw_pointers());
     function("render", &render_val, allow_raw_pointers());
+    function("render_formats", &render_formats_val, allow_raw_pointers());
+    function("render_batch", &render_batch_val, allow_raw_pointers());
+    function("render_stream", &render_stream_val, allow_raw_pointers());
     function("collect_resources", &collect_resources_val, allow_raw_pointers());
     function("get_collect_profile", &get_collect_profile_val, allow_raw_pointers());
     function("set_collect_profile_enabled", &set_collect_profile_enabled_val, allow_raw_pointers());
+    function("get_document_stats", &get_document_stats_val, allow_raw_pointers());
     function("get_pending_resources", &get_pending_resources_val, allow_raw_pointers());
     function("get_font_diagnostics", &get_font_diagnostics_val, allow_raw_pointers());
     function("add_resource", &add_resource_val, allow_raw_pointers());
@@ -279,6 +448,7 @@ EMSCRIPTEN_BINDINGS(satoru) {
 
     function("init_document", &init_document_val, allow_raw_pointers());
     function("layout_document", &layout_document_val, allow_raw_pointers());
+    function("patch_document", &patch_document_val, allow_raw_pointers());
     function("render_from_state", &render_from_state_val, allow_raw_pointers());
     function("merge_pdfs", &merge_pdfs_val, allow_raw_pointers());
 }
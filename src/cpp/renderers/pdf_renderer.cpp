@@ -1,7 +1,9 @@
 #include "pdf_renderer.h"
 
-#include <litehtml/master_css.h>
+#include <litehtml/pagination.h>
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -42,8 +44,8 @@ std::string replace_template_vars(std::string html, int pageNum, int totalPages)
 }
 
 void render_template(const std::string& html, int width, int height, SkCanvas* canvas,
-                     SatoruContext& context, const char* master_css, const char* user_css,
-                     litehtml::media_type media_type) {
+                     SatoruContext& context, litehtml::shared_stylesheet& master_css,
+                     litehtml::shared_stylesheet& user_css, litehtml::media_type media_type) {
     if (html.empty()) return;
     container_skia container(width, height, canvas, context, nullptr, false, media_type);
     auto doc = litehtml::document::createFromString(html.c_str(), &container, master_css, user_css);
@@ -53,13 +55,79 @@ void render_template(const std::string& html, int width, int height, SkCanvas* c
         container.flush();
     }
 }
+
+// A header or footer template. One without {{pageNumber}} or {{totalPages}} looks the same on
+// every page, so it is laid out once and drawn again for each page.
+class PageTemplate {
+   public:
+    PageTemplate(const std::string& html, int width, int height, SatoruContext& context,
+                 litehtml::shared_stylesheet& master_css, litehtml::shared_stylesheet& user_css,
+                 litehtml::media_type media_type)
+        : m_html(html),
+          m_width(width),
+          m_height(height),
+          m_context(context),
+          m_master_css(master_css),
+          m_user_css(user_css),
+          m_media_type(media_type),
+          m_static(html.find("{{pageNumber}}") == std::string::npos &&
+                   html.find("{{totalPages}}") == std::string::npos) {}
+
+    void draw(SkCanvas* canvas, int pageNum, int totalPages) {
+        if (m_html.empty()) return;
+        if (!m_static) {
+            render_template(replace_template_vars(m_html, pageNum, totalPages), m_width, m_height,
+                            canvas, m_context, m_master_css, m_user_css, m_media_type);
+            return;
+        }
+        if (!m_container) {
+            m_container = std::make_unique<container_skia>(m_width, m_height, nullptr, m_context,
+                                                           nullptr, false, m_media_type);
+            m_doc = litehtml::document::createFromString(m_html.c_str(), m_container.get(),
+                                                         m_master_css, m_user_css);
+            if (m_doc) m_doc->render(m_width);
+        }
+        if (!m_doc) return;
+        m_container->reset();
+        m_container->set_canvas(canvas);
+        m_doc->draw(0, 0, 0, nullptr);
+        m_container->flush();
+    }
+
+   private:
+    std::string m_html;
+    int m_width;
+    int m_height;
+    SatoruContext& m_context;
+    litehtml::shared_stylesheet& m_master_css;
+    litehtml::shared_stylesheet& m_user_css;
+    litehtml::media_type m_media_type;
+    bool m_static;
+    // Declared before m_doc so the document is destroyed first
+    std::unique_ptr<container_skia> m_container;
+    litehtml::document::ptr m_doc;
+};
+
+struct PaginatedDocument {
+    std::unique_ptr<container_skia> container;
+    litehtml::document::ptr doc;
+    // Document offset each page starts at
+    std::vector<litehtml::pixel_t> page_tops;
+};
 }  // namespace
 
 sk_sp<SkData> renderDocumentToPdf(SatoruInstance* inst, int width, int height,
                                   const RenderOptions& options) {
+    SkDynamicMemoryWStream stream;
+    if (!renderDocumentToPdf(inst, width, height, options, &stream)) return nullptr;
+    return stream.detachAsData();
+}
+
+bool renderDocumentToPdf(SatoruInstance* inst, int width, int height, const RenderOptions& options,
+                         SkWStream* out) {
     if (!inst->doc || !inst->render_container) {
         SATORU_LOG_ERROR("[Satoru] renderDocumentToPdf FAILED: null doc/container");
-        return nullptr;
+        return false;
     }
 
     int content_width = width;
@@ -74,7 +142,6 @@ sk_sp<SkData> renderDocumentToPdf(SatoruInstance* inst, int width, int height,
     int out_width = options.outputWidth > 0 ? options.outputWidth : src_w;
     int out_height = options.outputHeight > 0 ? options.outputHeight : src_h;
 
-    SkDynamicMemoryWStream stream;
     SkPDF::Metadata metadata;
     metadata.fTitle = options.pdfTitle.empty() ? "Satoru PDF Export" : options.pdfTitle.c_str();
     metadata.fAuthor = options.pdfAuthor.c_str();
@@ -85,8 +152,8 @@ sk_sp<SkData> renderDocumentToPdf(SatoruInstance* inst, int width, int height,
     metadata.jpegDecoder = PdfJpegDecoder;
     metadata.jpegEncoder = PdfJpegEncoder;
 
-    auto pdf_doc = SkPDF::MakeDocument(&stream, metadata);
-    if (!pdf_doc) return nullptr;
+    auto pdf_doc = SkPDF::MakeDocument(out, metadata);
+    if (!pdf_doc) return false;
 
     SkCanvas* canvas = pdf_doc->beginPage((SkScalar)out_width, (SkScalar)out_height);
     if (canvas) {
@@ -114,15 +181,26 @@ sk_sp<SkData> renderDocumentToPdf(SatoruInstance* inst, int width, int height,
         pdf_doc->endPage();
     }
     pdf_doc->close();
-    return stream.detachAsData();
+    return true;
 }
 
 sk_sp<SkData> renderHtmlsToPdf(const std::vector<std::string>& htmls, int width, int height,
-                               SatoruContext& context, const char* master_css, const char* user_css,
+                               SatoruContext& context, litehtml::shared_stylesheet& master_css,
+                               litehtml::shared_stylesheet& user_css,
                                const RenderOptions& options) {
-    if (htmls.empty()) return nullptr;
-
     SkDynamicMemoryWStream stream;
+    if (!renderHtmlsToPdf(htmls, width, height, context, master_css, user_css, options, &stream)) {
+        return nullptr;
+    }
+    return stream.detachAsData();
+}
+
+bool renderHtmlsToPdf(const std::vector<std::string>& htmls, int width, int height,
+                      SatoruContext& context, litehtml::shared_stylesheet& master_css,
+                      litehtml::shared_stylesheet& user_css, const RenderOptions& options,
+                      SkWStream* out) {
+    if (htmls.empty()) return false;
+
     SkPDF::Metadata metadata;
     metadata.fTitle = options.pdfTitle.empty() ? "Satoru PDF Export" : options.pdfTitle.c_str();
     metadata.fAuthor = options.pdfAuthor.c_str();
@@ -133,89 +211,128 @@ sk_sp<SkData> renderHtmlsToPdf(const std::vector<std::string>& htmls, int width,
     metadata.jpegDecoder = PdfJpegDecoder;
     metadata.jpegEncoder = PdfJpegEncoder;
 
-    auto pdf_doc = SkPDF::MakeDocument(&stream, metadata);
-    if (!pdf_doc) return nullptr;
+    auto pdf_doc = SkPDF::MakeDocument(out, metadata);
+    if (!pdf_doc) return false;
 
-    std::string css = master_css ? master_css : litehtml::master_css;
-    css += "\nbr { display: -litehtml-br !important; }\n";
+    litehtml::media_type media_type =
+        (options.mediaType == 1) ? litehtml::media_type_print : litehtml::media_type_screen;
 
-    int pageNum = 1;
-    int totalPages = (int)htmls.size();
+    int margin_top = options.pdfMarginTop;
+    int margin_bottom = options.pdfMarginBottom;
+    int margin_left = options.pdfMarginLeft;
+    int margin_right = options.pdfMarginRight;
 
-    for (const auto& html : htmls) {
-        // Measure pass
-        litehtml::media_type media_type =
-            (options.mediaType == 1) ? litehtml::media_type_print : litehtml::media_type_screen;
-
-        int margin_top = options.pdfMarginTop;
-        int margin_bottom = options.pdfMarginBottom;
-        int margin_left = options.pdfMarginLeft;
-        int margin_right = options.pdfMarginRight;
-
-        int content_width = width - margin_left - margin_right;
-        if (content_width < 1) content_width = 1;
-
-        container_skia measure_container(content_width, height > 0 ? height : 3000, nullptr,
-                                         context, nullptr, false, media_type);
-        auto measure_doc = litehtml::document::createFromString(html.c_str(), &measure_container,
-                                                                css.c_str(), user_css);
-        if (!measure_doc) continue;
-
-        measure_doc->render(content_width);
+    int content_width = width - margin_left - margin_right;
+    if (content_width < 1) content_width = 1;
 
-        int measured_height = (height > 0) ? height : (int)measure_doc->height();
-        int full_page_height = measured_height + margin_top + margin_bottom;
-        if (full_page_height < 1) full_page_height = 1;
+    PageTemplate header(options.pdfHeader, content_width, margin_top, context, master_css,
+                        user_css, media_type);
+    PageTemplate footer(options.pdfFooter, content_width, margin_bottom, context, master_css,
+                        user_css, media_type);
 
-        SkCanvas* canvas = pdf_doc->beginPage((SkScalar)width, (SkScalar)full_page_height);
-        if (!canvas) continue;
+    // Draws the page background, header and footer, then calls draw_content with the canvas
+    // translated to the content area.
+    auto draw_page = [&](int page_height, int pageNum, int totalPages,
+                         const std::function<void(SkCanvas*)>& draw_content) {
+        SkCanvas* canvas = pdf_doc->beginPage((SkScalar)width, (SkScalar)page_height);
+        if (!canvas) return;
 
         if (options.backgroundColor != 0) {
             SkPaint paint;
             paint.setColor(options.backgroundColor);
-            canvas->drawRect(SkRect::MakeWH(width, full_page_height), paint);
+            canvas->drawRect(SkRect::MakeWH(width, page_height), paint);
         }
 
-        // Render Header
-        if (!options.pdfHeader.empty()) {
-            std::string headerHtml = replace_template_vars(options.pdfHeader, pageNum, totalPages);
-            canvas->save();
-            canvas->translate((SkScalar)margin_left, 0);
-            render_template(headerHtml, content_width, margin_top, canvas, context, css.c_str(),
-                            user_css, media_type);
-            canvas->restore();
-        }
+        canvas->save();
+        canvas->translate((SkScalar)margin_left, 0);
+        header.draw(canvas, pageNum, totalPages);
+        canvas->restore();
 
-        // Render Footer
-        if (!options.pdfFooter.empty()) {
-            std::string footerHtml = replace_template_vars(options.pdfFooter, pageNum, totalPages);
-            canvas->save();
-            canvas->translate((SkScalar)margin_left, (SkScalar)(full_page_height - margin_bottom));
-            render_template(footerHtml, content_width, margin_bottom, canvas, context, css.c_str(),
-                            user_css, media_type);
-            canvas->restore();
-        }
+        canvas->save();
+        canvas->translate((SkScalar)margin_left, (SkScalar)(page_height - margin_bottom));
+        footer.draw(canvas, pageNum, totalPages);
+        canvas->restore();
 
-        // Render Content
         canvas->save();
         canvas->translate((SkScalar)margin_left, (SkScalar)margin_top);
-
-        container_skia render_container(content_width, measured_height, canvas, context, nullptr,
-                                        false, media_type);
-        auto render_doc = litehtml::document::createFromString(html.c_str(), &render_container,
-                                                               css.c_str(), user_css);
-        if (!render_doc) continue;
-        render_doc->render(content_width);
-        render_doc->draw(0, 0, 0, nullptr);
-        render_container.flush();
-
+        draw_content(canvas);
         canvas->restore();
 
         pdf_doc->endPage();
-        pageNum++;
+    };
+
+    if (options.pdfPageHeight > 0) {
+        // Paginated: every document is laid out once and split into pages of the same size.
+        // All of them are laid out before drawing, since {{totalPages}} counts all pages.
+        int page_height = options.pdfPageHeight;
+        int content_height = page_height - margin_top - margin_bottom;
+        if (content_height < 1) content_height = 1;
+
+        std::vector<PaginatedDocument> docs;
+        docs.reserve(htmls.size());
+        int totalPages = 0;
+        for (const auto& html : htmls) {
+            PaginatedDocument pd;
+            pd.container = std::make_unique<container_skia>(content_width, content_height, nullptr,
+                                                            context, nullptr, false, media_type);
+            pd.doc = litehtml::document::createFromString(html.c_str(), pd.container.get(),
+                                                          master_css, user_css);
+            if (!pd.doc) continue;
+            pd.doc->render(content_width);
+            pd.page_tops =
+                litehtml::paginate(pd.doc->root_render(), content_height, pd.doc->height());
+            totalPages += (int)pd.page_tops.size();
+            docs.push_back(std::move(pd));
+        }
+
+        int pageNum = 1;
+        for (auto& pd : docs) {
+            for (size_t i = 0; i < pd.page_tops.size(); i++) {
+                litehtml::pixel_t page_top = pd.page_tops[i];
+                // Content below the next page's start is drawn on that page, not this one
+                litehtml::pixel_t visible_height = content_height;
+                if (i + 1 < pd.page_tops.size()) {
+                    visible_height = std::min(visible_height, pd.page_tops[i + 1] - page_top);
+                }
+                draw_page(page_height, pageNum++, totalPages, [&](SkCanvas* canvas) {
+                    canvas->clipRect(SkRect::MakeWH((SkScalar)content_width, visible_height));
+                    pd.container->set_canvas(canvas);
+                    pd.container->set_height(content_height);
+                    litehtml::position clip(0, 0, content_width, visible_height);
+                    pd.doc->draw(0, 0, -page_top, &clip);
+                    pd.container->flush();
+                });
+            }
+        }
+    } else {
+        int pageNum = 1;
+        int totalPages = (int)htmls.size();
+
+        for (const auto& html : htmls) {
+            // Lay the page out once without a canvas; the same document is drawn into the PDF
+            // page once its height is known.
+            container_skia container(content_width, height > 0 ? height : 3000, nullptr, context,
+                                     nullptr, false, media_type);
+            auto doc = litehtml::document::createFromString(html.c_str(), &container, master_css,
+                                                            user_css);
+            if (!doc) continue;
+
+            doc->render(content_width);
+
+            int measured_height = (height > 0) ? height : (int)doc->height();
+            int full_page_height = measured_height + margin_top + margin_bottom;
+            if (full_page_height < 1) full_page_height = 1;
+
+            draw_page(full_page_height, pageNum, totalPages, [&](SkCanvas* canvas) {
+                container.set_canvas(canvas);
+                container.set_height(measured_height);
+                doc->draw(0, 0, 0, nullptr);
+                container.flush();
+            });
+            pageNum++;
+        }
     }
 
     pdf_doc->close();
-
-    return stream.detachAsData();
+    return true;
 }
@@ -1,18 +1,29 @@
 #ifndef PDF_RENDERER_H
 #define PDF_RENDERER_H
 
+#include <litehtml/stylesheet.h>
+
 #include <string>
 #include <vector>
 
 #include "core/satoru_context.h"
 #include "include/core/SkData.h"
+#include "include/core/SkStream.h"
 
 struct SatoruInstance;
 sk_sp<SkData> renderDocumentToPdf(SatoruInstance* inst, int width, int height,
                                   const RenderOptions& options);
+bool renderDocumentToPdf(SatoruInstance* inst, int width, int height, const RenderOptions& options,
+                         SkWStream* out);
 
 sk_sp<SkData> renderHtmlsToPdf(const std::vector<std::string>& htmls, int width, int height,
-                               SatoruContext& context, const char* master_css, const char* user_css,
+                               SatoruContext& context, litehtml::shared_stylesheet& master_css,
+                               litehtml::shared_stylesheet& user_css,
                                const RenderOptions& options);
+// Each page is written to out as soon as it is finished.
+bool renderHtmlsToPdf(const std::vector<std::string>& htmls, int width, int height,
+                      SatoruContext& context, litehtml::shared_stylesheet& master_css,
+                      litehtml::shared_stylesheet& user_css, const RenderOptions& options,
+                      SkWStream* out);
 
 #endif  // PDF_RENDERER_H
@@ -1,6 +1,7 @@
 #include "png_renderer.h"
 
-#include <litehtml/master_css.h>
+#include <algorithm>
+#include <cmath>
 
 #include "api/satoru_api.h"
 #include "core/container_skia.h"
@@ -12,74 +13,165 @@
 #include "include/encode/SkPngEncoder.h"
 #include "render_utils.h"
 #include "utils/logging.h"
+#include "utils/png_row_encoder.h"
+
+namespace {
+
+// Output rows drawn per band when a tall raster is encoded strip by strip.
+constexpr int kBandRows = 512;
+// Outputs above this many pixels (64 MiB as N32) are drawn and encoded band by band.
+constexpr int64_t kBandedPixelThreshold = 16 * 1024 * 1024;
+
+struct RasterGeometry {
+    int content_height;
+    int src_x, src_y, src_w, src_h;
+    int out_width, out_height;
+};
+
+RasterGeometry raster_geometry(SatoruInstance* inst, int width, int height,
+                               const RenderOptions& options) {
+    RasterGeometry g;
+    g.content_height = (height > 0) ? height : (int)inst->doc->height();
+    if (g.content_height < 1) g.content_height = 1;
+
+    g.src_x = options.cropX;
+    g.src_y = options.cropY;
+    g.src_w = options.cropWidth > 0 ? options.cropWidth : width;
+    g.src_h = options.cropHeight > 0 ? options.cropHeight : g.content_height;
+
+    g.out_width = options.outputWidth > 0 ? options.outputWidth : g.src_w;
+    g.out_height = options.outputHeight > 0 ? options.outputHeight : g.src_h;
+    return g;
+}
 
-sk_sp<SkData> renderDocumentToPng(SatoruInstance* inst, int width, int height,
-                                  const RenderOptions& options) {
-    if (!inst->doc || !inst->render_container) {
-        SATORU_LOG_ERROR("[Satoru] renderDocumentToPng FAILED: null doc/container");
-        return nullptr;
+// Points the container at canvas, re-laying out first if the media type changed.
+void prepare_container(SatoruInstance* inst, int width, const RasterGeometry& g,
+                       const RenderOptions& options, SkCanvas* canvas) {
+    inst->render_container->reset();
+    inst->render_container->set_canvas(canvas);
+    inst->render_container->set_height(g.content_height);
+    inst->render_container->set_tagging(false);
+
+    litehtml::media_type media_type =
+        (options.mediaType == 1) ? litehtml::media_type_print : litehtml::media_type_screen;
+    if (inst->render_container->get_media_type() != media_type) {
+        inst->render_container->set_media_type(media_type);
+        inst->doc->media_changed();
+        inst->doc->render(width);
     }
+}
 
-    int content_width = width;
-    int content_height = (height > 0) ? height : (int)inst->doc->height();
-    if (content_height < 1) content_height = 1;
+// Draws output rows [band_y, band_y + band.height()) of the document into band. Only the
+// elements that intersect the band's source rows are visited.
+void draw_band(SatoruInstance* inst, int width, const RasterGeometry& g,
+               const RenderOptions& options, int band_y, SkBitmap& band) {
+    band.eraseColor(options.backgroundColor);
 
-    int src_x = options.cropX;
-    int src_y = options.cropY;
-    int src_w = options.cropWidth > 0 ? options.cropWidth : content_width;
-    int src_h = options.cropHeight > 0 ? options.cropHeight : content_height;
+    SkCanvas canvas(band);
+    canvas.translate(0, (SkScalar)-band_y);
+    if (options.outputWidth > 0 || options.outputHeight > 0) {
+        apply_resize_transform(&canvas, g.src_w, g.src_h, options);
+    }
 
-    int out_width = options.outputWidth > 0 ? options.outputWidth : src_w;
-    int out_height = options.outputHeight > 0 ? options.outputHeight : src_h;
+    prepare_container(inst, width, g, options, &canvas);
 
-    SkImageInfo info = SkImageInfo::MakeN32Premul(out_width, out_height, SkColorSpace::MakeSRGB());
-    SkBitmap bitmap;
+    SkRect local = canvas.getLocalClipBounds();
+    int top = std::max(0, (int)std::floor(local.top()));
+    int bottom = std::min(g.src_h, (int)std::ceil(local.bottom()));
+    litehtml::position clip(0, top, g.src_w, std::max(0, bottom - top));
+    inst->doc->draw(0, -g.src_x, -g.src_y, &clip);
+    inst->render_container->flush();
+}
+
+}  // namespace
+
+bool renderDocumentToBitmap(SatoruInstance* inst, int width, int height,
+                            const RenderOptions& options, SkBitmap& bitmap) {
+    if (!inst->doc || !inst->render_container) {
+        SATORU_LOG_ERROR("[Satoru] renderDocumentToBitmap FAILED: null doc/container");
+        return false;
+    }
+
+    RasterGeometry g = raster_geometry(inst, width, height, options);
+
+    SkImageInfo info =
+        SkImageInfo::MakeN32Premul(g.out_width, g.out_height, SkColorSpace::MakeSRGB());
     bitmap.allocPixels(info);
     bitmap.eraseColor(options.backgroundColor);
 
     SkCanvas canvas(bitmap);
 
     if (options.outputWidth > 0 || options.outputHeight > 0) {
-        apply_resize_transform(&canvas, src_w, src_h, options);
+        apply_resize_transform(&canvas, g.src_w, g.src_h, options);
     }
 
-    inst->render_container->reset();
-    inst->render_container->set_canvas(&canvas);
-    inst->render_container->set_height(content_height);
-    inst->render_container->set_tagging(false);
+    prepare_container(inst, width, g, options, &canvas);
 
-    litehtml::media_type media_type =
-        (options.mediaType == 1) ? litehtml::media_type_print : litehtml::media_type_screen;
-    if (inst->render_container->get_media_type() != media_type) {
-        inst->render_container->set_media_type(media_type);
-        inst->doc->media_changed();
-        inst->doc->render(width);
+    litehtml::position clip(0, 0, g.src_w, g.src_h);
+    inst->doc->draw(0, -g.src_x, -g.src_y, &clip);
+    inst->render_container->flush();
+    return true;
+}
+
+bool renderDocumentToPng(SatoruInstance* inst, int width, int height,
+                         const RenderOptions& options, SkWStream* out) {
+    if (!inst->doc || !inst->render_container) {
+        SATORU_LOG_ERROR("[Satoru] renderDocumentToPng FAILED: null doc/container");
+        return false;
     }
 
-    litehtml::position clip(0, 0, src_w, src_h);
-    inst->doc->draw(0, -src_x, -src_y, &clip);
-    inst->render_container->flush();
+    RasterGeometry g = raster_geometry(inst, width, height, options);
+    if ((int64_t)g.out_width * g.out_height <= kBandedPixelThreshold) {
+        SkBitmap bitmap;
+        return renderDocumentToBitmap(inst, width, height, options, bitmap) &&
+               encodePng(bitmap, out);
+    }
 
+    satoru::PngRowEncoder encoder;
+    if (!encoder.begin(out, g.out_width, g.out_height)) return false;
+
+    SkBitmap band;
+    band.allocPixels(SkImageInfo::MakeN32Premul(
+        g.out_width, std::min(kBandRows, g.out_height), SkColorSpace::MakeSRGB()));
+    for (int band_y = 0; band_y < g.out_height; band_y += kBandRows) {
+        draw_band(inst, width, g, options, band_y, band);
+        SkPixmap rows;
+        band.pixmap().extractSubset(
+            &rows, SkIRect::MakeWH(g.out_width, std::min(kBandRows, g.out_height - band_y)));
+        if (!encoder.writeRows(rows)) return false;
+    }
+    return encoder.finish();
+}
+
+sk_sp<SkData> encodePng(const SkBitmap& bitmap) {
     SkDynamicMemoryWStream stream;
-    if (SkPngEncoder::Encode(&stream, bitmap.pixmap(), {})) {
+    if (encodePng(bitmap, &stream)) {
         return stream.detachAsData();
     }
     return nullptr;
 }
 
+bool encodePng(const SkBitmap& bitmap, SkWStream* out) {
+    return SkPngEncoder::Encode(out, bitmap.pixmap(), {});
+}
+
+sk_sp<SkData> renderDocumentToPng(SatoruInstance* inst, int width, int height,
+                                  const RenderOptions& options) {
+    SkDynamicMemoryWStream stream;
+    if (!renderDocumentToPng(inst, width, height, options, &stream)) return nullptr;
+    return stream.detachAsData();
+}
+
 sk_sp<SkData> renderHtmlToPng(const char* html, int width, int height, SatoruContext& context,
-                              const char* master_css, const char* user_css,
-                              const RenderOptions& options) {
+                              litehtml::shared_stylesheet& master_css,
+                              litehtml::shared_stylesheet& user_css, const RenderOptions& options) {
     int initial_height = (height > 0) ? height : 3000;
     litehtml::media_type media_type =
         (options.mediaType == 1) ? litehtml::media_type_print : litehtml::media_type_screen;
     container_skia container(width, initial_height, nullptr, context, nullptr, false, media_type);
 
-    std::string css = master_css ? master_css : litehtml::master_css;
-    css += "\nbr { display: -litehtml-br !important; }\n";
-
     litehtml::document::ptr doc =
-        litehtml::document::createFromString(html, &container, css.c_str(), user_css);
+        litehtml::document::createFromString(html, &container, master_css, user_css);
     if (!doc) return nullptr;
 
     doc->render(width);
@@ -113,10 +205,5 @@ sk_sp<SkData> renderHtmlToPng(const char* html, int width, int height, SatoruCon
     doc->draw(0, -src_x, -src_y, &clip);
     container.flush();
 
-    SkDynamicMemoryWStream stream;
-    if (SkPngEncoder::Encode(&stream, bitmap.pixmap(), {})) {
-        return stream.detachAsData();
-    }
-
-    return nullptr;
+    return encodePng(bitmap);
 }
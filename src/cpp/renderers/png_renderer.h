@@ -1,15 +1,30 @@
 #ifndef PNG_RENDERER_H
 #define PNG_RENDERER_H
 
+#include <litehtml/stylesheet.h>
+
 #include "core/satoru_context.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkData.h"
+#include "include/core/SkStream.h"
 
 struct SatoruInstance;
+// Draws the retained document into a freshly allocated bitmap sized by the crop/output options.
+bool renderDocumentToBitmap(SatoruInstance* inst, int width, int height,
+                            const RenderOptions& options, SkBitmap& bitmap);
+sk_sp<SkData> encodePng(const SkBitmap& bitmap);
+// Encodes straight into out; rows are written as they are compressed.
+bool encodePng(const SkBitmap& bitmap, SkWStream* out);
+
 sk_sp<SkData> renderDocumentToPng(SatoruInstance* inst, int width, int height,
                                   const RenderOptions& options);
+// Large outputs are drawn and encoded in horizontal bands, so only one band of pixels is
+// allocated at a time instead of the whole bitmap.
+bool renderDocumentToPng(SatoruInstance* inst, int width, int height,
+                         const RenderOptions& options, SkWStream* out);
 
 sk_sp<SkData> renderHtmlToPng(const char* html, int width, int height, SatoruContext& context,
-                              const char* master_css, const char* user_css,
-                              const RenderOptions& options);
+                              litehtml::shared_stylesheet& master_css,
+                              litehtml::shared_stylesheet& user_css, const RenderOptions& options);
 
 #endif  // PNG_RENDERER_H
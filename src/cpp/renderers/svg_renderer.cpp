@@ -1,9 +1,9 @@
 #include "svg_renderer.h"
 
-#include <litehtml/master_css.h>
 #include <litehtml/render_item.h>
 
 #include <cstdio>
+#include <cstring>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -13,6 +13,9 @@
 #include "api/satoru_api.h"
 #include "bridge/magic_tags.h"
 #include "core/container_skia.h"
+#include "include/codec/SkCodec.h"
+#include "include/codec/SkEncodedImageFormat.h"
+#include "include/codec/SkEncodedOrigin.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
@@ -26,6 +29,7 @@
 #include "include/svg/SkSVGCanvas.h"
 #include "include/utils/SkParsePath.h"
 #include "render_utils.h"
+#include "utils/image_decoder.h"
 #include "utils/logging.h"
 #include "utils/skia_utils.h"
 
@@ -42,6 +46,75 @@ static std::string bitmapToDataUrl(const SkBitmap& bitmap) {
     return "data:image/png;base64," + base64_encode((const uint8_t*)data->data(), data->size());
 }
 
+static const char* embeddableMimeType(const sk_sp<SkData>& encoded) {
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(encoded);
+    // The decoded pixels ignore EXIF orientation, so rotated sources are re-encoded to match.
+    if (!codec || codec->getOrigin() != kTopLeft_SkEncodedOrigin) return nullptr;
+    switch (codec->getEncodedFormat()) {
+        case SkEncodedImageFormat::kPNG:
+            return "image/png";
+        case SkEncodedImageFormat::kJPEG:
+            return "image/jpeg";
+        case SkEncodedImageFormat::kWEBP:
+            return "image/webp";
+        default:
+            return nullptr;
+    }
+}
+
+// data: URLs are embedded as given. Other images go through the context's data URL cache:
+// PNG/JPEG/WebP sources embed their original bytes, anything else is encoded to PNG once from
+// a transient decode.
+static bool imageToDataUrl(SatoruContext& context, const std::string& url, std::string& out) {
+    auto it = context.imageCache.find(url);
+    if (it == context.imageCache.end() || (!it->second.skImage && !it->second.encoded)) {
+        return false;
+    }
+    image_info& info = it->second;
+    if (!info.data_url.empty() && info.data_url.substr(0, 5) == "data:") {
+        out = info.data_url;
+        return true;
+    }
+
+    // Hashed here rather than on load, so raster images that never reach an SVG skip it
+    if (info.encoded && info.content_hash == 0) {
+        info.content_hash = content_hash(info.encoded->bytes(), info.encoded->size());
+    }
+
+    auto& cache = context.cacheManager.imageDataUrlCache;
+    const uint64_t pixel_key = 1ULL << 63;
+    uint64_t key = info.encoded ? (info.content_hash & ~pixel_key)
+                                : (pixel_key | info.skImage->uniqueID());
+    if (std::string* cached = cache.get(key)) {
+        out = *cached;
+        return true;
+    }
+
+    if (info.encoded) {
+        if (const char* mime = embeddableMimeType(info.encoded)) {
+            out = std::string("data:") + mime + ";base64," +
+                  base64_encode(info.encoded->bytes(), info.encoded->size());
+            cache.put(key, out);
+            return true;
+        }
+    }
+
+    // The PNG is encoded once and cached above, so decode for it without keeping a
+    // natural-size SkImage in image_info (getImage would store it there).
+    sk_sp<SkImage> image = info.encoded ? satoru::ImageDecoder::decode_raster(
+                                              info.encoded, info.width, info.height)
+                                        : info.skImage;
+    if (!image) return false;
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(image->width(), image->height());
+    SkCanvas bitmapCanvas(bitmap);
+    bitmapCanvas.drawImage(image, 0, 0);
+    out = bitmapToDataUrl(bitmap);
+    if (out.empty()) return false;
+    cache.put(key, out);
+    return true;
+}
+
 static bool has_radius(const litehtml::border_radiuses& r) {
     return r.top_left_x > 0 || r.top_left_y > 0 || r.top_right_x > 0 || r.top_right_y > 0 ||
            r.bottom_right_x > 0 || r.bottom_right_y > 0 || r.bottom_left_x > 0 ||
@@ -344,8 +417,8 @@ static void processTextDraw(FastTag& info, std::string& out, const text_draw_inf
     out.append(">");
 }
 
-static std::string generateDefs(const container_skia& render_container,
-                                const SatoruContext& context, const RenderOptions& options) {
+static std::string generateDefs(const container_skia& render_container, SatoruContext& context,
+                                const RenderOptions& options) {
     std::stringstream defs;
 
     if (!options.svgTextToPaths) {
@@ -460,19 +533,8 @@ static std::string generateDefs(const container_skia& render_container,
             defs << "</clipPath>";
         }
         if (draw.layer.repeat != litehtml::background_repeat_no_repeat) {
-            auto it = context.imageCache.find(draw.url);
-            if (it != context.imageCache.end() && it->second.skImage) {
-                std::string dataUrl;
-                if (!it->second.data_url.empty() && it->second.data_url.substr(0, 5) == "data:") {
-                    dataUrl = it->second.data_url;
-                } else {
-                    SkBitmap bitmap;
-                    bitmap.allocN32Pixels(it->second.skImage->width(),
-                                          it->second.skImage->height());
-                    SkCanvas bitmapCanvas(bitmap);
-                    bitmapCanvas.drawImage(it->second.skImage, 0, 0);
-                    dataUrl = bitmapToDataUrl(bitmap);
-                }
+            std::string dataUrl;
+            if (imageToDataUrl(context, draw.url, dataUrl)) {
 
                 float pW = (float)draw.layer.origin_box.width;
                 float pH = (float)draw.layer.origin_box.height;
@@ -530,7 +592,7 @@ static std::string generateDefs(const container_skia& render_container,
         std::string currentIn = "SourceGraphic";
         int resIdx = 0;
 
-        for (const auto& tok : f.tokens) {
+        for (const auto& tok : f.filter->tokens) {
             if (tok.type == litehtml::CV_FUNCTION) {
                 std::string name = litehtml::lowcase(tok.name);
                 auto args = litehtml::parse_comma_separated_list(tok.value);
@@ -628,7 +690,7 @@ static std::string generateDefs(const container_skia& render_container,
         std::string currentIn = "SourceGraphic";
         int resIdx = 0;
 
-        for (const auto& tok : f.tokens) {
+        for (const auto& tok : f.filter->tokens) {
             if (tok.type == litehtml::CV_FUNCTION) {
                 std::string name = litehtml::lowcase(tok.name);
                 auto args = litehtml::parse_comma_separated_list(tok.value);
@@ -812,7 +874,7 @@ static std::string generateDefs(const container_skia& render_container,
         const auto& cp = clipPaths[i];
         int index = (int)(i + 1);
         defs << "<clipPath id=\"adv-clip-path-" << index << "\">";
-        SkPath path = container_skia::parse_clip_path(cp.tokens, cp.pos);
+        SkPath path = container_skia::clip_path_shape(context, *cp.clip_path, cp.pos);
         SkString svgPath = SkParsePath::ToSVGString(path);
         defs << "<path d=\"" << svgPath.c_str() << "\" />";
         defs << "</clipPath>";
@@ -832,9 +894,8 @@ static std::string generateDefs(const container_skia& render_container,
              << "\" maskUnits=\"userSpaceOnUse\" mask-type=\"alpha\" x=\"" << m.pos.x << "\" y=\""
              << m.pos.y << "\" width=\"" << m.pos.width << "\" height=\"" << m.pos.height << "\">";
 
-        auto layers = litehtml::parse_comma_separated_list(m.tokens);
         int gradIdx = 0;
-        for (const auto& layer_tokens : layers) {
+        for (const auto& layer_tokens : m.mask->layers) {
             for (const auto& tok : layer_tokens) {
                 if (tok.type == litehtml::CV_FUNCTION) {
                     std::string name = litehtml::lowcase(tok.name);
@@ -848,21 +909,9 @@ static std::string generateDefs(const container_skia& render_container,
                         }
                         bool imageFound = false;
                         if (!url.empty()) {
-                            auto it = context.imageCache.find(url);
-                            if (it != context.imageCache.end() && it->second.skImage) {
+                            std::string dataUrl;
+                            if (imageToDataUrl(context, url, dataUrl)) {
                                 imageFound = true;
-                                std::string dataUrl;
-                                if (!it->second.data_url.empty() &&
-                                    it->second.data_url.substr(0, 5) == "data:") {
-                                    dataUrl = it->second.data_url;
-                                } else {
-                                    SkBitmap bitmap;
-                                    bitmap.allocN32Pixels(it->second.skImage->width(),
-                                                          it->second.skImage->height());
-                                    SkCanvas bitmapCanvas(bitmap);
-                                    bitmapCanvas.drawImage(it->second.skImage, 0, 0);
-                                    dataUrl = bitmapToDataUrl(bitmap);
-                                }
                                 defs << "<image x=\"" << m.pos.x << "\" y=\"" << m.pos.y
                                      << "\" width=\"" << m.pos.width << "\" height=\""
                                      << m.pos.height << "\" preserveAspectRatio=\"none\" href=\""
@@ -934,39 +983,130 @@ static std::string generateDefs(const container_skia& render_container,
     return defs.str();
 }
 
-static std::string finalizeSvg(std::string_view svg, SatoruContext& context,
-                               const container_skia& container, const RenderOptions& options) {
+// Rewrites SkSVGCanvas output while it is being written. Each tag is handled as soon as it is
+// complete: magic-color placeholders become the final elements right away, so the raw SVG is
+// never buffered or scanned a second time. Every placeholder is drawn after its entry is
+// recorded in the container, so the lookups below only see finished entries. <defs> need the
+// full draw and are inserted after the root <svg> tag by finish(). With a sink, finished output
+// is passed on in chunks instead and the <defs> are written just before the closing </svg>,
+// since the start of the document has already left.
+class SvgFinalizeStream : public SkWStream {
+    SatoruContext& context;
+    const container_skia& container;
+    const RenderOptions& options;
+
+    const std::vector<shadow_info>& shadows;
+    const std::vector<text_shadow_info>& textShadows;
+    const std::vector<image_draw_info>& images;
+    const std::vector<conic_gradient_info>& conics;
+    const std::vector<radial_gradient_info>& radials;
+    const std::vector<linear_gradient_info>& linears;
+    const std::vector<text_draw_info>& textDraws;
+    const std::vector<filter_info>& filters;
+    const std::vector<backdrop_filter_info>& backdropFilters;
+    const std::vector<border_image_info>& borderImages;
+
+    SkWStream* sink;
     std::string result;
-    result.reserve(svg.size() + svg.size() / 2 + 8192);
-
-    const auto& shadows = container.get_used_shadows();
-    const auto& textShadows = container.get_used_text_shadows();
-    const auto& images = container.get_used_image_draws();
-    const auto& conics = container.get_used_conic_gradients();
-    const auto& radials = container.get_used_radial_gradients();
-    const auto& linears = container.get_used_linear_gradients();
-    const auto& textDraws = container.get_used_text_draws();
-    const auto& filters = container.get_used_filters();
-    const auto& backdropFilters = container.get_used_backdrop_filters();
-    const auto& borderImages = container.get_used_border_images();
-
-    SvgScanner scanner(svg);
-    bool defsInjected = false;
+    std::string pendingTag;  // bytes of a tag that has not been closed yet
+    char quote = 0;
+    size_t written = 0;
+    size_t defsPos = std::string::npos;
+    int svgDepth = 0;  // open <svg> elements; inline SVG images nest inside the root one
+    bool sinkFailed = false;  // SkSVGCanvas drops write() results, so failures are kept here
     std::vector<TextClipBounds> active_text_clips;
 
-    while (!scanner.isAtEnd()) {
-        std::string_view text = scanner.scanTo('<');
-        result.append(text);
-        if (scanner.isAtEnd()) break;
+   public:
+    static constexpr size_t kSinkChunkSize = 64 * 1024;
+
+    SvgFinalizeStream(SatoruContext& context, const container_skia& container,
+                      const RenderOptions& options, SkWStream* sink = nullptr)
+        : context(context),
+          container(container),
+          options(options),
+          shadows(container.get_used_shadows()),
+          textShadows(container.get_used_text_shadows()),
+          images(container.get_used_image_draws()),
+          conics(container.get_used_conic_gradients()),
+          radials(container.get_used_radial_gradients()),
+          linears(container.get_used_linear_gradients()),
+          textDraws(container.get_used_text_draws()),
+          filters(container.get_used_filters()),
+          backdropFilters(container.get_used_backdrop_filters()),
+          borderImages(container.get_used_border_images()),
+          sink(sink) {
+        result.reserve(kSinkChunkSize);
+    }
+
+    bool write(const void* buffer, size_t size) override {
+        const char* p = (const char*)buffer;
+        const char* end = p + size;
+        written += size;
+        while (p < end) {
+            if (pendingTag.empty()) {
+                const char* lt = (const char*)memchr(p, '<', end - p);
+                if (!lt) {
+                    result.append(p, end - p);
+                    break;
+                }
+                result.append(p, lt - p);
+                pendingTag.push_back('<');
+                p = lt + 1;
+                continue;
+            }
+            char c = *p++;
+            pendingTag.push_back(c);
+            if (quote) {
+                if (c == quote) quote = 0;
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+            } else if (c == '>') {
+                SvgScanner scanner(pendingTag);
+                FastTag tag = scanner.parseTag();
+                processTag(tag);
+                pendingTag.clear();
+            }
+        }
+        if (sink && result.size() >= kSinkChunkSize) {
+            if (!sink->write(result.data(), result.size())) {
+                sinkFailed = true;
+                return false;
+            }
+            result.clear();
+        }
+        return true;
+    }
+
+    size_t bytesWritten() const override { return written; }
 
-        size_t tagStart = scanner.getPos();
-        FastTag tag = scanner.parseTag();
-        size_t tagEnd = scanner.getPos();
-        std::string_view rawTag = svg.substr(tagStart, tagEnd - tagStart);
+    // Returns the document, or an empty string once everything has been written to the sink.
+    std::string finish() {
+        result.append(pendingTag);
+        pendingTag.clear();
+        if (sink) {
+            if (!result.empty() && !sink->write(result.data(), result.size())) sinkFailed = true;
+            result.clear();
+            return result;
+        }
+        if (defsPos != std::string::npos) result.insert(defsPos, defs());
+        return std::move(result);
+    }
 
+    // False once a write to the sink has failed; the streamed document is then incomplete.
+    bool sinkOk() const { return !sinkFailed; }
+
+   private:
+    std::string defs() const {
+        std::string out = "<defs><!--SATORU_DEFS-->";
+        out += generateDefs(container, context, options);
+        out += "</defs>";
+        return out;
+    }
+
+    void processTag(FastTag& tag) {
         if (tag.name.empty() || tag.name[0] == '!' || tag.name[0] == '?') {
             serializeFastTag(result, tag);
-            continue;
+            return;
         }
 
         bool replaced = false;
@@ -1183,20 +1323,8 @@ static std::string finalizeSvg(std::string_view svg, SatoruContext& context,
                     case satoru::MagicTagExtended::ImageDraw:
                         if (fullIndex > 0 && fullIndex <= (int)images.size()) {
                             const auto& draw = images[fullIndex - 1];
-                            auto it = context.imageCache.find(draw.url);
-                            if (it != context.imageCache.end() && it->second.skImage) {
-                                std::string dataUrl;
-                                if (!it->second.data_url.empty() &&
-                                    it->second.data_url.substr(0, 5) == "data:") {
-                                    dataUrl = it->second.data_url;
-                                } else {
-                                    SkBitmap bitmap;
-                                    bitmap.allocN32Pixels(it->second.skImage->width(),
-                                                          it->second.skImage->height());
-                                    SkCanvas bitmapCanvas(bitmap);
-                                    bitmapCanvas.drawImage(it->second.skImage, 0, 0);
-                                    dataUrl = bitmapToDataUrl(bitmap);
-                                }
+                            std::string dataUrl;
+                            if (imageToDataUrl(context, draw.url, dataUrl)) {
                                 if (draw.layer.repeat == litehtml::background_repeat_no_repeat) {
                                     std::string preserveAspectRatio = "none";
                                     switch (draw.object_fit) {
@@ -1586,6 +1714,8 @@ static std::string finalizeSvg(std::string_view svg, SatoruContext& context,
 
         if (!replaced) {
             bool isSvg = tag.isTag("svg");
+            if (isSvg && tag.closing && --svgDepth == 0 && sink) result.append(defs());
+            if (isSvg && !tag.closing && !tag.selfClosing) svgDepth++;
             if (tag.isTag("image") && !tag.closing) {
                 bool hasPreserve = false;
                 for (const auto& a : tag.attrs) {
@@ -1612,23 +1742,18 @@ static std::string finalizeSvg(std::string_view svg, SatoruContext& context,
                 serializeFastTag(result, tag);
             }
 
-            if (isSvg && !tag.closing && !defsInjected) {
-                std::string defs = generateDefs(container, context, options);
-                result.append("<defs><!--SATORU_DEFS-->");
-                result.append(defs);
-                result.append("</defs>");
-                defsInjected = true;
+            if (isSvg && !tag.closing && defsPos == std::string::npos) {
+                // The defs describe everything drawn, so finish() splices them in here.
+                defsPos = result.size();
             }
         }
     }
-    return result;
-}
+};
 }  // namespace
 
-std::string renderDocumentToSvg(SatoruInstance* inst, int width, int height,
-                                const RenderOptions& options) {
-    if (!inst->doc || !inst->render_container) return "";
-
+// Draws the retained document through SkSVGCanvas into stream; the caller finishes it.
+static bool drawDocumentToSvg(SatoruInstance* inst, int width, int height,
+                              const RenderOptions& options, SkWStream& stream) {
     int content_width = width;
     int content_height = (height > 0) ? height : (int)inst->doc->height();
     if (content_height < 1) content_height = 1;
@@ -1641,7 +1766,6 @@ std::string renderDocumentToSvg(SatoruInstance* inst, int width, int height,
     int out_width = options.outputWidth > 0 ? options.outputWidth : src_w;
     int out_height = options.outputHeight > 0 ? options.outputHeight : src_h;
 
-    SkDynamicMemoryWStream stream;
     SkSVGCanvas::Options svg_options;
     if (options.svgTextToPaths) {
         svg_options.flags = SkSVGCanvas::kConvertTextToPaths_Flag;
@@ -1652,7 +1776,7 @@ std::string renderDocumentToSvg(SatoruInstance* inst, int width, int height,
                                     svg_options);
     if (!canvas) {
         SATORU_LOG_ERROR("[Satoru] renderDocumentToSvg FAILED: SkSVGCanvas::Make returned nullptr");
-        return "";
+        return false;
     }
 
     if (options.backgroundColor != 0) {
@@ -1684,29 +1808,36 @@ std::string renderDocumentToSvg(SatoruInstance* inst, int width, int height,
     inst->render_container->flush();
 
     canvas.reset();
-    sk_sp<SkData> data = stream.detachAsData();
-    if (!data) {
-        SATORU_LOG_ERROR("[Satoru] renderDocumentToSvg FAILED: detachAsData returned nullptr");
-        return "";
-    }
-    std::string_view svg((const char*)data->data(), data->size());
+    return true;
+}
+
+std::string renderDocumentToSvg(SatoruInstance* inst, int width, int height,
+                                const RenderOptions& options) {
+    if (!inst->doc || !inst->render_container) return "";
+    SvgFinalizeStream stream(inst->context, *inst->render_container, options);
+    if (!drawDocumentToSvg(inst, width, height, options, stream)) return "";
+    return stream.finish();
+}
 
-    return finalizeSvg(svg, inst->context, *inst->render_container, options);
+bool renderDocumentToSvg(SatoruInstance* inst, int width, int height, const RenderOptions& options,
+                         SkWStream* out) {
+    if (!inst->doc || !inst->render_container) return false;
+    SvgFinalizeStream stream(inst->context, *inst->render_container, options, out);
+    if (!drawDocumentToSvg(inst, width, height, options, stream)) return false;
+    stream.finish();
+    return stream.sinkOk();
 }
 
 std::string renderHtmlToSvg(const char* html, int width, int height, SatoruContext& context,
-                            const char* master_css, const char* user_css,
-                            const RenderOptions& options) {
+                            litehtml::shared_stylesheet& master_css,
+                            litehtml::shared_stylesheet& user_css, const RenderOptions& options) {
     int initial_height = (height > 0) ? height : 3000;
     litehtml::media_type media_type =
         (options.mediaType == 1) ? litehtml::media_type_print : litehtml::media_type_screen;
     auto container = std::make_unique<container_skia>(width, initial_height, nullptr, context,
                                                       nullptr, false, media_type);
 
-    std::string css = master_css ? master_css : litehtml::master_css;
-    css += "\nbr { display: -litehtml-br !important; }\n";
-
-    auto doc = litehtml::document::createFromString(html, container.get(), css.c_str(), user_css);
+    auto doc = litehtml::document::createFromString(html, container.get(), master_css, user_css);
     if (!doc) {
         SATORU_LOG_ERROR(
             "[Satoru] Failed to create document in renderHtmlToSvg (returned nullptr)");
@@ -1717,7 +1848,7 @@ std::string renderHtmlToSvg(const char* html, int width, int height, SatoruConte
     int content_height = (height > 0) ? height : (int)doc->height();
     if (content_height < 1) content_height = 1;
 
-    SkDynamicMemoryWStream stream;
+    SvgFinalizeStream stream(context, *container, options);
     SkSVGCanvas::Options svg_options;
     if (options.svgTextToPaths) {
         svg_options.flags = SkSVGCanvas::kConvertTextToPaths_Flag;
@@ -1747,12 +1878,5 @@ std::string renderHtmlToSvg(const char* html, int width, int height, SatoruConte
     container->flush();
 
     canvas.reset();
-    sk_sp<SkData> data = stream.detachAsData();
-    if (!data) {
-        SATORU_LOG_ERROR("[Satoru] renderStateToSvg FAILED: detachAsData returned nullptr");
-        return "";
-    }
-    std::string_view svg((const char*)data->data(), data->size());
-
-    return finalizeSvg(svg, context, *container, options);
+    return stream.finish();
 }
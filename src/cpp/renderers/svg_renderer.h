@@ -1,16 +1,23 @@
 #ifndef SVG_RENDERER_H
 #define SVG_RENDERER_H
 
+#include <litehtml/stylesheet.h>
+
 #include <string>
 
 #include "core/satoru_context.h"
+#include "include/core/SkStream.h"
 
 struct SatoruInstance;
 std::string renderDocumentToSvg(SatoruInstance* inst, int width, int height,
                                 const RenderOptions& options);
+// Streams the SVG to out in chunks as it is drawn. <defs> go at the end of the root element
+// instead of the start. Returns false if drawing fails or out rejects a write.
+bool renderDocumentToSvg(SatoruInstance* inst, int width, int height, const RenderOptions& options,
+                         SkWStream* out);
 
 std::string renderHtmlToSvg(const char* html, int width, int height, SatoruContext& context,
-                            const char* master_css, const char* user_css,
-                            const RenderOptions& options);
+                            litehtml::shared_stylesheet& master_css,
+                            litehtml::shared_stylesheet& user_css, const RenderOptions& options);
 
 #endif  // SVG_RENDERER_H
\ No newline at end of file
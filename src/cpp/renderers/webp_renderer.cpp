@@ -1,7 +1,5 @@
 #include "webp_renderer.h"
 
-#include <litehtml/master_css.h>
-
 #include "api/satoru_api.h"
 #include "core/container_skia.h"
 #include "include/core/SkBitmap.h"
@@ -10,76 +8,42 @@
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkStream.h"
 #include "include/encode/SkWebpEncoder.h"
+#include "png_renderer.h"
 #include "render_utils.h"
 
-sk_sp<SkData> renderDocumentToWebp(SatoruInstance* inst, int width, int height,
-                                   const RenderOptions& options) {
-    if (!inst->doc || !inst->render_container) return nullptr;
-
-    int content_width = width;
-    int content_height = (height > 0) ? height : (int)inst->doc->height();
-    if (content_height < 1) content_height = 1;
-
-    int src_x = options.cropX;
-    int src_y = options.cropY;
-    int src_w = options.cropWidth > 0 ? options.cropWidth : content_width;
-    int src_h = options.cropHeight > 0 ? options.cropHeight : content_height;
-
-    int out_width = options.outputWidth > 0 ? options.outputWidth : src_w;
-    int out_height = options.outputHeight > 0 ? options.outputHeight : src_h;
-
-    SkImageInfo info = SkImageInfo::MakeN32Premul(out_width, out_height, SkColorSpace::MakeSRGB());
-    SkBitmap bitmap;
-    bitmap.allocPixels(info);
-    bitmap.eraseColor(options.backgroundColor);
-
-    SkCanvas canvas(bitmap);
-
-    if (options.outputWidth > 0 || options.outputHeight > 0) {
-        apply_resize_transform(&canvas, src_w, src_h, options);
-    }
-
-    inst->render_container->reset();
-    inst->render_container->set_canvas(&canvas);
-    inst->render_container->set_height(content_height);
-    inst->render_container->set_tagging(false);
-
-    litehtml::media_type media_type =
-        (options.mediaType == 1) ? litehtml::media_type_print : litehtml::media_type_screen;
-    if (inst->render_container->get_media_type() != media_type) {
-        inst->render_container->set_media_type(media_type);
-        inst->doc->media_changed();
-        inst->doc->render(width);
+sk_sp<SkData> encodeWebp(const SkBitmap& bitmap) {
+    SkDynamicMemoryWStream stream;
+    if (encodeWebp(bitmap, &stream)) {
+        return stream.detachAsData();
     }
+    return nullptr;
+}
 
-    litehtml::position clip(0, 0, src_w, src_h);
-    inst->doc->draw(0, -src_x, -src_y, &clip);
-    inst->render_container->flush();
-
-    SkDynamicMemoryWStream stream;
+bool encodeWebp(const SkBitmap& bitmap, SkWStream* out) {
     SkWebpEncoder::Options encoder_options;
     encoder_options.fCompression = SkWebpEncoder::Compression::kLossless;
     encoder_options.fQuality = 100.0f;
+    return SkWebpEncoder::Encode(out, bitmap.pixmap(), encoder_options);
+}
 
-    if (SkWebpEncoder::Encode(&stream, bitmap.pixmap(), encoder_options)) {
-        return stream.detachAsData();
-    }
-    return nullptr;
+sk_sp<SkData> renderDocumentToWebp(SatoruInstance* inst, int width, int height,
+                                   const RenderOptions& options) {
+    SkBitmap bitmap;
+    if (!renderDocumentToBitmap(inst, width, height, options, bitmap)) return nullptr;
+    return encodeWebp(bitmap);
 }
 
 sk_sp<SkData> renderHtmlToWebp(const char* html, int width, int height, SatoruContext& context,
-                               const char* master_css, const char* user_css,
+                               litehtml::shared_stylesheet& master_css,
+                               litehtml::shared_stylesheet& user_css,
                                const RenderOptions& options) {
     int initial_height = (height > 0) ? height : 3000;
     litehtml::media_type media_type =
         (options.mediaType == 1) ? litehtml::media_type_print : litehtml::media_type_screen;
     container_skia container(width, initial_height, nullptr, context, nullptr, false, media_type);
 
-    std::string css = master_css ? master_css : litehtml::master_css;
-    css += "\nbr { display: -litehtml-br !important; }\n";
-
     litehtml::document::ptr doc =
-        litehtml::document::createFromString(html, &container, css.c_str(), user_css);
+        litehtml::document::createFromString(html, &container, master_css, user_css);
     if (!doc) return nullptr;
 
     doc->render(width);
@@ -113,14 +77,5 @@ sk_sp<SkData> renderHtmlToWebp(const char* html, int width, int height, SatoruCo
     doc->draw(0, -src_x, -src_y, &clip);
     container.flush();
 
-    SkDynamicMemoryWStream stream;
-    SkWebpEncoder::Options encode_options;
-    encode_options.fCompression = SkWebpEncoder::Compression::kLossless;
-    encode_options.fQuality = 100.0f;
-
-    if (SkWebpEncoder::Encode(&stream, bitmap.pixmap(), encode_options)) {
-        return stream.detachAsData();
-    }
-
-    return nullptr;
+    return encodeWebp(bitmap);
 }
@@ -1,15 +1,23 @@
 #ifndef WEBP_RENDERER_H
 #define WEBP_RENDERER_H
 
+#include <litehtml/stylesheet.h>
+
 #include "core/satoru_context.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkData.h"
+#include "include/core/SkStream.h"
 
 struct SatoruInstance;
+sk_sp<SkData> encodeWebp(const SkBitmap& bitmap);
+bool encodeWebp(const SkBitmap& bitmap, SkWStream* out);
+
 sk_sp<SkData> renderDocumentToWebp(SatoruInstance* inst, int width, int height,
                                    const RenderOptions& options);
 
 sk_sp<SkData> renderHtmlToWebp(const char* html, int width, int height, SatoruContext& context,
-                               const char* master_css, const char* user_css,
+                               litehtml::shared_stylesheet& master_css,
+                               litehtml::shared_stylesheet& user_css,
                                const RenderOptions& options);
 
 #endif
@@ -22,6 +22,8 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
 #include "include/core/SkFontMgr.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkSamplingOptions.h"
 #include "include/core/SkStream.h"
 #include "modules/skresources/include/SkResources.h"
 #include "modules/svg/include/SkSVGDOM.h"
@@ -69,6 +71,59 @@ sk_sp<SkImage> ImageDecoder::decode(const uint8_t* data, size_t size, int& out_w
     return nullptr;
 }
 
+bool ImageDecoder::read_raster_size(const sk_sp<SkData>& data, int& out_width,
+                                    int& out_height) {
+    if (!data || data->size() == 0) return false;
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+    if (!codec) return false;
+    out_width = codec->dimensions().width();
+    out_height = codec->dimensions().height();
+    return out_width > 0 && out_height > 0;
+}
+
+sk_sp<SkImage> ImageDecoder::decode_raster(const sk_sp<SkData>& data, int min_width,
+                                           int min_height) {
+    if (!data || data->size() == 0) return nullptr;
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+    if (!codec) return nullptr;
+
+    SkISize full = codec->dimensions();
+    min_width = std::clamp(min_width, 1, full.width());
+    min_height = std::clamp(min_height, 1, full.height());
+
+    // Codecs that cannot scale report the full size here.
+    float scale = std::max((float)min_width / full.width(), (float)min_height / full.height());
+    SkISize size = codec->getScaledDimensions(scale);
+    if (size.width() < min_width || size.height() < min_height) size = full;
+
+    SkImageInfo info = codec->getInfo()
+                           .makeDimensions(size)
+                           .makeColorType(kN32_SkColorType)
+                           .makeAlphaType(kPremul_SkAlphaType);
+    SkBitmap bitmap;
+    if (!bitmap.tryAllocPixels(info)) return nullptr;
+    SkCodec::Result result = codec->getPixels(info, bitmap.getPixels(), bitmap.rowBytes());
+    if (result == SkCodec::kInvalidScale && size != full) {
+        info = info.makeDimensions(full);
+        if (!bitmap.tryAllocPixels(info)) return nullptr;
+        result = codec->getPixels(info, bitmap.getPixels(), bitmap.rowBytes());
+    }
+    if (result != SkCodec::kSuccess) return nullptr;
+
+    // Keep only what the destination needs when the codec could not get close to it.
+    if (bitmap.width() >= min_width * 2 && bitmap.height() >= min_height * 2) {
+        SkBitmap scaled;
+        if (scaled.tryAllocPixels(info.makeWH(min_width, min_height)) &&
+            bitmap.pixmap().scalePixels(scaled.pixmap(),
+                                        SkSamplingOptions(SkCubicResampler::Mitchell()))) {
+            bitmap = scaled;
+        }
+    }
+
+    bitmap.setImmutable();
+    return bitmap.asImage();
+}
+
 sk_sp<SkData> ImageDecoder::patch_svg_data(const sk_sp<SkData>& data) {
     // Note: Complex patching with ctre caused RuntimeError in Wasm due to stack usage.
     // For now, return original data.
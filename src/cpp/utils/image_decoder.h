@@ -27,6 +27,28 @@ class ImageDecoder {
     static sk_sp<SkImage> decode(const uint8_t* data, size_t size, int& out_width, int& out_height,
                                  sk_sp<SkFontMgr> font_mgr = nullptr);
 
+    /**
+     * @brief Reads the dimensions of a raster image without decoding its pixels.
+     *
+     * @param data Encoded image data.
+     * @param out_width Output width of the image.
+     * @param out_height Output height of the image.
+     * @return true if SkCodec recognizes the data as a raster format.
+     */
+    static bool read_raster_size(const sk_sp<SkData>& data, int& out_width, int& out_height);
+
+    /**
+     * @brief Decodes a raster image at the smallest size that is at least min_width x
+     * min_height, using the codec's native scaling (JPEG DCT scaling, WebP) when available and
+     * resampling otherwise.
+     *
+     * @param data Encoded image data.
+     * @param min_width Minimum width of the decoded image.
+     * @param min_height Minimum height of the decoded image.
+     * @return sk_sp<SkImage> The decoded image, or nullptr if decoding failed.
+     */
+    static sk_sp<SkImage> decode_raster(const sk_sp<SkData>& data, int min_width, int min_height);
+
    private:
     /**
      * @brief Patches SVG data to workaround issues in Skia's SVG DOM or to add features.
@@ -1,61 +1,259 @@
 #ifndef SATORU_LRU_CACHE_H
 #define SATORU_LRU_CACHE_H
 
-#include <list>
-#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace satoru {
 
-template <typename Key, typename Value, typename Hash = std::hash<Key>>
+struct LruCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+};
+
+// Hashes std::string keys through std::string_view so lookups can probe with a view.
+struct StringViewHash {
+    std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
+
+// Default weigher: entries have no byte cost, so only the entry count bounds the cache.
+struct LruNoWeight {
+    template <typename K, typename V>
+    size_t operator()(const K&, const V&) const {
+        return 0;
+    }
+};
+
+/**
+ * Fixed-capacity LRU cache.
+ *
+ * Entries live in one flat node array threaded by an intrusive recency list, and are
+ * indexed by a linear-probing table of node indices. Each node keeps its key hash, so
+ * probes compare hashes before keys and eviction never re-hashes. get/exists accept any
+ * probe type that Hash accepts and Key compares equal to (e.g. a view of the key), and
+ * take an optional precomputed hash so a miss followed by put hashes only once.
+ *
+ * With a byte budget, Weigh gives each entry's cost and put evicts least recently used entries
+ * until the total fits again; the entry just put is always kept.
+ *
+ * Pointers returned by get stay valid until the entry is evicted or the cache is cleared.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename Weigh = LruNoWeight>
 class LruCache {
    public:
-    typedef typename std::pair<Key, Value> key_value_pair_t;
-    typedef typename std::list<key_value_pair_t>::iterator list_iterator_t;
+    explicit LruCache(size_t max_size, size_t max_bytes = 0)
+        : m_max_size(max_size > 0 ? max_size : 1), m_max_bytes(max_bytes) {}
+
+    template <typename K>
+    size_t hash(const K& key) const {
+        return m_hasher(key);
+    }
 
-    LruCache(size_t max_size) : m_max_size(max_size) {}
+    void put(Key key, Value value) {
+        size_t h = m_hasher(key);
+        put(std::move(key), std::move(value), h);
+    }
 
-    void put(const Key& key, const Value& value) {
-        auto it = m_cache_items_map.find(key);
-        m_cache_items_list.push_front(key_value_pair_t(key, value));
-        if (it != m_cache_items_map.end()) {
-            m_cache_items_list.erase(it->second);
-            m_cache_items_map.erase(it);
+    void put(Key key, Value value, size_t hash) {
+        size_t bytes = m_weigh(key, value);
+        uint32_t idx = find(key, hash);
+        if (idx != npos) {
+            Node& node = m_nodes[idx];
+            m_bytes = m_bytes - node.bytes + bytes;
+            node.value = std::move(value);
+            node.bytes = bytes;
+            touch(idx);
+            trim(idx);
+            return;
         }
-        m_cache_items_map[key] = m_cache_items_list.begin();
 
-        if (m_cache_items_map.size() > m_max_size) {
-            auto last = m_cache_items_list.end();
-            last--;
-            m_cache_items_map.erase(last->first);
-            m_cache_items_list.pop_back();
+        if (!m_free.empty()) {
+            idx = m_free.back();
+            m_free.pop_back();
+            Node& node = m_nodes[idx];
+            node.key = std::move(key);
+            node.value = std::move(value);
+            node.hash = hash;
+            node.bytes = bytes;
+        } else if (m_nodes.size() < m_max_size) {
+            if (m_table.empty()) allocate();
+            idx = (uint32_t)m_nodes.size();
+            m_nodes.push_back({std::move(key), std::move(value), hash, bytes, npos, npos});
+        } else {
+            idx = m_tail;
+            unlink(idx);
+            erase_slot(idx);
+            m_stats.evictions++;
+            Node& node = m_nodes[idx];
+            m_bytes -= node.bytes;
+            node.key = std::move(key);
+            node.value = std::move(value);
+            node.hash = hash;
+            node.bytes = bytes;
         }
+        m_bytes += bytes;
+        insert_slot(idx);
+        push_front(idx);
+        trim(idx);
     }
 
-    Value* get(const Key& key) {
-        auto it = m_cache_items_map.find(key);
-        if (it == m_cache_items_map.end()) {
+    template <typename K>
+    Value* get(const K& key) {
+        return get(key, m_hasher(key));
+    }
+
+    template <typename K>
+    Value* get(const K& key, size_t hash) {
+        uint32_t idx = find(key, hash);
+        if (idx == npos) {
+            m_stats.misses++;
             return nullptr;
-        } else {
-            m_cache_items_list.splice(m_cache_items_list.begin(), m_cache_items_list, it->second);
-            return &it->second->second;
         }
+        m_stats.hits++;
+        touch(idx);
+        return &m_nodes[idx].value;
     }
 
-    bool exists(const Key& key) const {
-        return m_cache_items_map.find(key) != m_cache_items_map.end();
+    template <typename K>
+    bool exists(const K& key) const {
+        return find(key, m_hasher(key)) != npos;
     }
 
-    size_t size() const { return m_cache_items_map.size(); }
+    size_t size() const { return m_nodes.size() - m_free.size(); }
+    size_t capacity() const { return m_max_size; }
+    size_t bytes() const { return m_bytes; }
+    size_t max_bytes() const { return m_max_bytes; }
+
+    const LruCacheStats& stats() const { return m_stats; }
+    void reset_stats() { m_stats = LruCacheStats(); }
 
     void clear() {
-        m_cache_items_map.clear();
-        m_cache_items_list.clear();
+        m_nodes.clear();
+        m_free.clear();
+        std::fill(m_table.begin(), m_table.end(), 0);
+        m_head = m_tail = npos;
+        m_bytes = 0;
     }
 
    private:
-    std::list<key_value_pair_t> m_cache_items_list;
-    std::unordered_map<Key, list_iterator_t, Hash> m_cache_items_map;
+    static constexpr uint32_t npos = 0xffffffffu;
+
+    struct Node {
+        Key key;
+        Value value;
+        size_t hash;
+        size_t bytes;
+        uint32_t prev;
+        uint32_t next;
+    };
+
+    // Nodes are reserved up front so get() pointers survive later inserts; the table keeps
+    // its load factor at or below 1/2.
+    void allocate() {
+        m_nodes.reserve(m_max_size);
+        size_t table_size = 1;
+        while (table_size < m_max_size * 2) table_size <<= 1;
+        m_table.assign(table_size, 0);
+    }
+
+    template <typename K>
+    uint32_t find(const K& key, size_t hash) const {
+        if (m_nodes.empty()) return npos;
+        size_t mask = m_table.size() - 1;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            uint32_t slot = m_table[i];
+            if (slot == 0) return npos;
+            const Node& node = m_nodes[slot - 1];
+            if (node.hash == hash && node.key == key) return slot - 1;
+        }
+    }
+
+    void insert_slot(uint32_t idx) {
+        size_t mask = m_table.size() - 1;
+        size_t i = m_nodes[idx].hash & mask;
+        while (m_table[i] != 0) i = (i + 1) & mask;
+        m_table[i] = idx + 1;
+    }
+
+    // Backward-shift deletion keeps probe chains intact without tombstones.
+    void erase_slot(uint32_t idx) {
+        size_t mask = m_table.size() - 1;
+        size_t i = m_nodes[idx].hash & mask;
+        while (m_table[i] != idx + 1) i = (i + 1) & mask;
+        for (size_t j = (i + 1) & mask; m_table[j] != 0; j = (j + 1) & mask) {
+            size_t home = m_nodes[m_table[j] - 1].hash & mask;
+            bool stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+            if (stays) continue;
+            m_table[i] = m_table[j];
+            i = j;
+        }
+        m_table[i] = 0;
+    }
+
+    void unlink(uint32_t idx) {
+        Node& node = m_nodes[idx];
+        if (node.prev != npos)
+            m_nodes[node.prev].next = node.next;
+        else
+            m_head = node.next;
+        if (node.next != npos)
+            m_nodes[node.next].prev = node.prev;
+        else
+            m_tail = node.prev;
+    }
+
+    void push_front(uint32_t idx) {
+        Node& node = m_nodes[idx];
+        node.prev = npos;
+        node.next = m_head;
+        if (m_head != npos) m_nodes[m_head].prev = idx;
+        m_head = idx;
+        if (m_tail == npos) m_tail = idx;
+    }
+
+    // Evicts from the tail until the byte budget holds. Freed nodes keep their place in the
+    // array (so other entries' pointers survive) and are reused by the next put; their key and
+    // value are released now, since large keys count against the budget too.
+    void trim(uint32_t keep) {
+        if (m_max_bytes == 0) return;
+        while (m_bytes > m_max_bytes && m_tail != keep) {
+            uint32_t idx = m_tail;
+            unlink(idx);
+            erase_slot(idx);
+            m_stats.evictions++;
+            Node& node = m_nodes[idx];
+            m_bytes -= node.bytes;
+            node.bytes = 0;
+            node.key = Key();
+            node.value = Value();
+            m_free.push_back(idx);
+        }
+    }
+
+    void touch(uint32_t idx) {
+        if (m_head == idx) return;
+        unlink(idx);
+        push_front(idx);
+    }
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_table;
+    std::vector<uint32_t> m_free;
+    uint32_t m_head = npos;
+    uint32_t m_tail = npos;
     size_t m_max_size;
+    size_t m_max_bytes;
+    size_t m_bytes = 0;
+    Hash m_hasher;
+    Weigh m_weigh;
+    LruCacheStats m_stats;
 };
 
 }  // namespace satoru
@@ -0,0 +1,97 @@
+#include "png_row_encoder.h"
+
+#include <png.h>
+
+#include <csetjmp>
+
+#include "include/core/SkImageInfo.h"
+
+namespace satoru {
+
+namespace {
+
+void write_to_stream(png_structp png, png_bytep data, png_size_t length) {
+    SkWStream* stream = static_cast<SkWStream*>(png_get_io_ptr(png));
+    if (!stream->write(data, length)) png_error(png, "stream write failed");
+}
+
+void flush_stream(png_structp png) { static_cast<SkWStream*>(png_get_io_ptr(png))->flush(); }
+
+void ignore_warning(png_structp, png_const_charp) {}
+
+// libpng reports errors by longjmp-ing back here, so these stay free of C++ locals.
+bool write_header(png_structp png, png_infop info, SkWStream* out, int width, int height) {
+    if (setjmp(png_jmpbuf(png))) return false;
+    png_set_write_fn(png, out, write_to_stream, flush_stream);
+    png_set_IHDR(png, info, (png_uint_32)width, (png_uint_32)height, 8, PNG_COLOR_TYPE_RGB_ALPHA,
+                 PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+    png_set_sRGB(png, info, PNG_sRGB_INTENT_PERCEPTUAL);
+    // Same settings as SkPngEncoder's defaults.
+    png_set_compression_level(png, 6);
+    png_set_filter(png, PNG_FILTER_TYPE_BASE, PNG_ALL_FILTERS);
+    png_write_info(png, info);
+    return true;
+}
+
+bool write_row(png_structp png, png_bytep row) {
+    if (setjmp(png_jmpbuf(png))) return false;
+    png_write_row(png, row);
+    return true;
+}
+
+bool write_end(png_structp png, png_infop info) {
+    if (setjmp(png_jmpbuf(png))) return false;
+    png_write_end(png, info);
+    return true;
+}
+
+}  // namespace
+
+PngRowEncoder::~PngRowEncoder() {
+    if (m_png) png_destroy_write_struct(&m_png, m_info ? &m_info : nullptr);
+}
+
+bool PngRowEncoder::begin(SkWStream* out, int width, int height) {
+    if (m_png || !out || width <= 0 || height <= 0) return false;
+    m_png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, ignore_warning);
+    if (!m_png) return false;
+    m_info = png_create_info_struct(m_png);
+    if (!m_info) {
+        m_failed = true;
+        return false;
+    }
+    m_width = width;
+    m_height = height;
+    m_row.resize((size_t)width * 4);
+    if (!write_header(m_png, m_info, out, width, height)) m_failed = true;
+    return !m_failed;
+}
+
+bool PngRowEncoder::writeRows(const SkPixmap& band) {
+    if (!m_png || m_failed) return false;
+    if (band.width() != m_width) {
+        m_failed = true;
+        return false;
+    }
+
+    SkImageInfo row_info = SkImageInfo::Make(m_width, 1, kRGBA_8888_SkColorType,
+                                             kUnpremul_SkAlphaType, band.refColorSpace());
+    for (int y = 0; y < band.height() && m_rowsWritten < m_height; y++) {
+        SkPixmap src(band.info().makeWH(m_width, 1), band.addr(0, y), band.rowBytes());
+        if (!src.readPixels(row_info, m_row.data(), m_row.size()) ||
+            !write_row(m_png, m_row.data())) {
+            m_failed = true;
+            return false;
+        }
+        m_rowsWritten++;
+    }
+    return true;
+}
+
+bool PngRowEncoder::finish() {
+    if (!m_png || m_failed || m_rowsWritten != m_height) return false;
+    if (!write_end(m_png, m_info)) m_failed = true;
+    return !m_failed;
+}
+
+}  // namespace satoru
@@ -0,0 +1,61 @@
+#ifndef SATORU_PNG_ROW_ENCODER_H
+#define SATORU_PNG_ROW_ENCODER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "include/core/SkPixmap.h"
+#include "include/core/SkStream.h"
+
+struct png_struct_def;
+struct png_info_def;
+
+namespace satoru {
+
+/**
+ * Row-oriented PNG encoder on top of libpng.
+ *
+ * SkPngEncoder reads its rows from a single pixmap that covers the whole image; this one
+ * accepts the image as a sequence of pixmaps (bands) written top to bottom, so the caller
+ * only needs to keep one band of pixels alive at a time. Output is 8-bit RGBA, unpremultiplied.
+ */
+class PngRowEncoder {
+   public:
+    PngRowEncoder() = default;
+    ~PngRowEncoder();
+
+    PngRowEncoder(const PngRowEncoder&) = delete;
+    PngRowEncoder& operator=(const PngRowEncoder&) = delete;
+
+    /**
+     * @brief Writes the PNG header for a width x height image to out.
+     * @return false if the header could not be written.
+     */
+    bool begin(SkWStream* out, int width, int height);
+
+    /**
+     * @brief Appends the rows of band below the rows written so far.
+     *
+     * band must be exactly as wide as the image; it may be in any color type SkPixmap can read
+     * from. Rows past the image height are ignored.
+     */
+    bool writeRows(const SkPixmap& band);
+
+    /**
+     * @brief Writes the end of the stream. All height rows must have been written.
+     */
+    bool finish();
+
+   private:
+    png_struct_def* m_png = nullptr;
+    png_info_def* m_info = nullptr;
+    std::vector<uint8_t> m_row;
+    int m_width = 0;
+    int m_height = 0;
+    int m_rowsWritten = 0;
+    bool m_failed = false;
+};
+
+}  // namespace satoru
+
+#endif
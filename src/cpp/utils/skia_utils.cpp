@@ -32,6 +32,15 @@ std::string base64_encode(const uint8_t* data, size_t len) {
     return out;
 }
 
+uint64_t content_hash(const uint8_t* data, size_t len) {
+    uint64_t h = 14695981039346656037ULL ^ len;  // FNV-1a over every byte
+    for (size_t i = 0; i < len; i++) {
+        h ^= data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
 std::vector<uint8_t> base64_decode(const std::string& in) {
     std::vector<uint8_t> out;
     static const std::vector<int> T = [] {
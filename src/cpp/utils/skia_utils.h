@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 
+#include "include/core/SkData.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkRRect.h"
 #include "include/core/SkRefCnt.h"
@@ -14,11 +15,17 @@ struct image_info {
     int width;
     int height;
     std::string data_url;
+    // Decoded pixels. For raster images loaded from encoded data this is filled lazily by
+    // SatoruContext::getImage at the size the draws need.
     sk_sp<SkImage> skImage;
+    sk_sp<SkData> encoded;
+    // content_hash(encoded), computed by the first SVG embed that needs it; 0 until then
+    uint64_t content_hash = 0;
 };
 
 std::string clean_font_name(const char* name);
 std::string base64_encode(const uint8_t* data, size_t len);
+uint64_t content_hash(const uint8_t* data, size_t len);
 std::vector<uint8_t> base64_decode(const std::string& in);
 std::string url_decode(const std::string& in);
 
@@ -5,8 +5,6 @@
 #include "SkTypeface.h"
 #include <cstdint>
 
-using SkGlyphID = uint32_t;
-
 enum class SkFontHinting : uint8_t {
     kNone = 0,
     kSlight = 1,
@@ -2,8 +2,7 @@
 // Minimal SkImageFilter stub for native tests (no Skia dependency)
 #include "core/SkRefCnt.h"
 #include "core/SkColor.h"
-
-class SkColorFilter;
+#include "core/SkColorFilter.h"
 
 class SkImageFilter : public SkRefCnt {
 public:
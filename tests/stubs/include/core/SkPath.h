@@ -36,6 +36,29 @@ struct SkPath {
     std::vector<SkPathOp> fOps;
 
     bool isEmpty() const { return fOps.empty(); }
+
+    SkPath makeOffset(float dx, float dy) const {
+        SkPath p = *this;
+        for (auto& op : p.fOps) {
+            switch (op.type) {
+                case SkPathOp::kOval:
+                case SkPathOp::kRect:
+                    op.params[2] += dx;
+                    op.params[3] += dy;
+                    [[fallthrough]];
+                case SkPathOp::kCircle:
+                case SkPathOp::kMove:
+                case SkPathOp::kLine:
+                    op.params[0] += dx;
+                    op.params[1] += dy;
+                    break;
+                default:
+                    break;
+            }
+        }
+        return p;
+    }
+
     bool operator==(const SkPath& o) const { return fOps == o.fOps; }
     bool operator!=(const SkPath& o) const { return !(*this == o); }
 };
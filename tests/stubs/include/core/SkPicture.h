@@ -0,0 +1,9 @@
+#pragma once
+// Minimal SkPicture stub for native tests (no Skia dependency)
+#include <cstddef>
+#include "SkRefCnt.h"
+
+class SkPicture : public SkRefCnt {
+public:
+    size_t approximateBytesUsed() const { return 0; }
+};
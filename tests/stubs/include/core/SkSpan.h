@@ -1,19 +1,25 @@
 #pragma once
 #include <cstddef>
+#include <type_traits>
 #include <vector>
+// T may be const-qualified: SkSpan<const T> is a read-only view, SkSpan<T> a writable one.
 template <typename T>
 struct SkSpan {
-    const T* fPtr = nullptr;
+    T* fPtr = nullptr;
     size_t fCount = 0;
     SkSpan() = default;
-    SkSpan(const T* ptr, size_t count) : fPtr(ptr), fCount(count) {}
-    template <typename U, typename = std::enable_if_t<std::is_same_v<U, T>>>
+    SkSpan(T* ptr, size_t count) : fPtr(ptr), fCount(count) {}
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    SkSpan(std::vector<U>& vec) : fPtr(vec.data()), fCount(vec.size()) {}
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<const U*, T*>>>
     SkSpan(const std::vector<U>& vec) : fPtr(vec.data()), fCount(vec.size()) {}
-    const T* data() const { return fPtr; }
+    T* data() const { return fPtr; }
     size_t size() const { return fCount; }
-    const T& operator[](size_t i) const { return fPtr[i]; }
-    const T* begin() const { return fPtr; }
-    const T* end() const { return fPtr + fCount; }
+    T& operator[](size_t i) const { return fPtr[i]; }
+    T* begin() const { return fPtr; }
+    T* end() const { return fPtr + fCount; }
 };
 template <typename U>
-SkSpan(const std::vector<U>&) -> SkSpan<U>;
+SkSpan(std::vector<U>&) -> SkSpan<U>;
+template <typename U>
+SkSpan(const std::vector<U>&) -> SkSpan<const U>;
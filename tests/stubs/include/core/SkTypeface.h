@@ -4,8 +4,13 @@
 #include "SkFontStyle.h"
 #include "SkFontArguments.h"
 #include "SkSpan.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
 
 using SkTypefaceID = uint32_t;
+using SkGlyphID = uint32_t;
+using SkUnichar = int32_t;
 
 class SkTypeface : public SkRefCnt {
 public:
@@ -16,8 +21,20 @@ public:
     SkTypefaceID uniqueID() const { return fID; }
     const SkFontStyle& fontStyle() const { return fStyle; }
 
-    // Glyph mapping stub — always returns 0 (no glyph)
-    uint16_t unicharToGlyph(int32_t) const { return 0; }
+    // Glyph mapping stub — no glyphs unless tests give the typeface codepoint ranges
+    uint16_t unicharToGlyph(SkUnichar u) const {
+        fLookups++;
+        return glyphFor(u);
+    }
+    void unicharsToGlyphs(SkSpan<const SkUnichar> unis, SkSpan<SkGlyphID> glyphs) const {
+        fBatchLookups++;
+        for (size_t i = 0; i < unis.size() && i < glyphs.size(); i++) glyphs[i] = glyphFor(unis[i]);
+    }
+
+    // Test hooks: inclusive codepoint ranges mapped to glyph 1, and lookup call counts
+    void addCoveredRange(SkUnichar first, SkUnichar last) { fCovered.emplace_back(first, last); }
+    int lookups() const { return fLookups; }
+    int batchLookups() const { return fBatchLookups; }
 
     // Variable font stubs
     int getVariationDesignPosition(SkSpan<SkFontArguments::VariationPosition::Coordinate>) const { return 0; }
@@ -26,7 +43,17 @@ public:
     }
 
 private:
+    uint16_t glyphFor(SkUnichar u) const {
+        for (const auto& r : fCovered) {
+            if (u >= r.first && u <= r.second) return 1;
+        }
+        return 0;
+    }
+
     SkTypefaceID fID;
     SkFontStyle fStyle;
+    std::vector<std::pair<SkUnichar, SkUnichar>> fCovered;
+    mutable int fLookups = 0;
+    mutable int fBatchLookups = 0;
     static inline SkTypefaceID sNextID = 0;
 };
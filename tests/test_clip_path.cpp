@@ -910,3 +910,24 @@ TEST(ClipPathCaseTest, InsetUpperCase) {
     expect_single_op(path, SkPathOp::kRect);
     EXPECT_FLOAT_EQ(path.fOps[0].params[0], 20.0f);
 }
+
+// ============================================================================
+// Shapes are relative to the box (clip_path_shape caches them at the origin)
+// ============================================================================
+
+TEST(ClipPathTranslationTest, OriginShapeOffsetMatchesBoxShape) {
+    const litehtml::position origin(0, 0, kDefaultPos.width, kDefaultPos.height);
+    for (const char* css : {"circle(40% at 25% 75%)", "ellipse(30px 20px)", "inset(10px 5%)",
+                            "polygon(0 0, 100% 0, 50% 100%)"}) {
+        SCOPED_TRACE(css);
+        SkPath at_box = parse(css, kDefaultPos);
+        SkPath moved = parse(css, origin).makeOffset((float)kDefaultPos.x, (float)kDefaultPos.y);
+        ASSERT_FALSE(at_box.isEmpty());
+        ASSERT_EQ(moved.fOps.size(), at_box.fOps.size());
+        for (size_t i = 0; i < at_box.fOps.size(); ++i) {
+            for (int k = 0; k < 4; ++k) {
+                EXPECT_FLOAT_EQ(moved.fOps[i].params[k], at_box.fOps[i].params[k]);
+            }
+        }
+    }
+}
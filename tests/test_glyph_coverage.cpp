@@ -0,0 +1,81 @@
+// Tests for glyph_coverage.h — the paged cmap bitset used by font fallback.
+// Uses the SkTypeface stub, whose covered ranges and lookup counts are set by the tests.
+
+#include <gtest/gtest.h>
+
+#include "core/text/glyph_coverage.h"
+
+using namespace satoru;
+
+TEST(GlyphCoverageTest, FillsAPageWithOneLookup) {
+    SkTypeface typeface;
+    typeface.addCoveredRange('A', 'Z');
+    GlyphCoverage coverage;
+
+    EXPECT_TRUE(coverage.covers(typeface, 'A'));
+    EXPECT_EQ(typeface.batchLookups(), 1);
+    EXPECT_EQ(typeface.lookups(), 0);
+
+    // Every codepoint of the page is now answered from the bitset
+    for (char32_t u = 0; u < 0x100; u++) {
+        EXPECT_EQ(coverage.covers(typeface, u), u >= 'A' && u <= 'Z') << (uint32_t)u;
+    }
+    EXPECT_EQ(typeface.batchLookups(), 1);
+
+    EXPECT_FALSE(coverage.covers(typeface, 0x100));
+    EXPECT_EQ(typeface.batchLookups(), 2);
+}
+
+TEST(GlyphCoverageTest, PageEdgesAreExact) {
+    SkTypeface typeface;
+    typeface.addCoveredRange(0x3FF, 0x400);
+    GlyphCoverage coverage;
+
+    EXPECT_FALSE(coverage.covers(typeface, 0x3FE));
+    EXPECT_TRUE(coverage.covers(typeface, 0x3FF));
+    EXPECT_TRUE(coverage.covers(typeface, 0x400));
+    EXPECT_FALSE(coverage.covers(typeface, 0x401));
+}
+
+TEST(GlyphCoverageTest, CodepointsPastTheBmp) {
+    SkTypeface typeface;
+    typeface.addCoveredRange(0x1F600, 0x1F64F);  // emoticons
+    typeface.addCoveredRange(0x10FFFF, 0x10FFFF);
+    GlyphCoverage coverage;
+
+    EXPECT_TRUE(coverage.covers(typeface, 0x1F600));
+    EXPECT_TRUE(coverage.covers(typeface, 0x1F64F));
+    EXPECT_FALSE(coverage.covers(typeface, 0x1F650));
+    // Same low byte in the BMP must not alias the supplementary page
+    EXPECT_FALSE(coverage.covers(typeface, 0xF600));
+    EXPECT_TRUE(coverage.covers(typeface, 0x10FFFF));
+    EXPECT_EQ(typeface.batchLookups(), 3);
+}
+
+TEST(GlyphCoverageTest, OutOfRangeCodepointsAreNotCovered) {
+    SkTypeface typeface;
+    typeface.addCoveredRange(0, 0x7FFFFFFF);
+    GlyphCoverage coverage;
+
+    EXPECT_FALSE(coverage.covers(typeface, 0x110000));
+    EXPECT_FALSE(coverage.covers(typeface, 0xFFFFFFFF));
+    EXPECT_EQ(typeface.batchLookups(), 0);
+}
+
+TEST(GlyphCoverageIndexTest, KeepsOneCoveragePerTypeface) {
+    sk_sp<SkTypeface> latin(new SkTypeface());
+    sk_sp<SkTypeface> emoji(new SkTypeface());
+    latin->addCoveredRange('a', 'z');
+    emoji->addCoveredRange(0x1F600, 0x1F64F);
+    GlyphCoverageIndex index;
+
+    EXPECT_TRUE(index.covers(latin, 'q'));
+    EXPECT_FALSE(index.covers(emoji, 'q'));
+    EXPECT_TRUE(index.covers(emoji, 0x1F610));
+    EXPECT_FALSE(index.covers(latin, 0x1F610));
+    EXPECT_TRUE(index.covers(latin, 'r'));
+    EXPECT_EQ(latin->batchLookups(), 2);
+    EXPECT_EQ(emoji->batchLookups(), 2);
+
+    EXPECT_FALSE(index.covers(nullptr, 'a'));
+}
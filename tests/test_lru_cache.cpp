@@ -1,4 +1,10 @@
 #include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "utils/lru_cache.h"
 
 using namespace satoru;
@@ -148,3 +154,216 @@ TEST(LruCacheTest, EvictionChain) {
     ASSERT_NE(v5, nullptr);
     EXPECT_EQ(*v5, 50);
 }
+
+TEST(LruCacheTest, CountsHitsMissesAndEvictions) {
+    LruCache<int, int> cache(2);
+
+    cache.put(1, 10);
+    cache.put(2, 20);
+    cache.get(1);
+    cache.get(3);
+    cache.put(3, 30);  // evicts 2
+    cache.put(1, 11);  // update, no eviction
+
+    EXPECT_EQ(cache.stats().hits, 1u);
+    EXPECT_EQ(cache.stats().misses, 1u);
+    EXPECT_EQ(cache.stats().evictions, 1u);
+    EXPECT_EQ(cache.capacity(), 2u);
+
+    cache.reset_stats();
+    EXPECT_EQ(cache.stats().hits, 0u);
+    EXPECT_EQ(cache.stats().evictions, 0u);
+}
+
+TEST(LruCacheTest, HeterogeneousStringViewLookup) {
+    LruCache<std::string, int, StringViewHash> cache(4);
+
+    cache.put("alpha", 1);
+    std::string text = "xxalphaxx";
+    std::string_view probe(text.data() + 2, 5);
+
+    auto* val = cache.get(probe);
+    ASSERT_NE(val, nullptr);
+    EXPECT_EQ(*val, 1);
+    EXPECT_TRUE(cache.exists(probe));
+    EXPECT_FALSE(cache.exists(std::string_view("alph")));
+
+    size_t h = cache.hash(std::string_view("beta"));
+    EXPECT_EQ(cache.get(std::string_view("beta"), h), nullptr);
+    cache.put("beta", 2, h);
+    val = cache.get(std::string_view("beta"));
+    ASSERT_NE(val, nullptr);
+    EXPECT_EQ(*val, 2);
+}
+
+namespace {
+// Every key lands in the same table bucket, so evictions exercise probe-chain repair.
+struct CollidingHash {
+    size_t operator()(int) const { return 7; }
+};
+}  // namespace
+
+TEST(LruCacheTest, EvictionKeepsCollidingChainsReachable) {
+    LruCache<int, int, CollidingHash> cache(4);
+
+    for (int i = 0; i < 32; ++i) {
+        cache.put(i, i * 10);
+        // The last four keys must always be present
+        for (int k = std::max(0, i - 3); k <= i; ++k) {
+            auto* val = cache.get(k);
+            ASSERT_NE(val, nullptr) << "key " << k << " after inserting " << i;
+            EXPECT_EQ(*val, k * 10);
+        }
+        EXPECT_LE(cache.size(), 4u);
+    }
+    EXPECT_EQ(cache.get(27), nullptr);
+}
+
+TEST(LruCacheTest, MatchesReferenceModel) {
+    // Compare against a simple vector-based LRU under a deterministic mixed workload
+    LruCache<int, int> cache(8);
+    std::vector<std::pair<int, int>> model;  // front = most recent
+
+    unsigned seed = 12345;
+    auto next = [&]() {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 16) & 0x7fff;
+    };
+
+    for (int step = 0; step < 2000; ++step) {
+        int key = (int)(next() % 24);
+        auto it = std::find_if(model.begin(), model.end(),
+                               [&](const auto& e) { return e.first == key; });
+        if (next() % 2 == 0) {
+            int value = step;
+            if (it != model.end()) model.erase(it);
+            model.insert(model.begin(), {key, value});
+            if (model.size() > 8) model.pop_back();
+            cache.put(key, value);
+        } else {
+            auto* val = cache.get(key);
+            if (it == model.end()) {
+                EXPECT_EQ(val, nullptr);
+            } else {
+                ASSERT_NE(val, nullptr);
+                EXPECT_EQ(*val, it->second);
+                auto entry = *it;
+                model.erase(it);
+                model.insert(model.begin(), entry);
+            }
+        }
+        ASSERT_EQ(cache.size(), model.size());
+    }
+}
+
+struct StringBytes {
+    size_t operator()(int, const std::string& value) const { return value.size(); }
+};
+
+TEST(LruCacheTest, ByteBudgetEvictsLeastRecentlyUsed) {
+    LruCache<int, std::string, std::hash<int>, StringBytes> cache(10, 10);
+
+    cache.put(1, "aaaa");
+    cache.put(2, "bbbb");
+    ASSERT_NE(cache.get(1), nullptr);  // 2 is now the least recently used
+    cache.put(3, "cccc");
+
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.bytes(), 8u);
+    EXPECT_FALSE(cache.exists(2));
+    EXPECT_TRUE(cache.exists(1));
+    EXPECT_TRUE(cache.exists(3));
+    EXPECT_EQ(cache.stats().evictions, 1u);
+}
+
+TEST(LruCacheTest, ByteBudgetKeepsNewestOversizedEntry) {
+    LruCache<int, std::string, std::hash<int>, StringBytes> cache(10, 10);
+
+    cache.put(1, "aa");
+    cache.put(2, "bb");
+    cache.put(3, std::string(16, 'c'));
+
+    EXPECT_EQ(cache.size(), 1u);
+    EXPECT_EQ(cache.bytes(), 16u);
+    ASSERT_NE(cache.get(3), nullptr);
+}
+
+TEST(LruCacheTest, ByteBudgetReusesFreedNodes) {
+    LruCache<int, std::string, std::hash<int>, StringBytes> cache(4, 6);
+
+    cache.put(1, "aaa");
+    cache.put(2, "bbb");
+    cache.put(1, "aaaaaa");  // growing 1 pushes out 2
+    EXPECT_FALSE(cache.exists(2));
+
+    cache.put(3, "");
+    cache.put(4, "");
+    cache.put(5, "");
+    EXPECT_EQ(cache.size(), 4u);
+    EXPECT_EQ(cache.bytes(), 6u);
+    ASSERT_NE(cache.get(1), nullptr);
+    EXPECT_EQ(*cache.get(1), "aaaaaa");
+}
+
+TEST(LruCacheTest, ByteBudgetTracksUpdatesAndClear) {
+    LruCache<int, std::string, std::hash<int>, StringBytes> cache(4, 100);
+
+    cache.put(1, "aaaa");
+    cache.put(1, "aa");
+    EXPECT_EQ(cache.bytes(), 2u);
+
+    cache.clear();
+    EXPECT_EQ(cache.bytes(), 0u);
+    EXPECT_EQ(cache.size(), 0u);
+    cache.put(2, "bb");
+    EXPECT_EQ(cache.size(), 1u);
+}
+
+// A string key that counts the bytes held by all live keys.
+struct CountedKey {
+    static size_t held;
+    std::string text;
+
+    CountedKey() = default;
+    explicit CountedKey(std::string t) : text(std::move(t)) { held += text.size(); }
+    CountedKey(const CountedKey& o) : text(o.text) { held += text.size(); }
+    CountedKey(CountedKey&& o) noexcept : text(std::move(o.text)) { o.text.clear(); }
+    CountedKey& operator=(const CountedKey& o) {
+        held = held - text.size() + o.text.size();
+        text = o.text;
+        return *this;
+    }
+    CountedKey& operator=(CountedKey&& o) noexcept {
+        held -= text.size();
+        text = std::move(o.text);
+        o.text.clear();
+        return *this;
+    }
+    ~CountedKey() { held -= text.size(); }
+    bool operator==(const CountedKey& o) const { return text == o.text; }
+};
+size_t CountedKey::held = 0;
+
+struct CountedKeyHash {
+    size_t operator()(const CountedKey& k) const { return std::hash<std::string>{}(k.text); }
+};
+
+struct CountedKeyBytes {
+    size_t operator()(const CountedKey& k, int) const { return k.text.size(); }
+};
+
+TEST(LruCacheTest, ByteBudgetReleasesEvictedKeys) {
+    CountedKey::held = 0;
+    {
+        LruCache<CountedKey, int, CountedKeyHash, CountedKeyBytes> cache(8, 1500);
+
+        cache.put(CountedKey(std::string(1000, 'a')), 1);
+        cache.put(CountedKey(std::string(1000, 'b')), 2);  // evicts the first by bytes
+
+        EXPECT_EQ(cache.size(), 1u);
+        EXPECT_EQ(cache.bytes(), 1000u);
+        // The evicted node waits in the free list without holding on to its key.
+        EXPECT_EQ(CountedKey::held, 1000u);
+    }
+    EXPECT_EQ(CountedKey::held, 0u);
+}
@@ -0,0 +1,85 @@
+// Tests for select_page_starts() in pagination.h — choosing page starts from break opportunities.
+// Pure logic, no render tree: the page_break_map is written by hand.
+
+#include <gtest/gtest.h>
+#include <litehtml.h>
+#include "pagination.h"
+
+using litehtml::page_break_map;
+using litehtml::pixel_t;
+using litehtml::select_page_starts;
+
+using Pages = std::vector<pixel_t>;
+
+TEST(PaginationTest, ShortDocumentIsOnePage) {
+    page_break_map map;
+    map.content_tops = {0, 50};
+    map.breaks = {{50, false}};
+    EXPECT_EQ(select_page_starts(map, 100, 80), (Pages{0}));
+}
+
+TEST(PaginationTest, BreaksAtLastFittingBreak) {
+    page_break_map map;
+    map.content_tops = {0, 40, 80, 120};
+    map.breaks = {{40, false}, {80, false}, {120, false}};
+    EXPECT_EQ(select_page_starts(map, 100, 160), (Pages{0, 80}));
+}
+
+TEST(PaginationTest, ForcedBreakBeforeFirstBoxAddsNoPage) {
+    page_break_map map;
+    map.forced = {0};
+    map.content_tops = {0, 40};
+    map.breaks = {{40, false}};
+    EXPECT_EQ(select_page_starts(map, 100, 80), (Pages{0}));
+}
+
+TEST(PaginationTest, ConsecutiveForcedBreaksMakeOnePage) {
+    page_break_map map;
+    // break-after on the box at 0 and break-before on the box at 30 meet at the same offset;
+    // an empty box between two forced breaks does not get a page of its own either.
+    map.forced = {30, 30, 30};
+    map.content_tops = {0, 30};
+    map.breaks = {{30, false}};
+    EXPECT_EQ(select_page_starts(map, 100, 60), (Pages{0, 30}));
+}
+
+TEST(PaginationTest, ForcedBreakWithoutContentAboveIsSkipped) {
+    page_break_map map;
+    map.forced = {30, 40};
+    map.content_tops = {0, 40};
+    EXPECT_EQ(select_page_starts(map, 100, 80), (Pages{0, 30}));
+}
+
+TEST(PaginationTest, AvoidedBreakLosesToAllowedOne) {
+    page_break_map map;
+    map.content_tops = {0, 40, 80, 120};
+    map.breaks = {{40, false}, {80, true}, {120, false}};
+    EXPECT_EQ(select_page_starts(map, 100, 160), (Pages{0, 40, 120}));
+}
+
+TEST(PaginationTest, AvoidedBreakIsUsedWhenNoOtherFits) {
+    page_break_map map;
+    map.content_tops = {0, 60, 120};
+    map.breaks = {{60, true}, {120, true}};
+    EXPECT_EQ(select_page_starts(map, 100, 160), (Pages{0, 60}));
+}
+
+TEST(PaginationTest, LineGroupTallerThanPageIsCut) {
+    page_break_map map;
+    // A box at 0, then a group of overlapping lines from 100 to 350 with no break inside.
+    map.content_tops = {0, 100, 350};
+    map.breaks = {{100, false}, {350, false}};
+    EXPECT_EQ(select_page_starts(map, 200, 400), (Pages{0, 100, 300}));
+}
+
+TEST(PaginationTest, NoBreaksCutsAtPageHeight) {
+    page_break_map map;
+    map.content_tops = {0};
+    EXPECT_EQ(select_page_starts(map, 100, 250), (Pages{0, 100, 200}));
+}
+
+TEST(PaginationTest, NonPositivePageHeightIsOnePage) {
+    page_break_map map;
+    map.content_tops = {0};
+    EXPECT_EQ(select_page_starts(map, 0, 250), (Pages{0}));
+}
@@ -1,4 +1,9 @@
 #include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "litehtml/string_id.h"
 
 using namespace litehtml;
@@ -91,3 +96,50 @@ TEST(StringIdTest, EnumSequence) {
     // _abbr_ and _acronym_ should be adjacent
     EXPECT_EQ(_abbr_ + 1, _acronym_);
 }
+
+// ---- built-in names resolve to their enum values ----
+
+TEST(StringIdTest, BuiltinNamesResolveToEnum) {
+    EXPECT_EQ(_id("div"), _div_);
+    EXPECT_EQ(_id("border-color"), _border_color_);
+    EXPECT_EQ(_id("size"), _size_);
+    EXPECT_EQ(_id("a"), _a_);
+}
+
+TEST(StringIdTest, ManyDynamicRegistrations) {
+    // Enough strings to span several storage chunks and grow the lookup table
+    std::vector<string_id> ids;
+    for (int i = 0; i < 5000; ++i) {
+        ids.push_back(_id("many-dynamic-" + std::to_string(i)));
+    }
+    for (int i = 0; i < 5000; ++i) {
+        EXPECT_EQ(_s(ids[i]), "many-dynamic-" + std::to_string(i));
+        EXPECT_EQ(_id("many-dynamic-" + std::to_string(i)), ids[i]);
+    }
+}
+
+TEST(StringIdTest, ConcurrentInterningIsConsistent) {
+    const int kThreads = 4;
+    const int kNames = 2000;
+    std::vector<std::vector<string_id>> results(kThreads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t, &results]() {
+            for (int i = 0; i < kNames; ++i) {
+                // Threads walk the names in different orders
+                int n = (t % 2 == 0) ? i : kNames - 1 - i;
+                results[t].push_back(_id("concurrent-" + std::to_string(n)));
+                _s(_div_);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    for (int t = 0; t < kThreads; ++t) {
+        for (int i = 0; i < kNames; ++i) {
+            int n = (t % 2 == 0) ? i : kNames - 1 - i;
+            EXPECT_EQ(results[t][i], _id("concurrent-" + std::to_string(n)));
+            EXPECT_EQ(_s(results[t][i]), "concurrent-" + std::to_string(n));
+        }
+    }
+}